@@ -71,6 +71,8 @@ PJRT_Error* PJRT_Client_Create(PJRT_Client_Create_Args* args) {
       allocator_config.kind = xla::GpuAllocatorConfig::Kind::kPlatform;
     } else if (allocator_name == "bfc") {
       allocator_config.kind = xla::GpuAllocatorConfig::Kind::kBFC;
+    } else if (allocator_name == "cuda_async") {
+      allocator_config.kind = xla::GpuAllocatorConfig::Kind::kCudaAsync;
     } else {
       return new PJRT_Error{absl::UnimplementedError(absl::StrFormat(
           "Allocator %s not supported for PJRT GPU plugin. Supported allocator "
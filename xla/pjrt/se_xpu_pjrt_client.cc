@@ -24,8 +24,14 @@ limitations under the License.
 
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "tsl/util/env_var.h"
 #include "xla/client/client_library.h"
+#include "xla/pjrt/distributed/protocol.pb.h"
 #include "xla/pjrt/pjrt_stream_executor_client.h"
+#include "xla/service/global_device_id.h"
+#include "xla/service/gpu/ccl_utils.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/service/platform_util.h"
 #include "xla/statusor.h"
@@ -33,6 +39,8 @@ limitations under the License.
 #include "xla/stream_executor/integrations/device_host_allocator.h"
 #include "xla/stream_executor/integrations/device_mem_allocator.h"
 #include "xla/stream_executor/integrations/tf_allocator_adapter.h"
+#include "xla/stream_executor/sycl/sycl_async_allocator.h"
+#include "xla/stream_executor/sycl/sycl_bfc_allocator.h"
 
 namespace xla {
 namespace {
@@ -76,6 +84,43 @@ BuildLocalDeviceStates(LocalClient* xla_client) {
   return std::move(addressable_devices);
 }
 
+// Creates a BFC allocator for `executor`. Unlike CreateBFCAllocator, the
+// memory fraction applies to the total device memory, since SYCL does not
+// report free memory.
+//
+// XLA_ENABLE_BFC_COMPACTION
+//   True: Return fully free regions to the device when an allocation would
+//         otherwise fail, so that a fragmented allocator can grow a new
+//         contiguous region. Only effective when not preallocating.
+//   False (default behaviour): Keep every region until the client is
+//         destroyed.
+StatusOr<std::unique_ptr<se::SyclBFCAllocator>> CreateXpuBFCAllocator(
+    se::StreamExecutor* executor, double memory_fraction, bool preallocate) {
+  bool enable_compaction;
+  TF_RETURN_IF_ERROR(tsl::ReadBoolFromEnvVar("XLA_ENABLE_BFC_COMPACTION",
+                                             false, &enable_compaction));
+  int device_ordinal = executor->device_ordinal();
+  auto sub_allocator = std::make_unique<se::DeviceMemAllocator>(
+      executor, tsl::PlatformDeviceId(device_ordinal),
+      /*use_unified_memory=*/false,
+      /*alloc_visitors=*/std::vector<tsl::SubAllocator::Visitor>(),
+      /*free_visitors=*/std::vector<tsl::SubAllocator::Visitor>());
+
+  size_t allocator_memory = static_cast<size_t>(
+      executor->GetDeviceDescription().device_memory_size() * memory_fraction);
+  if (preallocate) {
+    LOG(INFO) << "XLA backend allocating " << allocator_memory
+              << " bytes on device " << device_ordinal << " for BFCAllocator.";
+  } else {
+    LOG(INFO) << "XLA backend will use up to " << allocator_memory
+              << " bytes on device " << device_ordinal << " for BFCAllocator.";
+  }
+  return std::make_unique<se::SyclBFCAllocator>(
+      std::move(sub_allocator), allocator_memory,
+      absl::StrCat("XPU_", device_ordinal, "_bfc"),
+      /*allow_growth=*/!preallocate, enable_compaction);
+}
+
 // Constructs a GPU device memory allocator to use, according to the allocator
 // configuration the client requested.
 StatusOr<std::unique_ptr<se::DeviceMemoryAllocator>>
@@ -86,8 +131,25 @@ GetStreamExecutorXpuDeviceAllocator(
   std::unique_ptr<se::DeviceMemoryAllocator> allocator;
   switch (allocator_config.kind) {
     case GpuAllocatorConfig::Kind::kCudaAsync: {
-      LOG(ERROR) << "Async allocator is not supported; falling back to BFC.";
-      [[fallthrough]];
+      LOG(INFO) << "Using stream-ordered async allocator.";
+      std::vector<se::MultiDeviceAdapter::AllocatorWithStream>
+          allocators_and_streams;
+      for (const auto& ordinal_and_device : addressable_devices) {
+        se::StreamExecutor* executor = ordinal_and_device.second->executor();
+        se::Stream* stream = ordinal_and_device.second->compute_stream();
+        // The async allocator grows on demand, so `preallocate` is ignored
+        // and the memory fraction only caps the reserved bytes.
+        size_t memory_limit = static_cast<size_t>(
+            allocator_config.memory_fraction *
+            executor->GetDeviceDescription().device_memory_size());
+        allocators_and_streams.emplace_back(
+            std::make_unique<se::SyclAsyncAllocator>(executor, stream,
+                                                     memory_limit),
+            stream);
+      }
+      allocator = std::make_unique<se::MultiDeviceAdapter>(
+          platform, std::move(allocators_and_streams));
+      break;
     }
 
     case GpuAllocatorConfig::Kind::kDefault:
@@ -100,9 +162,9 @@ GetStreamExecutorXpuDeviceAllocator(
       for (const auto& ordinal_and_device : addressable_devices) {
         TF_ASSIGN_OR_RETURN(
             auto bfc_allocator,
-            CreateBFCAllocator(ordinal_and_device.second->executor(),
-                               allocator_config.memory_fraction,
-                               allocator_config.preallocate));
+            CreateXpuBFCAllocator(ordinal_and_device.second->executor(),
+                                  allocator_config.memory_fraction,
+                                  allocator_config.preallocate));
         allocators_and_streams.emplace_back(
             std::move(bfc_allocator),
             ordinal_and_device.second->compute_stream());
@@ -134,6 +196,75 @@ std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> BuildLocalDevices(
   return devices;
 }
 
+// Every process publishes its local devices in the key-value store and reads
+// those of the others. Global device ids are assigned in node order, so all
+// processes agree on them without a coordinator.
+Status BuildDistributedDevices(
+    std::map<int, std::unique_ptr<LocalDeviceState>> local_device_states,
+    int node_id, int num_nodes,
+    std::vector<std::unique_ptr<PjRtStreamExecutorDevice>>* devices,
+    gpu::GpuExecutableRunOptions* gpu_executable_run_options,
+    PjRtClient::KeyValueGetCallback kv_get,
+    PjRtClient::KeyValuePutCallback kv_put) {
+  // Processes may start several minutes apart on a busy cluster.
+  constexpr absl::Duration kGetTopologyTimeout = absl::Minutes(5);
+  auto topology_key = [](int node) {
+    return absl::StrCat("xpu:local_topology/", node);
+  };
+
+  LocalTopologyProto local_topology;
+  local_topology.set_node_id(node_id);
+  for (const auto& ordinal_and_device : local_device_states) {
+    const se::DeviceDescription& description =
+        ordinal_and_device.second->executor()->GetDeviceDescription();
+    DeviceProto* device_proto = local_topology.add_devices();
+    device_proto->set_local_device_ordinal(ordinal_and_device.first);
+    device_proto->set_name(description.name());
+    device_proto->set_vendor(description.device_vendor());
+  }
+  TF_RETURN_IF_ERROR(
+      kv_put(topology_key(node_id), local_topology.SerializeAsString()));
+
+  std::map<int, GlobalDeviceId> gpu_device_ids;
+  gpu::CclDistributedConfig ccl_config;
+  ccl_config.node_id = node_id;
+  ccl_config.num_nodes = num_nodes;
+  int next_global_id = 0;
+  for (int node = 0; node < num_nodes; ++node) {
+    LocalTopologyProto topology;
+    if (node == node_id) {
+      topology = local_topology;
+    } else {
+      TF_ASSIGN_OR_RETURN(std::string serialized,
+                          kv_get(topology_key(node), kGetTopologyTimeout));
+      TF_RET_CHECK(topology.ParseFromString(serialized))
+          << "Malformed topology of node " << node;
+    }
+    for (const DeviceProto& device_proto : topology.devices()) {
+      GlobalDeviceId global_device_id(next_global_id++);
+      ccl_config.device_to_node[global_device_id] = node;
+      std::unique_ptr<LocalDeviceState> local_device;
+      if (node == node_id) {
+        auto it = local_device_states.find(device_proto.local_device_ordinal());
+        TF_RET_CHECK(it != local_device_states.end())
+            << device_proto.local_device_ordinal();
+        local_device = std::move(it->second);
+        gpu_device_ids[device_proto.local_device_ordinal()] = global_device_id;
+      }
+      devices->push_back(std::make_unique<StreamExecutorXpuDevice>(
+          global_device_id.value(), std::move(local_device),
+          device_proto.name(), device_proto.vendor(), node));
+    }
+  }
+  gpu_executable_run_options->set_gpu_global_device_ids(
+      std::move(gpu_device_ids));
+
+  ccl_config.kv_get = std::move(kv_get);
+  ccl_config.kv_put = std::move(kv_put);
+  gpu::SetCclDistributedConfig(std::move(ccl_config));
+  return OkStatus();
+}
+
 inline const char* XpuName() {
   static constexpr char kXpuName[] = "xpu";
   return kXpuName;
@@ -194,10 +325,9 @@ StatusOr<std::unique_ptr<PjRtClient>> GetStreamExecutorXpuClient(
   if (num_nodes > 1) {
     TF_RET_CHECK(kv_get != nullptr);
     TF_RET_CHECK(kv_put != nullptr);
-    // TF_RETURN_IF_ERROR(BuildDistributedDevices(
-    //     std::move(local_device_states), node_id, num_nodes, &devices,
-    //     gpu_run_options.get(), kv_get, kv_put));
-    return Unimplemented("BuildDistributedDevices not");
+    TF_RETURN_IF_ERROR(BuildDistributedDevices(
+        std::move(local_device_states), node_id, num_nodes, &devices,
+        gpu_run_options.get(), kv_get, kv_put));
   } else {
     devices = BuildLocalDevices(std::move(local_device_states), node_id);
   }
@@ -0,0 +1,234 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/se_xpu_pjrt_client.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/client/lib/arithmetic.h"
+#include "xla/client/xla_builder.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/shape_util.h"
+#include "xla/status.h"
+#include "xla/stream_executor/sycl/sycl_driver.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla {
+namespace {
+
+PjRtClient* GetClient() {
+  static PjRtClient* client = []() -> PjRtClient* {
+    auto client = GetStreamExecutorXpuClient(
+        /*asynchronous=*/true, GpuAllocatorConfig(), /*node_id=*/0);
+    if (!client.ok() || (*client)->addressable_device_count() == 0) {
+      return nullptr;
+    }
+    return client->release();
+  }();
+  return client;
+}
+
+// Returns p0 + c_0 + ... + c_{count-1} over f32[elements], where the large
+// constants c_i are distinct for every `seed`. The parameter keeps the sum
+// from being folded, so every c_i is a constant global of the executable.
+XlaComputation SumOfConstants(int count, int64_t elements, int seed) {
+  XlaBuilder builder("sum_of_constants");
+  XlaOp sum = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {elements}),
+                        "p0");
+  for (int i = 0; i < count; ++i) {
+    std::vector<float> values(elements, i);
+    values[0] = seed;
+    sum = Add(sum, ConstantR1<float>(&builder, values));
+  }
+  return builder.Build().value();
+}
+
+// Returns `count` chained reductions of f32[kChainElements], each of which is
+// a separate kernel. Each reduction sums its input and the next one reduces
+// the broadcast sum scaled back by 1/kChainElements, so every reduction of p0
+// = 1 yields kChainElements.
+constexpr int64_t kChainElements = 1024;
+XlaComputation ChainOfReductions(int count) {
+  XlaBuilder builder("chain_of_reductions");
+  XlaComputation add = CreateScalarAddComputation(F32, &builder);
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {kChainElements}),
+                      "p0");
+  XlaOp sum;
+  for (int i = 0; i < count; ++i) {
+    sum = Reduce(x, ConstantR0<float>(&builder, 0), add, {0});
+    x = Mul(Broadcast(sum, {kChainElements}),
+            ConstantR0<float>(&builder, 1.0f / kChainElements));
+  }
+  return builder.Build(sum).value();
+}
+
+// Runs `executable` once on `argument` and returns the result.
+StatusOr<Literal> Run(PjRtClient* client, PjRtLoadedExecutable* executable,
+                      const Literal& argument) {
+  TF_ASSIGN_OR_RETURN(auto buffer,
+                      client->BufferFromHostLiteral(
+                          argument, client->addressable_devices()[0]));
+  std::vector<std::vector<PjRtBuffer*>> arguments = {{buffer.get()}};
+  TF_ASSIGN_OR_RETURN(auto results,
+                      executable->Execute(arguments, ExecuteOptions()));
+  TF_ASSIGN_OR_RETURN(auto literal, results[0][0]->ToLiteralSync());
+  return std::move(*literal);
+}
+
+Literal Filled(int64_t elements, float value) {
+  return LiteralUtil::CreateR1<float>(std::vector<float>(elements, value));
+}
+
+TEST(StreamExecutorXpuClientTest, ExecutesWithManyConstants) {
+  PjRtClient* client = GetClient();
+  if (client == nullptr) GTEST_SKIP() << "No GPU found";
+  constexpr int kCount = 32;
+  constexpr int64_t kElements = 1024;
+  auto executable = client->Compile(
+      SumOfConstants(kCount, kElements, /*seed=*/7), CompileOptions());
+  ASSERT_TRUE(executable.ok()) << executable.status();
+  auto literal = Run(client, executable->get(), Filled(kElements, 0));
+  ASSERT_TRUE(literal.ok()) << literal.status();
+  const Literal& result = *literal;
+  // sum(0..kCount-1) everywhere but in the first element.
+  EXPECT_EQ(result.Get<float>({0}), 7.0f * kCount);
+  EXPECT_EQ(result.Get<float>({1}), kCount * (kCount - 1) / 2.0f);
+  EXPECT_EQ(result.Get<float>({kElements - 1}), kCount * (kCount - 1) / 2.0f);
+}
+
+// Time of the first execution of a freshly compiled executable, which loads
+// its module and uploads its range(0) constants of range(1) floats each.
+// Constants differ between iterations, so none is shared through the cache.
+void BM_ExecutableLoad(::testing::benchmark::State& state) {
+  PjRtClient* client = GetClient();
+  if (client == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int count = state.range(0);
+  const int64_t elements = state.range(1);
+  int seed = 0;
+  for (auto s : state) {
+    state.PauseTiming();
+    auto executable =
+        client->Compile(SumOfConstants(count, elements, ++seed),
+                        CompileOptions());
+    CHECK(executable.ok()) << executable.status();
+    state.ResumeTiming();
+    auto result = Run(client, executable->get(), Filled(elements, 0));
+    CHECK(result.ok()) << result.status();
+  }
+  state.SetBytesProcessed(state.iterations() * count * elements *
+                          sizeof(float));
+}
+BENCHMARK(BM_ExecutableLoad)
+    ->ArgsProduct({{1, 16, 128}, {1 << 10, 1 << 18}})
+    ->UseRealTime()
+    ->Iterations(20);
+
+TEST(StreamExecutorXpuClientTest, LaunchesKernelsThroughLevelZero) {
+  PjRtClient* client = GetClient();
+  if (client == nullptr) GTEST_SKIP() << "No GPU found";
+  constexpr int kKernels = 8;
+  auto executable = client->Compile(ChainOfReductions(kKernels),
+                                    CompileOptions());
+  ASSERT_TRUE(executable.ok()) << executable.status();
+
+  se::gpu::SetLevelZeroLaunch(true);
+  int64_t launches = se::gpu::LevelZeroLaunchCount();
+  // Run twice, so that the second run binds unchanged arguments.
+  for (int run = 0; run < 2; ++run) {
+    auto result = Run(client, executable->get(), Filled(kChainElements, 1));
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_EQ(result->Get<float>({}), kChainElements);
+  }
+  launches = se::gpu::LevelZeroLaunchCount() - launches;
+  se::gpu::SetLevelZeroLaunch(false);
+  if (launches == 0) {
+    GTEST_SKIP() << "Queues are not in-order immediate command lists";
+  }
+  EXPECT_GE(launches, 2 * kKernels);
+}
+
+// Kernel launches per second (items/s) of an executable of range(0) small
+// kernels, launched through sycl::queue::submit (range(1) = 0) or directly
+// through Level Zero (range(1) = 1).
+void BM_KernelLaunch(::testing::benchmark::State& state) {
+  PjRtClient* client = GetClient();
+  if (client == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int kernels = state.range(0);
+  auto executable = client->Compile(ChainOfReductions(kernels),
+                                    CompileOptions());
+  CHECK(executable.ok()) << executable.status();
+  Literal ones = Filled(kChainElements, 1);
+  se::gpu::SetLevelZeroLaunch(state.range(1));
+  for (auto s : state) {
+    auto result = Run(client, executable->get(), ones);
+    CHECK(result.ok()) << result.status();
+  }
+  se::gpu::SetLevelZeroLaunch(false);
+  state.SetItemsProcessed(state.iterations() * kernels);
+}
+BENCHMARK(BM_KernelLaunch)
+    ->ArgsProduct({{64, 512}, {0, 1}})
+    ->UseRealTime();
+
+// Bandwidth (bytes read and written per second) of the loop fusion p0 + p0
+// over range(0) elements of F16 (range(1) = 0) or F32 (range(1) = 1). The
+// unroll factor of the fusion comes from SelectXeLoopUnroll. The argument
+// stays on the device, so only the kernels are timed.
+void BM_ElementwiseAdd(::testing::benchmark::State& state) {
+  PjRtClient* client = GetClient();
+  if (client == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const Shape shape =
+      ShapeUtil::MakeShape(state.range(1) ? F32 : F16, {state.range(0)});
+  XlaBuilder builder("elementwise_add");
+  XlaOp p0 = Parameter(&builder, 0, shape, "p0");
+  Add(p0, p0);
+  auto executable = client->Compile(builder.Build().value(), CompileOptions());
+  CHECK(executable.ok()) << executable.status();
+  auto buffer = client->BufferFromHostLiteral(
+      LiteralUtil::Zero(shape.element_type()).Broadcast(shape, {}).value(),
+      client->addressable_devices()[0]);
+  CHECK(buffer.ok()) << buffer.status();
+  std::vector<std::vector<PjRtBuffer*>> arguments = {{buffer->get()}};
+  for (auto s : state) {
+    auto results = (*executable)->Execute(arguments, ExecuteOptions());
+    CHECK(results.ok()) << results.status();
+    Status ready = (*results)[0][0]->GetReadyFuture().Await();
+    CHECK(ready.ok()) << ready;
+  }
+  state.SetBytesProcessed(state.iterations() * 2 *
+                          ShapeUtil::ByteSizeOf(shape));
+}
+BENCHMARK(BM_ElementwiseAdd)
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 24, 1 << 27}, {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace xla
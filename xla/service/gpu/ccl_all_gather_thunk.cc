@@ -81,8 +81,9 @@ Status RunAllGather(std::vector<DeviceBufferPair>& buffers, se::Stream& stream,
         send_buffer, recv_buffer, element_count, static_cast<const void*>(comm),
         gpu_stream);
 
-    sycl_allgather(send_buffer, recv_buffer, element_count, element_type,
-                   gpu_stream, comm, i, buffer_size);
+    TF_RETURN_IF_ERROR(sycl_allgather(send_buffer, recv_buffer, element_count,
+                                      element_type, gpu_stream, comm, i,
+                                      buffer_size));
   }
 
   VLOG(3) << "Done performing all-gather for ordinal: " << device_ordinal;
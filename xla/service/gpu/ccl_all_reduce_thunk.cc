@@ -70,8 +70,9 @@ Status RunAllReduce(ReductionKind reduction_kind,
         send_buffer, recv_buffer, element_count, static_cast<const void*>(comm),
         gpu_stream, std::hash<std::thread::id>{}(std::this_thread::get_id()));
 
-    sycl_allreduce(send_buffer, recv_buffer, element_count, element_type,
-                   reduction_kind, gpu_stream, comm, i, buffer_size);
+    TF_RETURN_IF_ERROR(sycl_allreduce(send_buffer, recv_buffer, element_count,
+                                      element_type, reduction_kind, gpu_stream,
+                                      comm, i, buffer_size));
   }
 
   return OkStatus();
@@ -352,8 +353,9 @@ Status RunReduceScatter(ReductionKind reduction_kind,
         "comm=%p, stream=%p)",
         send_buffer, recv_buffer, recv_count, static_cast<const void*>(comm),
         gpu_stream);
-    sycl_reduce_scatter(send_buffer, recv_buffer, recv_count, element_type,
-                        reduction_kind, gpu_stream, comm, i, buffer_size);
+    TF_RETURN_IF_ERROR(sycl_reduce_scatter(
+        send_buffer, recv_buffer, recv_count, element_type, reduction_kind,
+        gpu_stream, comm, i, buffer_size));
   }
 
   VLOG(3) << "Done performing reduce-scatter for ordinal: " << device_ordinal;
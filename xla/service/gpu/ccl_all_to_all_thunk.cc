@@ -145,8 +145,9 @@ Status RunAllToAll(bool has_split_dimension,
       send_buffers.push_back(send_buffer);
       recv_buffers.push_back(recv_buffer);
     }
-    sycl_alltoall_split(send_buffers, recv_buffers, element_count, element_type,
-                        gpu_stream, comm);
+    TF_RETURN_IF_ERROR(sycl_alltoall_split(send_buffers, recv_buffers,
+                                           element_count, element_type,
+                                           gpu_stream, comm));
   } else {
     TF_RET_CHECK(buffers.size() == num_participants)
         << "Number of inputs didn't match the number of participants.";
@@ -167,8 +168,8 @@ Status RunAllToAll(bool has_split_dimension,
     int element_count = buffers[0].element_count *
                         (primitive_util::IsComplexType(element_type) ? 2 : 1);
 
-    sycl_alltoall(send_buffers, recv_buffers, element_count, element_type,
-                  gpu_stream, comm);
+    TF_RETURN_IF_ERROR(sycl_alltoall(send_buffers, recv_buffers, element_count,
+                                     element_type, gpu_stream, comm));
   }
 
   VLOG(3) << "Done performing all-to-all for ordinal: " << device_ordinal;
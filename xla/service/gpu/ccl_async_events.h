@@ -0,0 +1,82 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_CCL_ASYNC_EVENTS_H_
+#define XLA_SERVICE_GPU_CCL_ASYNC_EVENTS_H_
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/status.h"
+#include "xla/status_macros.h"
+
+namespace xla {
+namespace gpu {
+
+// Done events of the async collectives in flight, one per device. Start runs a
+// collective on the async stream after the compute stream's pending work and
+// records its done event; Await makes the compute stream wait for that event.
+// Neither blocks the host.
+//
+// Templated on the stream and event types so that the ordering can be tested
+// with fake streams. `StreamT` provides ThenWaitFor(StreamT*),
+// ThenWaitFor(EventT*), ThenRecordEvent(EventT*) and parent(), whose
+// device_ordinal() keys the events; `EventT` is movable, constructible from
+// parent() and has Init().
+template <typename StreamT, typename EventT>
+class AsyncDoneEvents {
+ public:
+  template <typename Fn>
+  Status Start(StreamT& compute_stream, StreamT& async_stream, Fn&& fn) {
+    // Wait until compute inputs are ready.
+    async_stream.ThenWaitFor(&compute_stream);
+
+    TF_RETURN_IF_ERROR(fn(async_stream));
+
+    // Create an event on the async stream for the completion of the
+    // collective.
+    EventT done_event(async_stream.parent());
+    TF_RET_CHECK(done_event.Init());
+    async_stream.ThenRecordEvent(&done_event);
+
+    int device_ordinal = async_stream.parent()->device_ordinal();
+    absl::MutexLock lock(&mu_);
+    auto [_, was_inserted] =
+        done_events_.insert({device_ordinal, std::move(done_event)});
+    TF_RET_CHECK(was_inserted) << "done event has not been consumed";
+    return OkStatus();
+  }
+
+  Status Await(StreamT& compute_stream) {
+    int device_ordinal = compute_stream.parent()->device_ordinal();
+    auto done_event = [this, device_ordinal] {
+      absl::MutexLock lock(&mu_);
+      return done_events_.extract(device_ordinal);
+    }();
+    TF_RET_CHECK(done_event) << "done event not found";
+    compute_stream.ThenWaitFor(&done_event.mapped());
+    return OkStatus();
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<int, EventT> done_events_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_CCL_ASYNC_EVENTS_H_
@@ -0,0 +1,173 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_async_events.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class FakeExecutor {
+ public:
+  explicit FakeExecutor(int device_ordinal)
+      : device_ordinal_(device_ordinal) {}
+  int device_ordinal() const { return device_ordinal_; }
+
+  // Every stream operation of the test, in host issue order.
+  std::vector<std::string> log;
+  int next_event_id = 0;
+
+ private:
+  int device_ordinal_;
+};
+
+class FakeEvent {
+ public:
+  explicit FakeEvent(FakeExecutor* executor) : executor_(executor) {}
+  FakeEvent(FakeEvent&&) = default;
+  FakeEvent& operator=(FakeEvent&&) = default;
+
+  bool Init() {
+    id_ = executor_->next_event_id++;
+    return true;
+  }
+  int id() const { return id_; }
+
+ private:
+  FakeExecutor* executor_;
+  int id_ = -1;
+};
+
+class FakeStream {
+ public:
+  FakeStream(FakeExecutor* executor, std::string name)
+      : executor_(executor), name_(std::move(name)) {}
+
+  FakeExecutor* parent() const { return executor_; }
+
+  void ThenWaitFor(FakeStream* other) {
+    Log(absl::StrCat("wait stream ", other->name_));
+  }
+  void ThenWaitFor(FakeEvent* event) {
+    Log(absl::StrCat("wait event ", event->id()));
+  }
+  void ThenRecordEvent(FakeEvent* event) {
+    Log(absl::StrCat("record event ", event->id()));
+  }
+  void Launch(const std::string& op) { Log(op); }
+
+ private:
+  void Log(const std::string& op) {
+    executor_->log.push_back(absl::StrCat(name_, ": ", op));
+  }
+
+  FakeExecutor* executor_;
+  std::string name_;
+};
+
+using TestDoneEvents = AsyncDoneEvents<FakeStream, FakeEvent>;
+
+Status RunCollective(FakeStream& stream) {
+  stream.Launch("all-reduce");
+  return OkStatus();
+}
+
+TEST(AsyncDoneEventsTest, OrdersCollectiveBetweenComputeWork) {
+  FakeExecutor executor(0);
+  FakeStream compute(&executor, "compute");
+  FakeStream collective(&executor, "collective");
+  TestDoneEvents events;
+
+  compute.Launch("producer");
+  ASSERT_TRUE(events.Start(compute, collective, RunCollective).ok());
+  compute.Launch("independent");
+  ASSERT_TRUE(events.Await(compute).ok());
+  compute.Launch("consumer");
+
+  EXPECT_EQ(executor.log, (std::vector<std::string>{
+                              "compute: producer",
+                              "collective: wait stream compute",
+                              "collective: all-reduce",
+                              "collective: record event 0",
+                              "compute: independent",
+                              "compute: wait event 0",
+                              "compute: consumer",
+                          }));
+}
+
+TEST(AsyncDoneEventsTest, AwaitsTheEventOfTheLatestStart) {
+  FakeExecutor executor(0);
+  FakeStream compute(&executor, "compute");
+  FakeStream collective(&executor, "collective");
+  TestDoneEvents events;
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(events.Start(compute, collective, RunCollective).ok());
+    ASSERT_TRUE(events.Await(compute).ok());
+    EXPECT_EQ(executor.log.back(), absl::StrCat("compute: wait event ", i));
+  }
+}
+
+TEST(AsyncDoneEventsTest, TracksDevicesIndependently) {
+  FakeExecutor executor0(0), executor1(1);
+  FakeStream compute0(&executor0, "compute"), compute1(&executor1, "compute");
+  FakeStream collective0(&executor0, "collective");
+  FakeStream collective1(&executor1, "collective");
+  TestDoneEvents events;
+
+  ASSERT_TRUE(events.Start(compute0, collective0, RunCollective).ok());
+  ASSERT_TRUE(events.Start(compute1, collective1, RunCollective).ok());
+  ASSERT_TRUE(events.Await(compute1).ok());
+  ASSERT_TRUE(events.Await(compute0).ok());
+  EXPECT_EQ(executor0.log.back(), "compute: wait event 0");
+  EXPECT_EQ(executor1.log.back(), "compute: wait event 0");
+}
+
+TEST(AsyncDoneEventsTest, FailedCollectiveRecordsNoEvent) {
+  FakeExecutor executor(0);
+  FakeStream compute(&executor, "compute");
+  FakeStream collective(&executor, "collective");
+  TestDoneEvents events;
+
+  Status status = events.Start(compute, collective, [](FakeStream&) {
+    return absl::InternalError("collective failed");
+  });
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(executor.log, (std::vector<std::string>{
+                              "collective: wait stream compute",
+                          }));
+  EXPECT_FALSE(events.Await(compute).ok());
+}
+
+TEST(AsyncDoneEventsTest, RejectsUnbalancedStartAndAwait) {
+  FakeExecutor executor(0);
+  FakeStream compute(&executor, "compute");
+  FakeStream collective(&executor, "collective");
+  TestDoneEvents events;
+
+  EXPECT_FALSE(events.Await(compute).ok());
+  ASSERT_TRUE(events.Start(compute, collective, RunCollective).ok());
+  EXPECT_FALSE(events.Start(compute, collective, RunCollective).ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -218,8 +218,9 @@ Status RunCollectivePermute(
 
   se::gpu::GpuStreamHandle gpu_stream = se::gpu::AsGpuStreamValue(&stream);
 
-  sycl_collective_permute(src_addr.opaque(), dest_addr.opaque(), element_count,
-                          element_type, source_id, target_id, gpu_stream, comm);
+  TF_RETURN_IF_ERROR(sycl_collective_permute(
+      src_addr.opaque(), dest_addr.opaque(), element_count, element_type,
+      source_id, target_id, gpu_stream, comm));
 
   if (!source_id) {
     // If there is no source peer, i.e. no one send us any data, zero out dest
@@ -26,9 +26,15 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/global_device_id.h"
+#include "xla/service/gpu/conditional_thunk.h"
+#include "xla/service/gpu/for_thunk.h"
+#include "xla/service/gpu/sequential_thunk.h"
+#include "xla/service/gpu/while_thunk.h"
 #include "xla/stream_executor/gpu/gpu_activation.h"
+#include "tsl/platform/casts.h"
 #include "xla/util.h"
 
 namespace xla {
@@ -122,7 +128,7 @@ StatusOr<NcclComm::Lock> LockNcclComm(
     const NcclExecuteParams& params,
     const std::vector<ReplicaGroup>& replica_groups,
     CollectiveOpGroupMode group_mode, int64_t op_id, int64_t stream_id,
-    bool enable_clique_optimization) {
+    bool enable_clique_optimization, NcclCommCache* comm_cache) {
   TF_ASSIGN_OR_RETURN(GlobalDeviceId global_device_id,
                       params.GetGlobalDeviceId());
   TF_ASSIGN_OR_RETURN(
@@ -130,10 +136,6 @@ StatusOr<NcclComm::Lock> LockNcclComm(
       GetParticipatingDevices(global_device_id, *params.device_assn,
                               replica_groups, group_mode));
 
-  if (participants.size() > MAX_RANK_SIZE)
-    LOG(FATAL) << "Rank size" << participants.size()
-               << "is greater than MAX_RANK_SIZE(" << MAX_RANK_SIZE << ")";
-
   if (IsGlobalNcclConfig() &&
       (participants.size() != params.device_assn->replica_count())) {
     return InvalidArgument(
@@ -161,7 +163,8 @@ StatusOr<NcclComm::Lock> LockNcclComm(
 
   return AcquireNcclComm(params.run_id, OpId(op_id), std::move(participants),
                          num_local_participants, unique_id_callback, rank,
-                         stream_id, enable_clique_optimization);
+                         stream_id, enable_clique_optimization, comm_cache,
+                         params.stream_executor->device_ordinal());
 }
 
 StatusOr<std::vector<DeviceBufferPair>> ConvertToDeviceBuffers(
@@ -186,12 +189,10 @@ StatusOr<std::vector<DeviceBufferPair>> ConvertToDeviceBuffers(
 Status NcclCollectiveThunk::ExecuteOnStream(const ExecuteParams& params) {
   VLOG(1) << absl::StreamFormat("Starting %s %s.", IsAsync() ? "async" : "sync",
                                 Thunk::KindToString(kind()));
-  const int64_t stream_id = IsAsync() ? 1 : 0;
-  TF_ASSIGN_OR_RETURN(
-      NcclComm::Lock comm,
-      LockNcclComm(params.nccl_params, config().replica_groups,
-                   config().group_mode, config().op_id, stream_id,
-                   /*enable_clique_optimization=*/false));
+  if (warm_up_ != nullptr) {
+    TF_RETURN_IF_ERROR(warm_up_->RunOnce(params.nccl_params));
+  }
+  TF_ASSIGN_OR_RETURN(NcclComm::Lock comm, LockComm(params.nccl_params));
 
   // Run the collective on main stream or using the async executor.
   Status status = [&]() {
@@ -210,7 +211,9 @@ Status NcclCollectiveThunk::ExecuteOnStream(const ExecuteParams& params) {
   // Block host on the first call to ensure that all devices have allocated the
   // required buffers for their communicators before allowing any device to
   // continue enqueuing operations. Otherwise, the allocations can cause
-  // deadlock in the CUDA driver (b/215649390).
+  // deadlock in the CUDA driver (b/215649390). The in-process collectives in
+  // ccl_ops allocate nothing, so they are ordered by stream events alone.
+#if ITEX_USE_CCL
   if (first_call_to_execute_) {
     se::Stream* stream = IsAsync()
                              ? params.async_comms_streams[GetAsyncStreamKind()]
@@ -218,9 +221,95 @@ Status NcclCollectiveThunk::ExecuteOnStream(const ExecuteParams& params) {
     TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
     first_call_to_execute_ = false;
   }
+#endif  // ITEX_USE_CCL
   return OkStatus();
 }
 
+StatusOr<NcclComm::Lock> NcclCollectiveThunk::LockComm(
+    const NcclExecuteParams& params) {
+  const int64_t stream_id = IsAsync() ? 1 : 0;
+  return LockNcclComm(params, config().replica_groups, config().group_mode,
+                      config().op_id, stream_id,
+                      /*enable_clique_optimization=*/false, &comm_cache_);
+}
+
+Status NcclCollectiveThunk::WarmUp(const NcclExecuteParams& params) {
+  return LockComm(params).status();
+}
+
+namespace {
+// Appends the collective thunks of `thunks` to `collectives` in program order.
+void CollectNcclCollectives(const ThunkSequence& thunks,
+                            bool include_conditional_branches,
+                            std::vector<NcclCollectiveThunk*>* collectives) {
+  auto collect = [&](const ThunkSequence& nested) {
+    CollectNcclCollectives(nested, include_conditional_branches, collectives);
+  };
+  for (const std::unique_ptr<Thunk>& thunk : thunks) {
+    if (thunk->kind() == Thunk::kConditional) {
+      if (!include_conditional_branches) continue;
+      auto* cond_thunk = tensorflow::down_cast<ConditionalThunk*>(thunk.get());
+      for (const std::unique_ptr<SequentialThunk>& branch_thunks :
+           cond_thunk->branch_thunks()) {
+        collect(branch_thunks->thunks());
+      }
+    } else if (thunk->kind() == Thunk::kFor) {
+      auto* for_thunk = tensorflow::down_cast<ForThunk*>(thunk.get());
+      collect(for_thunk->body_thunk_sequence()->thunks());
+    } else if (thunk->kind() == Thunk::kSequential) {
+      auto* sequential_thunk =
+          tensorflow::down_cast<SequentialThunk*>(thunk.get());
+      collect(sequential_thunk->thunks());
+    } else if (thunk->kind() == Thunk::kWhile) {
+      auto* while_thunk = tensorflow::down_cast<WhileThunk*>(thunk.get());
+      collect(while_thunk->condition_thunk_sequence()->thunks());
+      collect(while_thunk->body_thunk_sequence()->thunks());
+    } else if (auto* collective =
+                   dynamic_cast<NcclCollectiveThunk*>(thunk.get())) {
+      collectives->push_back(collective);
+    }
+  }
+}
+}  // namespace
+
+Status WarmUpNcclCollectives(const ThunkSequence& thunks,
+                             const NcclExecuteParams& params) {
+  std::vector<NcclCollectiveThunk*> collectives;
+  CollectNcclCollectives(thunks, /*include_conditional_branches=*/true,
+                         &collectives);
+  for (NcclCollectiveThunk* collective : collectives) {
+    TF_RETURN_IF_ERROR(collective->WarmUp(params));
+  }
+  return OkStatus();
+}
+
+Status NcclCollectiveWarmUp::RunOnce(const NcclExecuteParams& params) {
+  int device_ordinal = params.stream_executor->device_ordinal();
+  {
+    absl::MutexLock lock(&mu_);
+    if (!started_.insert(device_ordinal).second) return OkStatus();
+  }
+  VLOG(1) << "Warming up " << thunks_.size() << " collectives on device "
+          << device_ordinal;
+  for (NcclCollectiveThunk* thunk : thunks_) {
+    TF_RETURN_IF_ERROR(thunk->WarmUp(params));
+  }
+  return OkStatus();
+}
+
+void EnableNcclCollectiveWarmUp(const ThunkSequence& thunks) {
+  std::vector<NcclCollectiveThunk*> warm_up_thunks;
+  CollectNcclCollectives(thunks, /*include_conditional_branches=*/false,
+                         &warm_up_thunks);
+  if (warm_up_thunks.empty()) return;
+  std::vector<NcclCollectiveThunk*> all_thunks;
+  CollectNcclCollectives(thunks, /*include_conditional_branches=*/true,
+                         &all_thunks);
+  auto warm_up =
+      std::make_shared<NcclCollectiveWarmUp>(std::move(warm_up_thunks));
+  for (NcclCollectiveThunk* thunk : all_thunks) thunk->set_warm_up(warm_up);
+}
+
 std::string NcclCollectiveThunk::GetDeviceString(
     const NcclExecuteParams& nccl_params) {
   int device_ordinal = nccl_params.stream_executor->device_ordinal();
@@ -235,34 +324,15 @@ std::string NcclCollectiveThunk::GetDeviceString(
 Status NcclCollectiveThunk::AsyncExecutor::Execute(
     absl::FunctionRef<Status(const ExecuteParams&, se::Stream&, ncclComm_t)> fn,
     const ExecuteParams& params, ncclComm_t comm, AsyncStreamKind stream_kind) {
-  se::Stream& async_comms_stream = *params.async_comms_streams[stream_kind];
-  // Wait until compute inputs are ready.
-  async_comms_stream.ThenWaitFor(params.stream);
-
-  TF_RETURN_IF_ERROR(fn(params, async_comms_stream, comm));
-
-  // Create an event on the async stream for the completion of the collective.
-  se::Event done_event(async_comms_stream.parent());
-  TF_RET_CHECK(done_event.Init());
-  async_comms_stream.ThenRecordEvent(&done_event);
-
-  int device_ordinal = async_comms_stream.parent()->device_ordinal();
-  absl::MutexLock lock(&mu_);
-  auto [_, was_inserted] =
-      done_events_.insert({device_ordinal, std::move(done_event)});
-  TF_RET_CHECK(was_inserted) << "done event has not been consumed";
-  return OkStatus();
+  return done_events_.Start(
+      *params.stream, *params.async_comms_streams[stream_kind],
+      [&](se::Stream& async_comms_stream) {
+        return fn(params, async_comms_stream, comm);
+      });
 }
 
 Status NcclCollectiveThunk::AsyncExecutor::Await(const ExecuteParams& params) {
-  int device_ordinal = params.stream->parent()->device_ordinal();
-  auto done_event = [this, device_ordinal] {
-    absl::MutexLock lock(&mu_);
-    return done_events_.extract(device_ordinal);
-  }();
-  TF_RET_CHECK(done_event) << "done event not found";
-  params.stream->ThenWaitFor(&done_event.mapped());
-  return OkStatus();
+  return done_events_.Await(*params.stream);
 }
 
 NcclCollectiveDoneThunk::NcclCollectiveDoneThunk(
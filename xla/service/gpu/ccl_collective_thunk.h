@@ -18,14 +18,19 @@ limitations under the License.
 #ifndef XLA_SERVICE_GPU_CCL_COLLECTIVE_THUNK_H_
 #define XLA_SERVICE_GPU_CCL_COLLECTIVE_THUNK_H_
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "xla/service/collective_ops_utils.h"
+#include "xla/service/gpu/ccl_async_events.h"
 #include "xla/service/gpu/ccl_utils.h"
 #include "xla/service/gpu/ir_emission_utils.h"
 #include "xla/service/gpu/thunk.h"
@@ -38,11 +43,8 @@ using ncclComm_t = ccl::communicator*;
 namespace xla {
 namespace gpu {
 
-// Current HW only have 16 ranks in single node at most.
-// TODO(intel): Extend it for new HW in future.
-#define MAX_RANK_SIZE 16
-
 class NcclClique;
+class NcclCollectiveWarmUp;
 
 struct NcclCollectiveConfig {
   NcclCollectiveConfig();
@@ -122,9 +124,8 @@ class NcclCollectiveThunk : public Thunk {
     Status Await(const ExecuteParams& params);
 
    private:
-    absl::Mutex mu_;
     // Store done events (by device ordinal) for the done thunk to wait on.
-    absl::flat_hash_map<int, se::Event> done_events_ ABSL_GUARDED_BY(mu_);
+    AsyncDoneEvents<se::Stream, se::Event> done_events_;
   };
 
   // Returns whether NCCL operations appear possible to perform; e.g. if we
@@ -142,6 +143,17 @@ class NcclCollectiveThunk : public Thunk {
   AsyncExecutor* async_executor() { return async_.get(); }
   Status ExecuteOnStream(const ExecuteParams& params) override;
 
+  // Initializes the communicator this thunk uses on the device of `params`
+  // without running the collective, so that no execution waits on the clique
+  // rendezvous. Like execution, it has to be called for every local device
+  // taking part, concurrently.
+  Status WarmUp(const NcclExecuteParams& params);
+
+  // Makes the first execution of this thunk on a device run `warm_up` first.
+  void set_warm_up(std::shared_ptr<NcclCollectiveWarmUp> warm_up) {
+    warm_up_ = std::move(warm_up);
+  }
+
  protected:
   virtual Status RunNcclCollective(const ExecuteParams& params,
                                    se::Stream& stream, ncclComm_t comm) = 0;
@@ -152,10 +164,47 @@ class NcclCollectiveThunk : public Thunk {
 
  private:
   bool IsAsync() const { return async_ != nullptr; }
+  StatusOr<NcclComm::Lock> LockComm(const NcclExecuteParams& params);
+
   bool first_call_to_execute_ = true;
   std::unique_ptr<AsyncExecutor> async_;  // null if not async.
+  NcclCommCache comm_cache_;
+  std::shared_ptr<NcclCollectiveWarmUp> warm_up_;  // null if not shared.
+};
+
+// Warms up every collective thunk in `thunks`, including those nested in
+// while, conditional and sequential thunks, for the device of `params`, in
+// program order. Has to be called for all local devices at once.
+Status WarmUpNcclCollectives(const ThunkSequence& thunks,
+                             const NcclExecuteParams& params);
+
+// Collectives of one executable that are warmed up together the first time a
+// device executes any of them, so that later collectives of the executable do
+// not wait on the clique rendezvous. Every local device runs the same program
+// and so warms them up in the same order.
+//
+// This cannot happen when the thunks are initialized: the cliques depend on
+// the device assignment and run id, which only an execution provides.
+class NcclCollectiveWarmUp {
+ public:
+  explicit NcclCollectiveWarmUp(std::vector<NcclCollectiveThunk*> thunks)
+      : thunks_(std::move(thunks)) {}
+
+  // Warms up the collectives on the device of `params`, unless that device
+  // has already started to.
+  Status RunOnce(const NcclExecuteParams& params);
+
+ private:
+  std::vector<NcclCollectiveThunk*> thunks_;
+  absl::Mutex mu_;
+  absl::flat_hash_set<int> started_ ABSL_GUARDED_BY(mu_);
 };
 
+// Shares one NcclCollectiveWarmUp between all collective thunks of an
+// executable's `thunks`. Collectives in conditional branches are left to
+// their first execution, since a device may never take their branch.
+void EnableNcclCollectiveWarmUp(const ThunkSequence& thunks);
+
 Status IsValidOperand(mlir::Value operand, Thunk::Kind reduction_op);
 
 class NcclCollectiveDoneThunk : public Thunk {
@@ -196,7 +245,8 @@ Status AddOpDescription(Status status, OpT op, int64_t replica_count,
 StatusOr<NcclComm::Lock> LockNcclComm(
     const NcclExecuteParams& params,
     const std::vector<ReplicaGroup>& replica_groups,
-    CollectiveOpGroupMode group_mode, int64_t op_id);
+    CollectiveOpGroupMode group_mode, int64_t op_id, int64_t stream_id,
+    bool enable_clique_optimization, NcclCommCache* comm_cache = nullptr);
 
 struct DeviceBufferPair {
   PrimitiveType element_type;
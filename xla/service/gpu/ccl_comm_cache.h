@@ -0,0 +1,128 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_CCL_COMM_CACHE_H_
+#define XLA_SERVICE_GPU_CCL_COMM_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "xla/status.h"
+#include "xla/status_macros.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Records that run `run_id` uses a clique whose latest run is
+// `clique_run_id`. If multiple executables are running simultaneously while
+// using multiple hosts, different executables could acquire the same clique on
+// different hosts. We protect against this by checking that the run ID of a
+// clique spanning hosts increases monotonically.
+inline Status AdvanceCliqueRunId(std::atomic<int64_t>& clique_run_id,
+                                 int64_t run_id, bool spans_hosts) {
+  if (!spans_hosts) {
+    clique_run_id.store(run_id, std::memory_order_relaxed);
+    return OkStatus();
+  }
+  int64_t latest = clique_run_id.load(std::memory_order_relaxed);
+  do {
+    TF_RET_CHECK(run_id >= latest)
+        << "Run " << run_id << " acquired a clique already used by run "
+        << latest;
+  } while (latest != run_id &&
+           !clique_run_id.compare_exchange_weak(latest, run_id,
+                                                std::memory_order_relaxed));
+  return OkStatus();
+}
+
+// Communicators one collective op has already initialized, so that its later
+// executions skip the clique rendezvous. Entries are indexed by local device
+// ordinal and published once, so a lookup is a single atomic load plus a key
+// comparison. Cliques spanning hosts still check run ids on every lookup.
+//
+// Templated on the clique key and communicator types so that the number of
+// rendezvous can be tested on the host. `KeyT` is copyable and comparable.
+template <typename KeyT, typename CommT>
+class CommCache {
+ public:
+  // A communicator and the run id of the clique it belongs to. Both outlive
+  // the cache.
+  struct CachedComm {
+    CommT* comm = nullptr;
+    std::atomic<int64_t>* clique_run_id = nullptr;
+    bool spans_hosts = false;
+  };
+
+  CommCache() = default;
+  CommCache(const CommCache&) = delete;
+  CommCache& operator=(const CommCache&) = delete;
+
+  // Returns the communicator cached for `device_ordinal` if it belongs to
+  // `key`. Otherwise calls `create`, which goes through the rendezvous and
+  // returns StatusOr<CachedComm>, and caches its result.
+  template <typename Fn>
+  StatusOr<CommT*> GetOrCreate(int device_ordinal, const KeyT& key,
+                               int64_t run_id, Fn&& create) {
+    if (const Entry* entry = Find(device_ordinal, key)) {
+      TF_RETURN_IF_ERROR(AdvanceCliqueRunId(*entry->comm.clique_run_id,
+                                            run_id, entry->comm.spans_hosts));
+      return entry->comm.comm;
+    }
+    TF_ASSIGN_OR_RETURN(CachedComm comm, create());
+    Insert(device_ordinal, key, comm);
+    return comm.comm;
+  }
+
+ private:
+  // Devices with a larger ordinal always go through the rendezvous.
+  static constexpr int kMaxDevices = 64;
+
+  struct Entry {
+    KeyT key;
+    CachedComm comm;
+  };
+
+  const Entry* Find(int device_ordinal, const KeyT& key) const {
+    if (device_ordinal < 0 || device_ordinal >= kMaxDevices) return nullptr;
+    const Entry* entry =
+        entries_[device_ordinal].load(std::memory_order_acquire);
+    if (entry == nullptr || !(entry->key == key)) return nullptr;
+    return entry;
+  }
+
+  void Insert(int device_ordinal, const KeyT& key, CachedComm comm) {
+    if (device_ordinal < 0 || device_ordinal >= kMaxDevices) return;
+    auto entry = std::make_unique<Entry>(Entry{key, comm});
+    absl::MutexLock lock(&mu_);
+    entries_[device_ordinal].store(entry.get(), std::memory_order_release);
+    owned_.push_back(std::move(entry));
+  }
+
+  std::array<std::atomic<const Entry*>, kMaxDevices> entries_{};
+  absl::Mutex mu_;
+  // Replaced entries are kept, since a concurrent Find may still read them.
+  std::vector<std::unique_ptr<Entry>> owned_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_CCL_COMM_CACHE_H_
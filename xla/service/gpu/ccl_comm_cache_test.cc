@@ -0,0 +1,178 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_comm_cache.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+struct TestKey {
+  std::vector<int> devices;
+  bool operator==(const TestKey& other) const {
+    return devices == other.devices;
+  }
+};
+
+struct TestComm {
+  int rank = -1;
+};
+
+using TestCommCache = CommCache<TestKey, TestComm>;
+
+// Stands in for the clique rendezvous: counts how often it is entered and
+// hands out one communicator per rank.
+class FakeRendezvous {
+ public:
+  FakeRendezvous(int nranks, bool spans_hosts)
+      : comms_(nranks), spans_hosts_(spans_hosts) {
+    for (int rank = 0; rank < nranks; ++rank) comms_[rank].rank = rank;
+  }
+
+  auto Create(int rank, int64_t run_id) {
+    return [this, rank, run_id]() -> StatusOr<TestCommCache::CachedComm> {
+      calls_.fetch_add(1);
+      TF_RETURN_IF_ERROR(
+          AdvanceCliqueRunId(clique_run_id_, run_id, spans_hosts_));
+      return TestCommCache::CachedComm{&comms_[rank], &clique_run_id_,
+                                       spans_hosts_};
+    };
+  }
+
+  int calls() const { return calls_.load(); }
+
+ private:
+  std::vector<TestComm> comms_;
+  bool spans_hosts_;
+  std::atomic<int64_t> clique_run_id_{-1};
+  std::atomic<int> calls_{0};
+};
+
+TEST(CommCacheTest, RendezvousOncePerDevice) {
+  constexpr int kRanks = 4;
+  constexpr int kExecutions = 1000;
+  const TestKey key{{0, 1, 2, 3}};
+  FakeRendezvous rendezvous(kRanks, /*spans_hosts=*/false);
+  TestCommCache cache;
+  std::atomic<int> errors{0};
+
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < kRanks; ++rank) {
+    threads.emplace_back([&, rank] {
+      for (int run = 0; run < kExecutions; ++run) {
+        StatusOr<TestComm*> comm =
+            cache.GetOrCreate(rank, key, run, rendezvous.Create(rank, run));
+        if (!comm.ok() || (*comm)->rank != rank) errors.fetch_add(1);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(rendezvous.calls(), kRanks);
+  EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(CommCacheTest, WarmedUpCacheNeverMeetsTheRendezvous) {
+  const TestKey key{{0, 1}};
+  FakeRendezvous rendezvous(2, /*spans_hosts=*/false);
+  TestCommCache cache;
+  for (int rank = 0; rank < 2; ++rank) {
+    ASSERT_TRUE(
+        cache.GetOrCreate(rank, key, 0, rendezvous.Create(rank, 0)).ok());
+  }
+  const int warm_up_calls = rendezvous.calls();
+  for (int run = 1; run < 100; ++run) {
+    for (int rank = 0; rank < 2; ++rank) {
+      ASSERT_TRUE(
+          cache.GetOrCreate(rank, key, run, rendezvous.Create(rank, run)).ok());
+    }
+  }
+  EXPECT_EQ(warm_up_calls, 2);
+  EXPECT_EQ(rendezvous.calls(), warm_up_calls);
+}
+
+TEST(CommCacheTest, NewCliqueKeyGoesThroughTheRendezvous) {
+  FakeRendezvous rendezvous_a(2, /*spans_hosts=*/false);
+  FakeRendezvous rendezvous_b(2, /*spans_hosts=*/false);
+  TestCommCache cache;
+  const TestKey key_a{{0, 1}}, key_b{{1, 0}};
+
+  ASSERT_TRUE(cache.GetOrCreate(0, key_a, 0, rendezvous_a.Create(0, 0)).ok());
+  ASSERT_TRUE(cache.GetOrCreate(0, key_b, 1, rendezvous_b.Create(0, 1)).ok());
+  ASSERT_TRUE(cache.GetOrCreate(0, key_b, 2, rendezvous_b.Create(0, 2)).ok());
+  EXPECT_EQ(rendezvous_a.calls(), 1);
+  EXPECT_EQ(rendezvous_b.calls(), 1);
+}
+
+TEST(CommCacheTest, OutOfRangeOrdinalsAreNotCached) {
+  FakeRendezvous rendezvous(1, /*spans_hosts=*/false);
+  TestCommCache cache;
+  const TestKey key{{0}};
+  for (int run = 0; run < 3; ++run) {
+    ASSERT_TRUE(
+        cache.GetOrCreate(1000, key, run, rendezvous.Create(0, run)).ok());
+  }
+  EXPECT_EQ(rendezvous.calls(), 3);
+}
+
+TEST(CommCacheTest, CacheHitsKeepMultiHostRunIdsMonotonic) {
+  FakeRendezvous rendezvous(1, /*spans_hosts=*/true);
+  TestCommCache cache;
+  const TestKey key{{0, 8}};
+
+  ASSERT_TRUE(cache.GetOrCreate(0, key, 5, rendezvous.Create(0, 5)).ok());
+  EXPECT_TRUE(cache.GetOrCreate(0, key, 5, rendezvous.Create(0, 5)).ok());
+  EXPECT_TRUE(cache.GetOrCreate(0, key, 7, rendezvous.Create(0, 7)).ok());
+  EXPECT_FALSE(cache.GetOrCreate(0, key, 6, rendezvous.Create(0, 6)).ok());
+  EXPECT_EQ(rendezvous.calls(), 1);
+}
+
+TEST(CommCacheTest, LocalCliquesAcceptAnyRunOrder) {
+  FakeRendezvous rendezvous(1, /*spans_hosts=*/false);
+  TestCommCache cache;
+  const TestKey key{{0}};
+
+  ASSERT_TRUE(cache.GetOrCreate(0, key, 5, rendezvous.Create(0, 5)).ok());
+  EXPECT_TRUE(cache.GetOrCreate(0, key, 3, rendezvous.Create(0, 3)).ok());
+}
+
+TEST(AdvanceCliqueRunIdTest, SharedAcrossOpsOfOneClique) {
+  // Two ops of the same clique share its run id, so a cache hit of one op
+  // sees the runs the other op has already taken part in.
+  std::atomic<int64_t> clique_run_id{-1};
+  TestComm comm;
+  TestCommCache op_a, op_b;
+  const TestKey key{{0, 8}};
+  auto create = [&]() -> StatusOr<TestCommCache::CachedComm> {
+    return TestCommCache::CachedComm{&comm, &clique_run_id,
+                                     /*spans_hosts=*/true};
+  };
+
+  ASSERT_TRUE(op_a.GetOrCreate(0, key, 1, create).ok());
+  ASSERT_TRUE(op_b.GetOrCreate(0, key, 1, create).ok());
+  ASSERT_TRUE(op_b.GetOrCreate(0, key, 4, create).ok());
+  EXPECT_FALSE(op_a.GetOrCreate(0, key, 2, create).ok());
+  EXPECT_EQ(clique_run_id.load(), 4);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
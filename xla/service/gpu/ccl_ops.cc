@@ -16,13 +16,27 @@ limitations under the License.
 #include "xla/service/gpu/ccl_ops.h"
 
 #include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 // TODO: It crashes when using public Eigen::bfloat16, need investigation.
 #include <sycl/ext/oneapi/bfloat16.hpp>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "tsl/platform/status.h"
+#include "tsl/util/env_var.h"
+#include "xla/service/gpu/ccl_rendezvous.h"
+#include "xla/service/gpu/ccl_transport.h"
+
 #if !ITEX_USE_CCL
 namespace xla {
 namespace gpu {
@@ -31,13 +45,14 @@ using bfloat16 = sycl::ext::oneapi::bfloat16;
 
 namespace {
 struct Participant {
+  Participant() = default;
   Participant(se::gpu::GpuStreamHandle stream, const void* send, void* recv,
               int rank)
       : stream(stream), send(send), recv(recv), rank(rank) {}
-  se::gpu::GpuStreamHandle stream;
-  const void* send;
-  void* recv;
-  int rank;
+  se::gpu::GpuStreamHandle stream = nullptr;
+  const void* send = nullptr;
+  void* recv = nullptr;
+  int rank = 0;
 };
 
 struct AlltoAllParticipant {
@@ -56,452 +71,746 @@ struct PermuteParticipant {
   int rank;
 };
 
+// Device copies of the peer pointer tables read by the collective kernels.
+// Tables are keyed by their contents and the stream that reads them, and are
+// never modified after upload. XLA reuses buffer allocations across steps, so
+// after the first step every lookup hits and nothing is uploaded. Keeping the
+// pointers in device memory instead of capturing them by value in the kernel
+// lambda removes any limit on the number of ranks.
+class DevicePointerTables {
+ public:
+  struct Table {
+    Table(se::gpu::GpuStreamHandle stream, void** device,
+          std::vector<void*> ptrs)
+        : stream(stream), host(std::move(ptrs)), data(device) {
+      ready = stream->memcpy(device, host.data(), host.size() * sizeof(void*));
+    }
+    // Only destroyed once Idle(), see DevicePointerTables::Get.
+    ~Table() { sycl::free(const_cast<void**>(data), *stream); }
+
+    // Whether the upload and every kernel that read the table have completed.
+    // Kernels reading a table run on its in-order stream, so the last one
+    // completes after all earlier ones.
+    bool Idle() const {
+      auto complete = [](const sycl::event& event) {
+        return event.get_info<sycl::info::event::command_execution_status>() ==
+               sycl::info::event_command_status::complete;
+      };
+      return complete(ready) && complete(last_use);
+    }
+
+    se::gpu::GpuStreamHandle stream;
+    // Source of the asynchronous upload, so it must outlive `ready`.
+    std::vector<void*> host;
+    void* const* data = nullptr;
+    // Completes when the table has reached device memory.
+    sycl::event ready;
+    // Last kernel that read the table. Only the leader of a collective on
+    // `stream` writes it, while it holds a reference to the table.
+    sycl::event last_use;
+  };
+
+  // Returns the table of `ptrs` for kernels on `stream`, uploading it on a
+  // miss. Fails with ResourceExhausted if the device copy cannot be
+  // allocated.
+  StatusOr<std::shared_ptr<Table>> Get(se::gpu::GpuStreamHandle stream,
+                                       std::vector<void*> ptrs) {
+    std::shared_ptr<Table> table;
+    // Freed after the lock is released.
+    std::vector<std::shared_ptr<Table>> idle;
+    {
+      absl::MutexLock lock(&mu_);
+      Key key{stream, std::move(ptrs)};
+      auto it = tables_.find(key);
+      if (it != tables_.end()) {
+        it->second.last_used = ++tick_;
+        return it->second.table;
+      }
+
+      if (tables_.size() >= kMaxTables) EvictLeastRecentlyUsed();
+      idle = TakeIdleRetired();
+      const size_t bytes = key.second.size() * sizeof(void*);
+      void** device = sycl::malloc_device<void*>(key.second.size(), *stream);
+      if (device == nullptr) {
+        return ResourceExhausted(
+            "Failed to allocate %d bytes for the peer pointers of a "
+            "collective.",
+            bytes);
+      }
+      table = std::make_shared<Table>(stream, device, key.second);
+      tables_.emplace(std::move(key), Entry{table, ++tick_});
+    }
+    return table;
+  }
+
+ private:
+  // Bounds the cache for programs that keep allocating new buffers.
+  static constexpr size_t kMaxTables = 4096;
+  // Evicting in batches keeps the scan for the oldest tables off most misses.
+  static constexpr size_t kEvictBatch = kMaxTables / 4;
+
+  using Key = std::pair<se::gpu::GpuStreamHandle, std::vector<void*>>;
+
+  struct Entry {
+    std::shared_ptr<Table> table;
+    uint64_t last_used;
+  };
+
+  // Moves the least recently used tables to retired_. A kernel reading one of
+  // them may still be queued or running, so none is freed here.
+  void EvictLeastRecentlyUsed() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::vector<uint64_t> ticks;
+    ticks.reserve(tables_.size());
+    for (const auto& [key, entry] : tables_) ticks.push_back(entry.last_used);
+    std::nth_element(ticks.begin(), ticks.begin() + kEvictBatch - 1,
+                     ticks.end());
+    const uint64_t threshold = ticks[kEvictBatch - 1];
+
+    for (auto it = tables_.begin(); it != tables_.end();) {
+      if (it->second.last_used <= threshold) {
+        retired_.push_back(std::move(it->second.table));
+        tables_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Removes and returns the retired tables that no collective holds any more
+  // and whose kernels have completed. Others stay for a later miss, so
+  // eviction never blocks the host on a stream.
+  std::vector<std::shared_ptr<Table>> TakeIdleRetired()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::vector<std::shared_ptr<Table>> idle;
+    auto first_idle = std::partition(
+        retired_.begin(), retired_.end(),
+        [](const std::shared_ptr<Table>& table) {
+          // A retired table is out of tables_, so no new reference to it can
+          // be taken, and a count of one means no collective holds it.
+          return table.use_count() > 1 || !table->Idle();
+        });
+    std::move(first_idle, retired_.end(), std::back_inserter(idle));
+    retired_.erase(first_idle, retired_.end());
+    return idle;
+  }
+
+  absl::Mutex mu_;
+  uint64_t tick_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<Key, Entry> tables_ ABSL_GUARDED_BY(mu_);
+  // Evicted tables waiting for their last kernel.
+  std::vector<std::shared_ptr<Table>> retired_ ABSL_GUARDED_BY(mu_);
+};
+
+// Pinned host memory the ring all-gather stages shards through when a device
+// cannot reach its neighbour's memory. A ring leases a block for its leader
+// stream and hands it back once its copies are enqueued. Every ring led by a
+// stream starts behind a barrier on that stream and ends with another, so the
+// cached block of a stream is reused without waiting.
+class HostStagingBuffers {
+ public:
+  struct Block {
+    Block(se::gpu::GpuStreamHandle stream, void* data, size_t bytes)
+        : context(stream->get_context()), data(data), bytes(bytes) {}
+    // Only destroyed once Idle(), see HostStagingBuffers::Release.
+    ~Block() { sycl::free(data, context); }
+
+    bool Idle() const {
+      return last_use.get_info<sycl::info::event::command_execution_status>() ==
+             sycl::info::event_command_status::complete;
+    }
+
+    // Outlives the stream, which may be destroyed before the block is freed.
+    sycl::context context;
+    void* data;
+    size_t bytes;
+    // Completes after the last copy that touched the block.
+    sycl::event last_use;
+  };
+
+  // Returns a block of at least `bytes` for the ring led by `stream`. Fails
+  // with ResourceExhausted if the host memory cannot be allocated.
+  StatusOr<std::unique_ptr<Block>> Acquire(se::gpu::GpuStreamHandle stream,
+                                           size_t bytes) {
+    std::unique_ptr<Block> block;
+    // Freed after the lock is released.
+    std::vector<std::unique_ptr<Block>> idle;
+    {
+      absl::MutexLock lock(&mu_);
+      auto it = cached_.find(stream);
+      if (it != cached_.end()) {
+        block = std::move(it->second);
+        cached_.erase(it);
+        // An earlier ring may still be reading a block that is too small.
+        if (block->bytes < bytes) retired_.push_back(std::move(block));
+      }
+      idle = TakeIdleRetired();
+    }
+    if (block != nullptr) return block;
+
+    void* data = sycl::malloc_host(bytes, *stream);
+    if (data == nullptr) {
+      return ResourceExhausted(
+          "Failed to allocate %d bytes of host memory to stage an all-gather.",
+          bytes);
+    }
+    return std::make_unique<Block>(stream, data, bytes);
+  }
+
+  // Hands `block` back after the ring led by `stream` has enqueued its last
+  // copy. `done` completes after that copy. Blocks above kMaxCachedBytes are
+  // not kept, so each leader stream holds at most that much between rings.
+  void Release(se::gpu::GpuStreamHandle stream, std::unique_ptr<Block> block,
+               sycl::event done) {
+    block->last_use = std::move(done);
+    absl::MutexLock lock(&mu_);
+    if (block->bytes <= kMaxCachedBytes && !cached_.contains(stream)) {
+      cached_.emplace(stream, std::move(block));
+    } else {
+      retired_.push_back(std::move(block));
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxCachedBytes = size_t{64} << 20;
+
+  // Removes and returns the retired blocks that no copy touches any more.
+  // Others stay for a later Acquire, so no caller blocks on a stream.
+  std::vector<std::unique_ptr<Block>> TakeIdleRetired()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::vector<std::unique_ptr<Block>> idle;
+    auto first_idle =
+        std::partition(retired_.begin(), retired_.end(),
+                       [](const std::unique_ptr<Block>& block) {
+                         return !block->Idle();
+                       });
+    std::move(first_idle, retired_.end(), std::back_inserter(idle));
+    retired_.erase(first_idle, retired_.end());
+    return idle;
+  }
+
+  absl::Mutex mu_;
+  // Blocks between rings, by leader stream. A leased block is not in here, so
+  // concurrent rings of one stream never share one.
+  absl::flat_hash_map<se::gpu::GpuStreamHandle, std::unique_ptr<Block>> cached_
+      ABSL_GUARDED_BY(mu_);
+  // Blocks waiting for their last copy.
+  std::vector<std::unique_ptr<Block>> retired_ ABSL_GUARDED_BY(mu_);
+};
+
 struct Manager {
   static Manager& instance() {
-    static Manager m;
-    return m;
+    static Manager* m = new Manager();
+    return *m;
+  }
+
+  RendezvousMap<Participant> collectives;
+  RendezvousMap<AlltoAllParticipant> alltoall_collectives;
+  RendezvousMap<PermuteParticipant> permute_collectives;
+  DevicePointerTables pointer_tables;
+  HostStagingBuffers host_staging;
+};
+
+template <typename ParticipantT>
+RendezvousSlot<ParticipantT>& GetSlot(RendezvousMap<ParticipantT>& map,
+                                      ncclComm_t comm) {
+  return map.Get(comm->clique, comm->local_nranks);
+}
+
+// Send pointers of all ranks followed by their receive pointers.
+inline StatusOr<std::shared_ptr<DevicePointerTables::Table>> GetPointerTable(
+    se::gpu::GpuStreamHandle stream, absl::Span<const Participant> p) {
+  const int n = p.size();
+  std::vector<void*> ptrs(2 * n);
+  for (int i = 0; i < n; ++i) {
+    ptrs[i] = const_cast<void*>(p[i].send);
+    ptrs[n + i] = p[i].recv;
+  }
+  return Manager::instance().pointer_tables.Get(stream, std::move(ptrs));
+}
+
+// Send pointers as an n x n row-major matrix indexed [rank][peer], followed by
+// the receive pointers in the same layout.
+inline StatusOr<std::shared_ptr<DevicePointerTables::Table>> GetPointerTable(
+    se::gpu::GpuStreamHandle stream, absl::Span<const AlltoAllParticipant> p) {
+  const int n = p.size();
+  std::vector<void*> ptrs(2 * n * n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      ptrs[i * n + j] = const_cast<void*>(p[i].send[j]);
+      ptrs[n * n + i * n + j] = p[i].recv[j];
+    }
   }
+  return Manager::instance().pointer_tables.Get(stream, std::move(ptrs));
+}
+
+// Reduction kernels move kVectorBytes per rank per load so that every access
+// to a peer buffer is a full-width transaction over Xe-Link/MDFI.
+constexpr int kVectorBytes = 16;
 
-  tsl::mutex mu;
-  tsl::condition_variable cv;
-  // The order should be: (r0p0, r1p0), (r0p1, r1p1)
-  std::unordered_map<std::string, std::vector<Participant>> collectives
-      TF_GUARDED_BY(mu);
-  std::unordered_map<std::string, std::vector<AlltoAllParticipant>>
-      alltoall_collectives TF_GUARDED_BY(mu);
-  std::unordered_map<std::string, std::vector<PermuteParticipant>>
-      permute_collectives TF_GUARDED_BY(mu);
+template <typename T>
+constexpr int VectorSize() {
+  return sizeof(T) >= kVectorBytes ? 1 : kVectorBytes / sizeof(T);
+}
+
+template <typename T, int vec_size>
+struct alignas(sizeof(T) * vec_size) AlignedVector {
+  T val[vec_size];
 };
 
-template <typename T, typename Func, int reduction_size>
+inline bool IsVectorAligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % kVectorBytes == 0;
+}
+
+inline bool ParticipantsVectorAligned(absl::Span<const Participant> p,
+                                      int reduction_size) {
+  for (int i = 0; i < reduction_size; ++i) {
+    if (!IsVectorAligned(p[i].send) || !IsVectorAligned(p[i].recv))
+      return false;
+  }
+  return true;
+}
+
+// Kernels below use a grid-stride loop, so the grid is capped at one
+// work-group per compute unit and each work-item handles several vectors.
+inline size_t GetNumWorkGroups(se::gpu::GpuStreamHandle stream,
+                               size_t group_size, int64_t work_items) {
+  auto compute_units =
+      (*stream)
+          .get_device()
+          .template get_info<sycl::info::device::max_compute_units>();
+  size_t num_workgroup = (work_items + group_size - 1) / group_size;
+  return std::max<size_t>(1, std::min<size_t>(num_workgroup, compute_units));
+}
+
+template <typename T, typename Func, int vec_size>
 struct AllReduceKernel;
 
-template <typename T, typename Func, typename AccT = T>
-void allreduce_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                     std::vector<Participant>& participants,
-                     int reduction_size) {
+// Reads vec_size elements from every rank, reduces them in AccT and writes the
+// result to every rank's output in the same pass.
+template <typename T, typename Func, typename AccT, int vec_size>
+Status allreduce_vec_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                           absl::Span<const Participant> participants,
+                           int reduction_size) {
+  using VecT = AlignedVector<T, vec_size>;
   auto group_size =
       (*stream)
           .get_device()
           .template get_info<sycl::info::device::max_work_group_size>();
-  auto num_workgroup = (tensor_size + group_size - 1) / group_size;
+  const int num_vecs = tensor_size / vec_size;
+  const int tail_start = num_vecs * vec_size;
+  auto num_workgroup =
+      GetNumWorkGroups(stream, group_size, std::max(num_vecs, 1));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<DevicePointerTables::Table> table,
+                      GetPointerTable(stream, participants));
+
+  table->last_use = stream->submit([&](sycl::handler& cgh) {
+    cgh.depends_on(table->ready);
+    void* const* ptrs = table->data;
+
+    cgh.parallel_for<AllReduceKernel<T, Func, vec_size>>(
+        sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
+                          sycl::range<1>(group_size)),
+        [=](sycl::nd_item<1> item) {
+          const int id = item.get_global_linear_id();
+          const int stride = item.get_global_range(0);
+          for (int v = id; v < num_vecs; v += stride) {
+            AccT acc[vec_size];
+            VecT data = reinterpret_cast<const VecT*>(ptrs[0])[v];
+#pragma unroll
+            for (int k = 0; k < vec_size; ++k) acc[k] = AccT(data.val[k]);
+            for (int r = 1; r < reduction_size; ++r) {
+              data = reinterpret_cast<const VecT*>(ptrs[r])[v];
+#pragma unroll
+              for (int k = 0; k < vec_size; ++k)
+                acc[k] = Func()(acc[k], AccT(data.val[k]));
+            }
+#pragma unroll
+            for (int k = 0; k < vec_size; ++k) data.val[k] = T(acc[k]);
+            for (int r = 0; r < reduction_size; ++r)
+              reinterpret_cast<VecT*>(ptrs[reduction_size + r])[v] = data;
+          }
+
+          // Fewer than vec_size elements are left over; finish them scalar.
+          const int index = tail_start + id;
+          if (index >= tensor_size) return;
+          AccT acc = AccT(static_cast<const T*>(ptrs[0])[index]);
+          for (int r = 1; r < reduction_size; ++r)
+            acc = Func()(acc, AccT(static_cast<const T*>(ptrs[r])[index]));
+          for (int r = 0; r < reduction_size; ++r)
+            static_cast<T*>(ptrs[reduction_size + r])[index] = T(acc);
+        });
+  });
+  return OkStatus();
+}
 
-#define IN(i) in##i##_ptr
-#define OUT(i) out##i##_ptr
-#define IN_PTR(i) auto IN(i) = static_cast<const T*>(participants[i].send)
-#define OUT_PTR(i) auto OUT(i) = static_cast<T*>(participants[i].recv)
-#define ADD_DPCPP(i, j) \
-  OUT(i)[index] = T(Func()(AccT(OUT(i)[index]), AccT(IN(j)[index])))
-#define COPY_OUT_DPCPP(i, j) OUT(i)[index] = OUT(j)[index]
-
-  if (reduction_size == 2) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      OUT_PTR(0);
-      OUT_PTR(1);
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 2>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            COPY_OUT_DPCPP(1, 0);
-          });
-    });
-  } else if (reduction_size == 4) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      IN_PTR(2);
-      IN_PTR(3);
-      OUT_PTR(0);
-      OUT_PTR(1);
-      OUT_PTR(2);
-      OUT_PTR(3);
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 4>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            ADD_DPCPP(0, 2);
-            ADD_DPCPP(0, 3);
-            COPY_OUT_DPCPP(1, 0);
-            COPY_OUT_DPCPP(2, 0);
-            COPY_OUT_DPCPP(3, 0);
-          });
-    });
-  } else if (reduction_size == 6) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      IN_PTR(2);
-      IN_PTR(3);
-      IN_PTR(4);
-      IN_PTR(5);
-      OUT_PTR(0);
-      OUT_PTR(1);
-      OUT_PTR(2);
-      OUT_PTR(3);
-      OUT_PTR(4);
-      OUT_PTR(5);
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 6>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            ADD_DPCPP(0, 2);
-            ADD_DPCPP(0, 3);
-            ADD_DPCPP(0, 4);
-            ADD_DPCPP(0, 5);
-            COPY_OUT_DPCPP(1, 0);
-            COPY_OUT_DPCPP(2, 0);
-            COPY_OUT_DPCPP(3, 0);
-            COPY_OUT_DPCPP(4, 0);
-            COPY_OUT_DPCPP(5, 0);
-          });
-    });
-  } else if (reduction_size == 8) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      IN_PTR(2);
-      IN_PTR(3);
-      IN_PTR(4);
-      IN_PTR(5);
-      IN_PTR(6);
-      IN_PTR(7);
-      OUT_PTR(0);
-      OUT_PTR(1);
-      OUT_PTR(2);
-      OUT_PTR(3);
-      OUT_PTR(4);
-      OUT_PTR(5);
-      OUT_PTR(6);
-      OUT_PTR(7);
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 8>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            ADD_DPCPP(0, 2);
-            ADD_DPCPP(0, 3);
-            ADD_DPCPP(0, 4);
-            ADD_DPCPP(0, 5);
-            ADD_DPCPP(0, 6);
-            ADD_DPCPP(0, 7);
-            COPY_OUT_DPCPP(1, 0);
-            COPY_OUT_DPCPP(2, 0);
-            COPY_OUT_DPCPP(3, 0);
-            COPY_OUT_DPCPP(4, 0);
-            COPY_OUT_DPCPP(5, 0);
-            COPY_OUT_DPCPP(6, 0);
-            COPY_OUT_DPCPP(7, 0);
-          });
-    });
-  } else if (reduction_size == 10) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      IN_PTR(2);
-      IN_PTR(3);
-      IN_PTR(4);
-      IN_PTR(5);
-      IN_PTR(6);
-      IN_PTR(7);
-      IN_PTR(8);
-      IN_PTR(9);
-      OUT_PTR(0);
-      OUT_PTR(1);
-      OUT_PTR(2);
-      OUT_PTR(3);
-      OUT_PTR(4);
-      OUT_PTR(5);
-      OUT_PTR(6);
-      OUT_PTR(7);
-      OUT_PTR(8);
-      OUT_PTR(9);
-      ;
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 10>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            ADD_DPCPP(0, 2);
-            ADD_DPCPP(0, 3);
-            ADD_DPCPP(0, 4);
-            ADD_DPCPP(0, 5);
-            ADD_DPCPP(0, 6);
-            ADD_DPCPP(0, 7);
-            ADD_DPCPP(0, 8);
-            ADD_DPCPP(0, 9);
-            COPY_OUT_DPCPP(1, 0);
-            COPY_OUT_DPCPP(2, 0);
-            COPY_OUT_DPCPP(3, 0);
-            COPY_OUT_DPCPP(4, 0);
-            COPY_OUT_DPCPP(5, 0);
-            COPY_OUT_DPCPP(6, 0);
-            COPY_OUT_DPCPP(7, 0);
-            COPY_OUT_DPCPP(8, 0);
-            COPY_OUT_DPCPP(9, 0);
-          });
-    });
-  } else if (reduction_size == 12) {
-    stream->submit([&](sycl::handler& cgh) {
-      IN_PTR(0);
-      IN_PTR(1);
-      IN_PTR(2);
-      IN_PTR(3);
-      IN_PTR(4);
-      IN_PTR(5);
-      IN_PTR(6);
-      IN_PTR(7);
-      IN_PTR(8);
-      IN_PTR(9);
-      IN_PTR(10);
-      IN_PTR(11);
-      OUT_PTR(0);
-      OUT_PTR(1);
-      OUT_PTR(2);
-      OUT_PTR(3);
-      OUT_PTR(4);
-      OUT_PTR(5);
-      OUT_PTR(6);
-      OUT_PTR(7);
-      OUT_PTR(8);
-      OUT_PTR(9);
-      OUT_PTR(10);
-      OUT_PTR(11);
-
-      cgh.parallel_for<AllReduceKernel<T, Func, 12>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            ADD_DPCPP(0, 1);
-            ADD_DPCPP(0, 2);
-            ADD_DPCPP(0, 3);
-            ADD_DPCPP(0, 4);
-            ADD_DPCPP(0, 5);
-            ADD_DPCPP(0, 6);
-            ADD_DPCPP(0, 7);
-            ADD_DPCPP(0, 8);
-            ADD_DPCPP(0, 9);
-            ADD_DPCPP(0, 10);
-            ADD_DPCPP(0, 11);
-            COPY_OUT_DPCPP(1, 0);
-            COPY_OUT_DPCPP(2, 0);
-            COPY_OUT_DPCPP(3, 0);
-            COPY_OUT_DPCPP(4, 0);
-            COPY_OUT_DPCPP(5, 0);
-            COPY_OUT_DPCPP(6, 0);
-            COPY_OUT_DPCPP(7, 0);
-            COPY_OUT_DPCPP(8, 0);
-            COPY_OUT_DPCPP(9, 0);
-            COPY_OUT_DPCPP(10, 0);
-            COPY_OUT_DPCPP(11, 0);
-          });
-    });
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in AllReduce.";
+template <typename T, typename Func, typename AccT = T>
+Status allreduce_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                       absl::Span<const Participant> participants,
+                       int reduction_size) {
+  if (ParticipantsVectorAligned(participants, reduction_size)) {
+    return allreduce_vec_dpcpp<T, Func, AccT, VectorSize<T>()>(
+        stream, tensor_size, participants, reduction_size);
   }
+  return allreduce_vec_dpcpp<T, Func, AccT, 1>(stream, tensor_size,
+                                               participants, reduction_size);
 }
 
-template <typename T>
+// Whether the device of `stream` can read and write the memory of the device
+// of `peer` directly. Answers are cached since the topology does not change.
+inline bool CanAccessPeer(se::gpu::GpuStreamHandle stream,
+                          se::gpu::GpuStreamHandle peer) {
+  static absl::Mutex mu(absl::kConstInit);
+  static auto* cache = new absl::flat_hash_map<
+      std::pair<ze_device_handle_t, ze_device_handle_t>, bool>();
+
+  ze_device_handle_t device =
+      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(
+          stream->get_device());
+  ze_device_handle_t peer_device =
+      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(
+          peer->get_device());
+  if (device == peer_device) return true;
+  absl::MutexLock lock(&mu);
+  auto [it, inserted] = cache->try_emplace({device, peer_device}, false);
+  if (inserted) {
+    ze_bool_t can_access = false;
+    it->second = zeDeviceCanAccessPeer(device, peer_device, &can_access) ==
+                     ZE_RESULT_SUCCESS &&
+                 can_access;
+  }
+  return it->second;
+}
+
+// Whether the leader's device can read and write every peer's memory directly.
+inline bool HasPeerAccess(se::gpu::GpuStreamHandle stream,
+                          absl::Span<const Participant> p) {
+  for (int i = 1; i < p.size(); ++i) {
+    if (!CanAccessPeer(stream, p[i].stream)) return false;
+  }
+  return true;
+}
+
+// XLA_SYCL_RING_ALLGATHER=1 starts the process with the ring variant, e.g. to
+// compare the two algorithms on a P2P-capable node.
+std::atomic<AllGatherAlgorithm>& AllGatherAlgorithmSetting() {
+  static auto* algorithm = [] {
+    bool force_ring = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_SYCL_RING_ALLGATHER",
+                                        /*default_val=*/false, &force_ring));
+    return new std::atomic<AllGatherAlgorithm>(
+        force_ring ? AllGatherAlgorithm::kRing : AllGatherAlgorithm::kAuto);
+  }();
+  return *algorithm;
+}
+
+template <typename T, int vec_size>
 struct AllGatherKernel;
 
+// Each work-item reads one vector of some rank's shard and writes it straight
+// into that shard's slot in every rank's output, so each input is read once
+// and no output is copied again afterwards.
+template <typename T, int vec_size>
+Status allgather_direct_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                              absl::Span<const Participant> participants,
+                              int reduction_size) {
+  using VecT = AlignedVector<T, vec_size>;
+  auto group_size =
+      (*stream)
+          .get_device()
+          .template get_info<sycl::info::device::max_work_group_size>();
+  // tensor_size: input tensor size
+  const int num_vecs = tensor_size / vec_size;
+  const int64_t total_vecs = static_cast<int64_t>(num_vecs) * reduction_size;
+  auto num_workgroup =
+      GetNumWorkGroups(stream, group_size, std::max<int64_t>(total_vecs, 1));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<DevicePointerTables::Table> table,
+                      GetPointerTable(stream, participants));
+
+  table->last_use = stream->submit([&](sycl::handler& cgh) {
+    cgh.depends_on(table->ready);
+    void* const* ptrs = table->data;
+
+    cgh.parallel_for<AllGatherKernel<T, vec_size>>(
+        sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
+                          sycl::range<1>(group_size)),
+        [=](sycl::nd_item<1> item) {
+          const int64_t stride = item.get_global_range(0);
+          for (int64_t g = item.get_global_linear_id(); g < total_vecs;
+               g += stride) {
+            const int i = g / num_vecs;
+            const int v = g % num_vecs;
+            const VecT data = reinterpret_cast<const VecT*>(ptrs[i])[v];
+            const int64_t offset = static_cast<int64_t>(num_vecs) * i + v;
+            for (int j = 0; j < reduction_size; ++j)
+              reinterpret_cast<VecT*>(ptrs[reduction_size + j])[offset] = data;
+          }
+        });
+  });
+  return OkStatus();
+}
+
+// Ring all-gather for devices without peer access. In step s every rank
+// forwards the shard it received in step s - 1 to its right neighbour on its
+// own stream, so only neighbouring devices exchange data and all ranks copy
+// concurrently.
+//
+// A rank writes straight into its neighbour's output only if its device can
+// reach that memory. Otherwise the shard goes through a pinned host slot: the
+// sender copies it out of its own device and the receiver copies it into its
+// own, so no copy touches another device's memory. `through_host` stages every
+// shard that way.
 template <typename T>
-void allgather_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                     std::vector<Participant>& participants,
-                     int reduction_size) {
-  if (reduction_size <= MAX_RANK_SIZE) {
-    const T* in_ptr[MAX_RANK_SIZE];
-    T* out_ptr[MAX_RANK_SIZE];
-
-    for (int i = 0; i < reduction_size; ++i) {
-      in_ptr[i] = static_cast<const T*>(participants[i].send);
-      out_ptr[i] = static_cast<T*>(participants[i].recv);
-    }
+Status allgather_ring_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                            absl::Span<const Participant> participants,
+                            int reduction_size, bool through_host) {
+  const int n = reduction_size;
+  const size_t bytes = tensor_size * sizeof(T);
+  auto shard = [&](int rank, int index) {
+    return static_cast<T*>(participants[rank].recv) +
+           static_cast<int64_t>(tensor_size) * index;
+  };
+
+  std::vector<bool> direct(n);
+  bool staged = false;
+  for (int i = 0; i < n; ++i) {
+    const int right = (i + 1) % n;
+    direct[i] = !through_host && CanAccessPeer(participants[i].stream,
+                                               participants[right].stream);
+    staged |= !direct[i];
+  }
+  HostStagingBuffers& host_staging = Manager::instance().host_staging;
+  std::unique_ptr<HostStagingBuffers::Block> block;
+  T* staging = nullptr;
+  if (staged) {
+    TF_ASSIGN_OR_RETURN(block, host_staging.Acquire(stream, n * bytes));
+    staging = static_cast<T*>(block->data);
+  }
 
-    for (int i = 0; i < reduction_size; ++i) {
-      stream->memcpy(out_ptr[0] + tensor_size * i, (const void*)in_ptr[i],
-                     tensor_size * sizeof(T));
+  // Everything already enqueued on the leader's stream, including its wait on
+  // the other ranks, must finish before any rank starts writing.
+  const std::vector<sycl::event> start{stream->ext_oneapi_submit_barrier()};
+  std::vector<sycl::event> received(n);
+  for (int i = 0; i < n; ++i) {
+    received[i] = participants[i].stream->memcpy(
+        shard(i, i), participants[i].send, bytes, start);
+  }
+  // Completes when the right neighbour of rank i has copied the previous shard
+  // out of rank i's host slot.
+  std::vector<sycl::event> drained(n);
+  for (int s = 1; s < n; ++s) {
+    std::vector<sycl::event> next(n);
+    for (int i = 0; i < n; ++i) {
+      const int right = (i + 1) % n;
+      const int index = (i - s + 1 + n) % n;
+      if (direct[i]) {
+        next[right] = participants[i].stream->memcpy(
+            shard(right, index), shard(i, index), bytes, received[i]);
+        continue;
+      }
+      T* slot = staging + static_cast<int64_t>(tensor_size) * i;
+      std::vector<sycl::event> deps{received[i]};
+      if (s > 1) deps.push_back(drained[i]);
+      const sycl::event copied_out =
+          participants[i].stream->memcpy(slot, shard(i, index), bytes, deps);
+      next[right] = participants[right].stream->memcpy(shard(right, index),
+                                                       slot, bytes, copied_out);
+      drained[i] = next[right];
     }
+    received = std::move(next);
+  }
+  sycl::event done = stream->ext_oneapi_submit_barrier(received);
+  if (block != nullptr) {
+    host_staging.Release(stream, std::move(block), std::move(done));
+  }
+  return OkStatus();
+}
 
-    for (int i = 1; i < reduction_size; ++i) {
-      stream->memcpy(out_ptr[i], (void*)out_ptr[0],
-                     reduction_size * tensor_size * sizeof(T));
-    }
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in AllGather.";
+template <typename T>
+Status allgather_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                       absl::Span<const Participant> participants,
+                       int reduction_size) {
+  switch (AllGatherAlgorithmSetting().load(std::memory_order_relaxed)) {
+    case AllGatherAlgorithm::kAuto:
+      break;
+    case AllGatherAlgorithm::kRing:
+      return allgather_ring_dpcpp<T>(stream, tensor_size, participants,
+                                     reduction_size, /*through_host=*/false);
+    case AllGatherAlgorithm::kRingThroughHost:
+      return allgather_ring_dpcpp<T>(stream, tensor_size, participants,
+                                     reduction_size, /*through_host=*/true);
+  }
+  if (!HasPeerAccess(stream, participants)) {
+    return allgather_ring_dpcpp<T>(stream, tensor_size, participants,
+                                   reduction_size, /*through_host=*/false);
   }
+  if (tensor_size % VectorSize<T>() == 0 &&
+      ParticipantsVectorAligned(participants, reduction_size)) {
+    return allgather_direct_dpcpp<T, VectorSize<T>()>(
+        stream, tensor_size, participants, reduction_size);
+  }
+  return allgather_direct_dpcpp<T, 1>(stream, tensor_size, participants,
+                                      reduction_size);
 }
 
 template <typename T>
 struct AllToAllKernel;
 
 template <typename T>
-void alltoall_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                    std::vector<AlltoAllParticipant>& participants,
-                    int reduction_size) {
-  const int kLimitedRankSize = MAX_RANK_SIZE / 2;
+Status alltoall_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                      absl::Span<const AlltoAllParticipant> participants,
+                      int reduction_size) {
   auto group_size =
       (*stream)
           .get_device()
           .template get_info<sycl::info::device::max_work_group_size>();
   auto num_workgroup = (tensor_size + group_size - 1) / group_size;
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<DevicePointerTables::Table> table,
+                      GetPointerTable(stream, participants));
+  const int n = reduction_size;
 
   // Process: send vec -> rev vec
   // P0: (a0, a1) -> (a0, b0)
   // P1: (b0, b1) -> (a1, b1)
-  if (reduction_size <= kLimitedRankSize) {
-    stream->submit([&](sycl::handler& cgh) {
-      const T* send[kLimitedRankSize][kLimitedRankSize];
-      T* recv[kLimitedRankSize][kLimitedRankSize];
-
-      for (int i = 0; i < reduction_size; ++i) {
-        for (int j = 0; j < reduction_size; ++j) {
-          send[i][j] = static_cast<const T*>(participants[i].send[j]);
-          recv[i][j] = static_cast<T*>(participants[i].recv[j]);
-        }
-      }
-
-      cgh.parallel_for<AllToAllKernel<T>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-
-            for (int i = 0; i < reduction_size; ++i) {
-              for (int j = 0; j < reduction_size; ++j) {
-                recv[j][i][index] = send[i][j][index];
-              }
+  table->last_use = stream->submit([&](sycl::handler& cgh) {
+    cgh.depends_on(table->ready);
+    void* const* send = table->data;
+    void* const* recv = table->data + n * n;
+
+    cgh.parallel_for<AllToAllKernel<T>>(
+        sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
+                          sycl::range<1>(group_size)),
+        [=](sycl::nd_item<1> item) {
+          const int index = item.get_global_linear_id();
+          if (index >= tensor_size) return;
+
+          for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+              static_cast<T*>(recv[j * n + i])[index] =
+                  static_cast<const T*>(send[i * n + j])[index];
             }
-          });
-    });
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in AllToAll.";
-  }
+          }
+        });
+  });
+  return OkStatus();
 }
 
 template <typename T>
 struct AllToAllSplitKernel;
 
 template <typename T>
-void alltoall_split_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                          std::vector<AlltoAllParticipant>& participants,
-                          int reduction_size) {
-  const int kLimitedRankSize = MAX_RANK_SIZE / 2;
+Status alltoall_split_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                            absl::Span<const AlltoAllParticipant> participants,
+                            int reduction_size) {
   auto group_size =
       (*stream)
           .get_device()
           .template get_info<sycl::info::device::max_work_group_size>();
   int sub_tensor_size = tensor_size / reduction_size;
   auto num_workgroup = (sub_tensor_size + group_size - 1) / group_size;
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<DevicePointerTables::Table> table,
+                      GetPointerTable(stream, participants));
+  const int n = reduction_size;
 
   // clang-format off
   // Process: send vec -> rev vec
   // P0: ([a0, a1], [b0, b1], [c0, c1], ...) -> ([a0, d0], [b0, e0], [c0, f0], ...)
   // P1: ([d0, d1], [e0, e1], [f0, f1], ...) -> ([a1, d1], [b1, e1], [c1, f1], ...)
   // clang-format on
-  if (reduction_size <= kLimitedRankSize) {
-    stream->submit([&](sycl::handler& cgh) {
-      const T* send[kLimitedRankSize][kLimitedRankSize];  // SYCL: fix size
-      T* recv[kLimitedRankSize][kLimitedRankSize];        // SYCL: fix size
-
-      for (int i = 0; i < reduction_size; ++i) {
-        for (int k = 0; k < reduction_size; ++k) {  // SYCL: fix size
-          send[i][k] = static_cast<const T*>(participants[i].send[k]);
-          recv[i][k] = static_cast<T*>(participants[i].recv[k]);
-        }
-      }
-
-      cgh.parallel_for<AllToAllSplitKernel<T>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= sub_tensor_size) return;
-
-            for (int k = 0; k < reduction_size; ++k) {  // SYCL: fix size
-              for (int i = 0; i < reduction_size; ++i) {
-                for (int j = 0; j < reduction_size; ++j) {
-                  recv[i][k][j * sub_tensor_size + index] =
-                      send[j][k][i * sub_tensor_size + index];
-                }
+  table->last_use = stream->submit([&](sycl::handler& cgh) {
+    cgh.depends_on(table->ready);
+    void* const* send = table->data;
+    void* const* recv = table->data + n * n;
+
+    cgh.parallel_for<AllToAllSplitKernel<T>>(
+        sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
+                          sycl::range<1>(group_size)),
+        [=](sycl::nd_item<1> item) {
+          const int index = item.get_global_linear_id();
+          if (index >= sub_tensor_size) return;
+
+          for (int k = 0; k < n; ++k) {
+            for (int i = 0; i < n; ++i) {
+              for (int j = 0; j < n; ++j) {
+                static_cast<T*>(recv[i * n + k])[j * sub_tensor_size + index] =
+                    static_cast<const T*>(
+                        send[j * n + k])[i * sub_tensor_size + index];
               }
             }
-          });
-    });
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in AllToAll.";
-  }
+          }
+        });
+  });
+  return OkStatus();
 }
 
-template <typename T, typename Func>
+template <typename T, typename Func, int vec_size>
 struct ReduceScatterKernel;
 
-template <typename T, typename Func, typename AccT = T>
-void reducescatter_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                         std::vector<Participant>& participants,
-                         int reduction_size) {
+// Work is flattened over (output rank, vector) so every rank's chunk is reduced
+// concurrently instead of one rank after another.
+template <typename T, typename Func, typename AccT, int vec_size>
+Status reducescatter_vec_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                               absl::Span<const Participant> participants,
+                               int reduction_size) {
+  using VecT = AlignedVector<T, vec_size>;
   auto group_size =
       (*stream)
           .get_device()
           .template get_info<sycl::info::device::max_work_group_size>();
   // tensor_size: output tensor size
-  auto num_workgroup = (tensor_size + group_size - 1) / group_size;
-
-  if (reduction_size <= MAX_RANK_SIZE) {
-    stream->submit([&](sycl::handler& cgh) {
-      const T* in[MAX_RANK_SIZE];
-      T* out[MAX_RANK_SIZE];
-
-      for (int i = 0; i < reduction_size; ++i) {
-        in[i] = static_cast<const T*>(participants[i].send);
-        out[i] = static_cast<T*>(participants[i].recv);
-      }
-
-      cgh.parallel_for<ReduceScatterKernel<T, Func>>(
-          sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
-                            sycl::range<1>(group_size)),
-          [=](sycl::nd_item<1> item) {
-            const int index = item.get_global_linear_id();
-            if (index >= tensor_size) return;
-            for (int i = 0; i < reduction_size; ++i) {
-              out[i][index] = T(Func()(AccT(in[0][index + tensor_size * i]),
-                                       AccT(in[1][index + tensor_size * i])));
-              for (int j = 2; j < reduction_size; ++j) {
-                out[i][index] = T(Func()(AccT(out[i][index]),
-                                         AccT(in[j][index + tensor_size * i])));
-              }
+  const int num_vecs = tensor_size / vec_size;
+  const int64_t total_vecs = static_cast<int64_t>(num_vecs) * reduction_size;
+  auto num_workgroup =
+      GetNumWorkGroups(stream, group_size, std::max<int64_t>(total_vecs, 1));
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<DevicePointerTables::Table> table,
+                      GetPointerTable(stream, participants));
+
+  table->last_use = stream->submit([&](sycl::handler& cgh) {
+    cgh.depends_on(table->ready);
+    void* const* ptrs = table->data;
+
+    cgh.parallel_for<ReduceScatterKernel<T, Func, vec_size>>(
+        sycl::nd_range<1>(sycl::range<1>(group_size * num_workgroup),
+                          sycl::range<1>(group_size)),
+        [=](sycl::nd_item<1> item) {
+          const int64_t stride = item.get_global_range(0);
+          for (int64_t g = item.get_global_linear_id(); g < total_vecs;
+               g += stride) {
+            const int i = g / num_vecs;
+            const int v = g % num_vecs;
+            const int64_t offset = static_cast<int64_t>(num_vecs) * i + v;
+            AccT acc[vec_size];
+            VecT data = reinterpret_cast<const VecT*>(ptrs[0])[offset];
+#pragma unroll
+            for (int k = 0; k < vec_size; ++k) acc[k] = AccT(data.val[k]);
+            for (int j = 1; j < reduction_size; ++j) {
+              data = reinterpret_cast<const VecT*>(ptrs[j])[offset];
+#pragma unroll
+              for (int k = 0; k < vec_size; ++k)
+                acc[k] = Func()(acc[k], AccT(data.val[k]));
             }
-          });
-    });
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in ReduceScatter.";
+#pragma unroll
+            for (int k = 0; k < vec_size; ++k) data.val[k] = T(acc[k]);
+            reinterpret_cast<VecT*>(ptrs[reduction_size + i])[v] = data;
+          }
+        });
+  });
+  return OkStatus();
+}
+
+template <typename T, typename Func, typename AccT = T>
+Status reducescatter_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
+                           absl::Span<const Participant> participants,
+                           int reduction_size) {
+  // Each rank's input chunk starts tensor_size elements after the previous
+  // one, so the vector path also needs tensor_size to be a whole number of
+  // vectors.
+  if (tensor_size % VectorSize<T>() == 0 &&
+      ParticipantsVectorAligned(participants, reduction_size)) {
+    return reducescatter_vec_dpcpp<T, Func, AccT, VectorSize<T>()>(
+        stream, tensor_size, participants, reduction_size);
   }
+  return reducescatter_vec_dpcpp<T, Func, AccT, 1>(
+      stream, tensor_size, participants, reduction_size);
 }
 
 template <typename T, int size>
@@ -509,24 +818,18 @@ struct CollectivePermuteKernel;
 
 template <typename T>
 void permute_dpcpp(se::gpu::GpuStreamHandle stream, int tensor_size,
-                   std::vector<PermuteParticipant>& participants,
+                   absl::Span<const PermuteParticipant> participants,
                    int reduction_size) {
-  if (reduction_size <= MAX_RANK_SIZE) {
-    for (int i = 0; i < reduction_size; ++i)
-      if (participants[i].send_id)
-        stream->memcpy(participants[i].recv,
-                       (const void*)participants[*participants[i].send_id].send,
-                       tensor_size * sizeof(T));
-
-  } else {
-    LOG(FATAL) << "Reduction size " << reduction_size
-               << " is not supported in Permute.";
-  }
+  for (int i = 0; i < reduction_size; ++i)
+    if (participants[i].send_id)
+      stream->memcpy(participants[i].recv,
+                     (const void*)participants[*participants[i].send_id].send,
+                     tensor_size * sizeof(T));
 }
 
 template <class T>
 void stream_wait_streamlist(se::gpu::GpuStreamHandle stream,
-                            const std::vector<T>& p) {
+                            absl::Span<const T> p) {
   std::vector<sycl::event> event_list;
   for (int i = 1; i < p.size(); i++) {
     sycl::event event = p[i].stream->ext_oneapi_submit_barrier();
@@ -537,7 +840,7 @@ void stream_wait_streamlist(se::gpu::GpuStreamHandle stream,
 
 template <class T>
 void streamlist_wait_stream(se::gpu::GpuStreamHandle stream,
-                            const std::vector<T>& p) {
+                            absl::Span<const T> p) {
   sycl::event event = stream->ext_oneapi_submit_barrier();
 
   const std::vector<sycl::event> event_list{event};
@@ -545,590 +848,845 @@ void streamlist_wait_stream(se::gpu::GpuStreamHandle stream,
     p[i].stream->ext_oneapi_submit_barrier(event_list);
   }
 }
-}  // namespace
 
-void sycl_allreduce(const void* send_buffer, void* recv_buffer,
-                    int element_count, PrimitiveType dtype,
-                    ReductionKind reduction_kind,
-                    se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                    int current_call, int max_call) {
-  std::vector<Participant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().collectives.find(comm->id) ==
-        Manager::instance().collectives.end()) {
-      std::vector<Participant> participants;
-      participants.push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      Manager::instance().collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().collectives[comm->id].push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      p = Manager::instance().collectives[comm->id];
-    }
+// Communicators spanning processes run the collective on the ranks of each
+// process first and then exchange host copies of the partial results over
+// the communicator's transport. The leader blocks on its stream for the
+// duration, which is acceptable since the exchange is bound by the network.
 
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().collectives.erase(comm->id);
-      std::sort(p.begin(), p.end(),
-                [](const Participant& a, const Participant& b) -> bool {
-                  return a.rank < b.rank;
-                });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      if (current_call == 0) stream_wait_streamlist(stream, p);
-
-      if (reduction_kind == ReductionKind::SUM) {
-        if (dtype == PRED)
-          allreduce_dpcpp<bool, sycl::plus<bool>>(stream, element_count, p,
-                                                  comm->nranks);
-        else if (dtype == F32)
-          allreduce_dpcpp<float, sycl::plus<float>>(stream, element_count, p,
-                                                    comm->nranks);
-        else if (dtype == F64)
-          allreduce_dpcpp<double, sycl::plus<double>>(stream, element_count, p,
-                                                      comm->nranks);
-        else if (dtype == S32)
-          allreduce_dpcpp<int32_t, sycl::plus<int32_t>>(stream, element_count,
-                                                        p, comm->nranks);
-        else if (dtype == S64)
-          allreduce_dpcpp<int64_t, sycl::plus<int64_t>>(stream, element_count,
-                                                        p, comm->nranks);
-        else if (dtype == U32)
-          allreduce_dpcpp<uint32_t, sycl::plus<uint32_t>>(stream, element_count,
-                                                          p, comm->nranks);
-        else if (dtype == U64)
-          allreduce_dpcpp<uint64_t, sycl::plus<uint64_t>>(stream, element_count,
-                                                          p, comm->nranks);
-        else if (dtype == C64)
-          allreduce_dpcpp<std::complex<float>, sycl::plus<std::complex<float>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C128)
-          allreduce_dpcpp<std::complex<double>,
-                          sycl::plus<std::complex<double>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          allreduce_dpcpp<bfloat16, sycl::plus<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in AllReduce.";
-      } else if (reduction_kind == ReductionKind::PRODUCT) {
-        if (dtype == PRED)
-          allreduce_dpcpp<bool, sycl::multiplies<bool>>(stream, element_count,
-                                                        p, comm->nranks);
-        else if (dtype == F32)
-          allreduce_dpcpp<float, sycl::multiplies<float>>(stream, element_count,
-                                                          p, comm->nranks);
-        else if (dtype == F64)
-          allreduce_dpcpp<double, sycl::multiplies<double>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S32)
-          allreduce_dpcpp<int32_t, sycl::multiplies<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          allreduce_dpcpp<int64_t, sycl::multiplies<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          allreduce_dpcpp<uint32_t, sycl::multiplies<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          allreduce_dpcpp<uint64_t, sycl::multiplies<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C64)
-          allreduce_dpcpp<std::complex<float>,
-                          sycl::multiplies<std::complex<float>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C128)
-          allreduce_dpcpp<std::complex<double>,
-                          sycl::multiplies<std::complex<double>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          allreduce_dpcpp<bfloat16, sycl::multiplies<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in AllReduce.";
-      } else if (reduction_kind == ReductionKind::MIN) {
-        if (dtype == PRED)
-          allreduce_dpcpp<bool, sycl::minimum<bool>>(stream, element_count, p,
-                                                     comm->nranks);
-        else if (dtype == F32)
-          allreduce_dpcpp<float, sycl::minimum<float>>(stream, element_count, p,
-                                                       comm->nranks);
-        else if (dtype == F64)
-          allreduce_dpcpp<double, sycl::minimum<double>>(stream, element_count,
-                                                         p, comm->nranks);
-        else if (dtype == S32)
-          allreduce_dpcpp<int32_t, sycl::minimum<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          allreduce_dpcpp<int64_t, sycl::minimum<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          allreduce_dpcpp<uint32_t, sycl::minimum<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          allreduce_dpcpp<uint64_t, sycl::minimum<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          allreduce_dpcpp<bfloat16, sycl::minimum<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in AllReduce.";
-      } else if (reduction_kind == ReductionKind::MAX) {
-        if (dtype == PRED)
-          allreduce_dpcpp<bool, sycl::maximum<bool>>(stream, element_count, p,
-                                                     comm->nranks);
-        else if (dtype == F32)
-          allreduce_dpcpp<float, sycl::maximum<float>>(stream, element_count, p,
-                                                       comm->nranks);
-        else if (dtype == F64)
-          allreduce_dpcpp<double, sycl::maximum<double>>(stream, element_count,
-                                                         p, comm->nranks);
-        else if (dtype == S32)
-          allreduce_dpcpp<int32_t, sycl::maximum<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          allreduce_dpcpp<int64_t, sycl::maximum<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          allreduce_dpcpp<uint32_t, sycl::maximum<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          allreduce_dpcpp<uint64_t, sycl::maximum<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          allreduce_dpcpp<bfloat16, sycl::maximum<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in AllReduce.";
-      } else {
-        LOG(FATAL) << "ReductionKind " << static_cast<int>(reduction_kind)
-                   << " is not supported in AllReduce.";
-      }
+using HostReduceFn = void (*)(void* acc, const void* in, int64_t count);
 
-      if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
-      Manager::instance().cv.notify_all();
-    }
+template <typename T, typename Func, typename AccT = T>
+void HostReduce(void* acc, const void* in, int64_t count) {
+  T* out = static_cast<T*>(acc);
+  const T* src = static_cast<const T*>(in);
+  for (int64_t i = 0; i < count; ++i)
+    out[i] = T(Func()(AccT(out[i]), AccT(src[i])));
+}
+
+template <template <typename> class Func>
+HostReduceFn GetHostReduceFn(PrimitiveType dtype) {
+  switch (dtype) {
+    case PRED:
+      return HostReduce<bool, Func<bool>>;
+    case F32:
+      return HostReduce<float, Func<float>>;
+    case F64:
+      return HostReduce<double, Func<double>>;
+    case S32:
+      return HostReduce<int32_t, Func<int32_t>>;
+    case S64:
+      return HostReduce<int64_t, Func<int64_t>>;
+    case U32:
+      return HostReduce<uint32_t, Func<uint32_t>>;
+    case U64:
+      return HostReduce<uint64_t, Func<uint64_t>>;
+    case S8:
+      return HostReduce<int8_t, Func<int8_t>>;
+    case U8:
+      return HostReduce<uint8_t, Func<uint8_t>>;
+    case BF16:
+      return HostReduce<bfloat16, Func<float>, float>;
+    case F16:
+      return HostReduce<sycl::half, Func<float>, float>;
+    default:
+      return nullptr;
   }
 }
 
-void sycl_allgather(const void* send_buffer, void* recv_buffer,
-                    int element_count, PrimitiveType dtype,
-                    se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                    int current_call, int max_call) {
-  std::vector<Participant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().collectives.find(comm->id) ==
-        Manager::instance().collectives.end()) {
-      std::vector<Participant> participants;
-      participants.push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      Manager::instance().collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().collectives[comm->id].push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      p = Manager::instance().collectives[comm->id];
-    }
+HostReduceFn GetHostReduceFn(PrimitiveType dtype,
+                             ReductionKind reduction_kind) {
+  switch (reduction_kind) {
+    case ReductionKind::SUM:
+      if (dtype == C64)
+        return HostReduce<std::complex<float>, sycl::plus<std::complex<float>>>;
+      if (dtype == C128)
+        return HostReduce<std::complex<double>,
+                          sycl::plus<std::complex<double>>>;
+      return GetHostReduceFn<sycl::plus>(dtype);
+    case ReductionKind::PRODUCT:
+      if (dtype == C64)
+        return HostReduce<std::complex<float>,
+                          sycl::multiplies<std::complex<float>>>;
+      if (dtype == C128)
+        return HostReduce<std::complex<double>,
+                          sycl::multiplies<std::complex<double>>>;
+      return GetHostReduceFn<sycl::multiplies>(dtype);
+    case ReductionKind::MIN:
+      return GetHostReduceFn<sycl::minimum>(dtype);
+    case ReductionKind::MAX:
+      return GetHostReduceFn<sycl::maximum>(dtype);
+  }
+  return nullptr;
+}
 
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().collectives.erase(comm->id);
-      std::sort(p.begin(), p.end(),
-                [](const Participant& a, const Participant& b) -> bool {
-                  return a.rank < b.rank;
-                });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      if (current_call == 0) stream_wait_streamlist(stream, p);
+StatusOr<HostReduceFn> GetHostReduceFn(PrimitiveType dtype,
+                                       ReductionKind reduction_kind,
+                                       const char* op_name) {
+  HostReduceFn reduce = GetHostReduceFn(dtype, reduction_kind);
+  if (reduce == nullptr) {
+    return Unimplemented(
+        "PrimitiveType %s is not supported in multi-process %s.",
+        primitive_util::LowercasePrimitiveTypeName(dtype), op_name);
+  }
+  return reduce;
+}
+
+// Every local rank already holds this process's partial result, so only the
+// leader's copy crosses the transport.
+Status InterNodeAllReduce(se::gpu::GpuStreamHandle stream, int element_count,
+                          PrimitiveType dtype, ReductionKind reduction_kind,
+                          absl::Span<const Participant> p,
+                          CclTransport& transport) {
+  TF_ASSIGN_OR_RETURN(HostReduceFn reduce,
+                      GetHostReduceFn(dtype, reduction_kind, "AllReduce"));
+  const size_t element_size = primitive_util::ByteWidth(dtype);
+  const size_t bytes = element_count * element_size;
+  std::vector<char> host(bytes);
+  stream->memcpy(host.data(), p[0].recv, bytes).wait();
+  TF_RETURN_IF_ERROR(RingAllReduce(transport, host.data(), element_count,
+                                   element_size, reduce));
+  std::vector<sycl::event> copies;
+  for (int i = 0; i < p.size(); ++i)
+    copies.push_back(stream->memcpy(p[i].recv, host.data(), bytes));
+  sycl::event::wait(copies);
+  return OkStatus();
+}
+
+// Ranks are numbered across processes in the order of the replica group, so
+// the blocks gathered per process are reordered by rank on the host.
+Status InterNodeAllGather(se::gpu::GpuStreamHandle stream, int element_count,
+                          PrimitiveType dtype, ncclComm_t comm,
+                          absl::Span<const Participant> p) {
+  CclTransport& transport = *comm->transport;
+  const size_t bytes = element_count * primitive_util::ByteWidth(dtype);
+  const int nranks = comm->nranks;
+
+  // slot[r] is the position of rank r's shard in the node-major layout.
+  std::vector<int> node_begin(transport.num_nodes() + 1, 0);
+  for (int r = 0; r < nranks; ++r) ++node_begin[comm->rank_to_node[r] + 1];
+  for (int n = 0; n < transport.num_nodes(); ++n)
+    node_begin[n + 1] += node_begin[n];
+  std::vector<size_t> block_bytes(transport.num_nodes());
+  for (int n = 0; n < transport.num_nodes(); ++n)
+    block_bytes[n] = (node_begin[n + 1] - node_begin[n]) * bytes;
+  std::vector<int> slot(nranks);
+  std::vector<int> next = node_begin;
+  for (int r = 0; r < nranks; ++r) slot[r] = next[comm->rank_to_node[r]]++;
+
+  std::vector<char> gathered(nranks * bytes);
+  std::vector<sycl::event> copies;
+  for (int i = 0; i < p.size(); ++i) {
+    copies.push_back(stream->memcpy(gathered.data() + slot[p[i].rank] * bytes,
+                                    p[i].send, bytes));
+  }
+  sycl::event::wait(copies);
+  TF_RETURN_IF_ERROR(RingAllGather(transport, gathered.data(), block_bytes));
+
+  std::vector<char> ordered(nranks * bytes);
+  for (int r = 0; r < nranks; ++r)
+    std::memcpy(ordered.data() + r * bytes, gathered.data() + slot[r] * bytes,
+                bytes);
+  copies.clear();
+  for (int i = 0; i < p.size(); ++i)
+    copies.push_back(stream->memcpy(p[i].recv, ordered.data(), nranks * bytes));
+  sycl::event::wait(copies);
+  return OkStatus();
+}
+
+// The full input is reduced across processes and each local rank then picks
+// its own chunk, which moves nranks times more data over the transport than a
+// dedicated reduce-scatter but keeps a single ring algorithm.
+Status InterNodeReduceScatter(se::gpu::GpuStreamHandle stream,
+                              int element_count, PrimitiveType dtype,
+                              ReductionKind reduction_kind, ncclComm_t comm,
+                              absl::Span<const Participant> p) {
+  TF_ASSIGN_OR_RETURN(HostReduceFn reduce,
+                      GetHostReduceFn(dtype, reduction_kind, "ReduceScatter"));
+  const size_t element_size = primitive_util::ByteWidth(dtype);
+  const int64_t total_count =
+      static_cast<int64_t>(element_count) * comm->nranks;
+  const size_t chunk_bytes = element_count * element_size;
+  const size_t total_bytes = total_count * element_size;
+
+  std::vector<std::vector<char>> inputs(p.size());
+  std::vector<sycl::event> copies;
+  for (int i = 0; i < p.size(); ++i) {
+    inputs[i].resize(total_bytes);
+    copies.push_back(stream->memcpy(inputs[i].data(), p[i].send, total_bytes));
+  }
+  sycl::event::wait(copies);
+  for (int i = 1; i < p.size(); ++i)
+    reduce(inputs[0].data(), inputs[i].data(), total_count);
+  TF_RETURN_IF_ERROR(RingAllReduce(*comm->transport, inputs[0].data(),
+                                   total_count, element_size, reduce));
+  copies.clear();
+  for (int i = 0; i < p.size(); ++i) {
+    copies.push_back(stream->memcpy(
+        p[i].recv, inputs[0].data() + p[i].rank * chunk_bytes, chunk_bytes));
+  }
+  sycl::event::wait(copies);
+  return OkStatus();
+}
+}  // namespace
+
+Status sycl_allreduce(const void* send_buffer, void* recv_buffer,
+                      int element_count, PrimitiveType dtype,
+                      ReductionKind reduction_kind,
+                      se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                      int current_call, int max_call) {
+  auto run = [&](absl::Span<const Participant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    if (current_call == 0) stream_wait_streamlist(stream, p);
+
+    Status status;
+    if (reduction_kind == ReductionKind::SUM) {
       if (dtype == PRED)
-        allgather_dpcpp<bool>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<bool, sycl::plus<bool>>(stream, element_count,
+                                                         p, comm->local_nranks);
       else if (dtype == F32)
-        allgather_dpcpp<float>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<float, sycl::plus<float>>(stream,
+                                                           element_count, p,
+                                                           comm->local_nranks);
       else if (dtype == F64)
-        allgather_dpcpp<double>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<double, sycl::plus<double>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S32)
-        allgather_dpcpp<int32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int32_t, sycl::plus<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S64)
-        allgather_dpcpp<int64_t>(stream, element_count, p, comm->nranks);
-      else if (dtype == BF16)
-        allgather_dpcpp<bfloat16>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int64_t, sycl::plus<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U32)
-        allgather_dpcpp<uint32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint32_t, sycl::plus<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U64)
-        allgather_dpcpp<uint64_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint64_t, sycl::plus<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C64)
+        status = allreduce_dpcpp<std::complex<float>,
+                                 sycl::plus<std::complex<float>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C128)
+        status = allreduce_dpcpp<std::complex<double>,
+                                 sycl::plus<std::complex<double>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = allreduce_dpcpp<bfloat16, sycl::plus<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = allreduce_dpcpp<sycl::half, sycl::plus<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = allreduce_dpcpp<int8_t, sycl::plus<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = allreduce_dpcpp<uint8_t, sycl::plus<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
       else
-        LOG(FATAL) << "PrimitiveType "
-                   << primitive_util::LowercasePrimitiveTypeName(dtype)
-                   << " is not supported in AllGather.";
-      if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
-      Manager::instance().cv.notify_all();
-    }
-  }
-}
-
-void sycl_alltoall(std::vector<const void*> send_buffers,
-                   std::vector<void*> recv_buffers, int element_count,
-                   PrimitiveType dtype, se::gpu::GpuStreamHandle gpu_stream,
-                   ncclComm_t comm) {
-  std::vector<AlltoAllParticipant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().alltoall_collectives.find(comm->id) ==
-        Manager::instance().alltoall_collectives.end()) {
-      std::vector<AlltoAllParticipant> participants;
-      participants.push_back(
-          {gpu_stream, send_buffers, recv_buffers, comm->rank});
-      Manager::instance().alltoall_collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().alltoall_collectives[comm->id].push_back(
-          {gpu_stream, send_buffers, recv_buffers, comm->rank});
-      p = Manager::instance().alltoall_collectives[comm->id];
-    }
-
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().alltoall_collectives.erase(comm->id);
-      std::sort(
-          p.begin(), p.end(),
-          [](const AlltoAllParticipant& a,
-             const AlltoAllParticipant& b) -> bool { return a.rank < b.rank; });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      stream_wait_streamlist(stream, p);
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in AllReduce.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::PRODUCT) {
       if (dtype == PRED)
-        alltoall_dpcpp<bool>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<bool, sycl::multiplies<bool>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == F32)
-        alltoall_dpcpp<float>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<float, sycl::multiplies<float>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == F64)
-        alltoall_dpcpp<double>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<double, sycl::multiplies<double>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S32)
-        alltoall_dpcpp<int32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int32_t, sycl::multiplies<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S64)
-        alltoall_dpcpp<int64_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int64_t, sycl::multiplies<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U32)
+        status = allreduce_dpcpp<uint32_t, sycl::multiplies<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U64)
+        status = allreduce_dpcpp<uint64_t, sycl::multiplies<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C64)
+        status = allreduce_dpcpp<std::complex<float>,
+                                 sycl::multiplies<std::complex<float>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C128)
+        status = allreduce_dpcpp<std::complex<double>,
+                                 sycl::multiplies<std::complex<double>>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == BF16)
-        alltoall_dpcpp<bfloat16>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<bfloat16, sycl::multiplies<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = allreduce_dpcpp<sycl::half, sycl::multiplies<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = allreduce_dpcpp<int8_t, sycl::multiplies<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = allreduce_dpcpp<uint8_t, sycl::multiplies<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in AllReduce.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::MIN) {
+      if (dtype == PRED)
+        status = allreduce_dpcpp<bool, sycl::minimum<bool>>(stream,
+                                                            element_count, p,
+                                                            comm->local_nranks);
+      else if (dtype == F32)
+        status = allreduce_dpcpp<float, sycl::minimum<float>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F64)
+        status = allreduce_dpcpp<double, sycl::minimum<double>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S32)
+        status = allreduce_dpcpp<int32_t, sycl::minimum<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S64)
+        status = allreduce_dpcpp<int64_t, sycl::minimum<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U32)
-        alltoall_dpcpp<uint32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint32_t, sycl::minimum<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U64)
-        alltoall_dpcpp<uint64_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint64_t, sycl::minimum<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = allreduce_dpcpp<bfloat16, sycl::minimum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = allreduce_dpcpp<sycl::half, sycl::minimum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = allreduce_dpcpp<int8_t, sycl::minimum<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = allreduce_dpcpp<uint8_t, sycl::minimum<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
       else
-        LOG(FATAL) << "PrimitiveType "
-                   << primitive_util::LowercasePrimitiveTypeName(dtype)
-                   << " is not supported in AllToAll.";
-      streamlist_wait_stream(stream, p);
-
-      Manager::instance().cv.notify_all();
-    }
-  }
-}
-
-void sycl_alltoall_split(std::vector<const void*> send_buffers,
-                         std::vector<void*> recv_buffers, int element_count,
-                         PrimitiveType dtype,
-                         se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm) {
-  std::vector<AlltoAllParticipant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().alltoall_collectives.find(comm->id) ==
-        Manager::instance().alltoall_collectives.end()) {
-      std::vector<AlltoAllParticipant> participants;
-      participants.push_back(
-          {gpu_stream, send_buffers, recv_buffers, comm->rank});
-      Manager::instance().alltoall_collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().alltoall_collectives[comm->id].push_back(
-          {gpu_stream, send_buffers, recv_buffers, comm->rank});
-      p = Manager::instance().alltoall_collectives[comm->id];
-    }
-
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().alltoall_collectives.erase(comm->id);
-      std::sort(
-          p.begin(), p.end(),
-          [](const AlltoAllParticipant& a,
-             const AlltoAllParticipant& b) -> bool { return a.rank < b.rank; });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      stream_wait_streamlist(stream, p);
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in AllReduce.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::MAX) {
       if (dtype == PRED)
-        alltoall_split_dpcpp<bool>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<bool, sycl::maximum<bool>>(stream,
+                                                            element_count, p,
+                                                            comm->local_nranks);
       else if (dtype == F32)
-        alltoall_split_dpcpp<float>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<float, sycl::maximum<float>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == F64)
-        alltoall_split_dpcpp<double>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<double, sycl::maximum<double>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S32)
-        alltoall_split_dpcpp<int32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int32_t, sycl::maximum<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S64)
-        alltoall_split_dpcpp<int64_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<int64_t, sycl::maximum<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U32)
-        alltoall_split_dpcpp<uint32_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint32_t, sycl::maximum<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U64)
-        alltoall_split_dpcpp<uint64_t>(stream, element_count, p, comm->nranks);
+        status = allreduce_dpcpp<uint64_t, sycl::maximum<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = allreduce_dpcpp<bfloat16, sycl::maximum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = allreduce_dpcpp<sycl::half, sycl::maximum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = allreduce_dpcpp<int8_t, sycl::maximum<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = allreduce_dpcpp<uint8_t, sycl::maximum<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
       else
-        LOG(FATAL) << "PrimitiveType "
-                   << primitive_util::LowercasePrimitiveTypeName(dtype)
-                   << " is not supported in AllToAll.";
-      streamlist_wait_stream(stream, p);
-
-      Manager::instance().cv.notify_all();
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in AllReduce.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else {
+      status = Unimplemented("ReductionKind %d is not supported in AllReduce.",
+                             static_cast<int>(reduction_kind));
     }
-  }
+    // The streams are joined even if a step failed, so that they stay ordered
+    // for whatever the caller does with the error.
+    if (status.ok() && comm->transport != nullptr)
+      status = InterNodeAllReduce(stream, element_count, dtype, reduction_kind,
+                                  p, *comm->transport);
+
+    if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().collectives, comm).Arrive(
+      comm->local_rank, {gpu_stream, send_buffer, recv_buffer, comm->rank},
+      run);
 }
 
-void sycl_reduce_scatter(const void* send_buffer, void* recv_buffer,
-                         int element_count, PrimitiveType dtype,
-                         ReductionKind reduction_kind,
-                         se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                         int current_call, int max_call) {
-  std::vector<Participant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().collectives.find(comm->id) ==
-        Manager::instance().collectives.end()) {
-      std::vector<Participant> participants;
-      participants.push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      Manager::instance().collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().collectives[comm->id].push_back(
-          {gpu_stream, send_buffer, recv_buffer, comm->rank});
-      p = Manager::instance().collectives[comm->id];
-    }
+void SetAllGatherAlgorithm(AllGatherAlgorithm algorithm) {
+  AllGatherAlgorithmSetting().store(algorithm, std::memory_order_relaxed);
+}
 
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().collectives.erase(comm->id);
-      std::sort(p.begin(), p.end(),
-                [](const Participant& a, const Participant& b) -> bool {
-                  return a.rank < b.rank;
-                });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      if (current_call == 0) stream_wait_streamlist(stream, p);
-
-      if (reduction_kind == ReductionKind::SUM) {
-        if (dtype == PRED)
-          reducescatter_dpcpp<bool, sycl::plus<bool>>(stream, element_count, p,
-                                                      comm->nranks);
-        else if (dtype == F32)
-          reducescatter_dpcpp<float, sycl::plus<float>>(stream, element_count,
-                                                        p, comm->nranks);
-        else if (dtype == F64)
-          reducescatter_dpcpp<double, sycl::plus<double>>(stream, element_count,
-                                                          p, comm->nranks);
-        else if (dtype == S32)
-          reducescatter_dpcpp<int32_t, sycl::plus<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          reducescatter_dpcpp<int64_t, sycl::plus<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          reducescatter_dpcpp<uint32_t, sycl::plus<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          reducescatter_dpcpp<uint64_t, sycl::plus<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C64)
-          reducescatter_dpcpp<std::complex<float>,
-                              sycl::plus<std::complex<float>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C128)
-          reducescatter_dpcpp<std::complex<double>,
-                              sycl::plus<std::complex<double>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          reducescatter_dpcpp<bfloat16, sycl::plus<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in ReduceScatter.";
-      } else if (reduction_kind == ReductionKind::PRODUCT) {
-        if (dtype == PRED)
-          reducescatter_dpcpp<bool, sycl::multiplies<bool>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == F32)
-          reducescatter_dpcpp<float, sycl::multiplies<float>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == F64)
-          reducescatter_dpcpp<double, sycl::multiplies<double>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S32)
-          reducescatter_dpcpp<int32_t, sycl::multiplies<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          reducescatter_dpcpp<int64_t, sycl::multiplies<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          reducescatter_dpcpp<uint32_t, sycl::multiplies<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          reducescatter_dpcpp<uint64_t, sycl::multiplies<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C64)
-          reducescatter_dpcpp<std::complex<float>,
-                              sycl::multiplies<std::complex<float>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == C128)
-          reducescatter_dpcpp<std::complex<double>,
-                              sycl::multiplies<std::complex<double>>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          reducescatter_dpcpp<bfloat16, sycl::multiplies<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in ReduceScatter.";
-      } else if (reduction_kind == ReductionKind::MIN) {
-        if (dtype == PRED)
-          reducescatter_dpcpp<bool, sycl::minimum<bool>>(stream, element_count,
-                                                         p, comm->nranks);
-        else if (dtype == F32)
-          reducescatter_dpcpp<float, sycl::minimum<float>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == F64)
-          reducescatter_dpcpp<double, sycl::minimum<double>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S32)
-          reducescatter_dpcpp<int32_t, sycl::minimum<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          reducescatter_dpcpp<int64_t, sycl::minimum<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          reducescatter_dpcpp<bfloat16, sycl::minimum<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          reducescatter_dpcpp<uint32_t, sycl::minimum<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          reducescatter_dpcpp<uint64_t, sycl::minimum<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in ReduceScatter.";
-      } else if (reduction_kind == ReductionKind::MAX) {
-        if (dtype == PRED)
-          reducescatter_dpcpp<bool, sycl::maximum<bool>>(stream, element_count,
-                                                         p, comm->nranks);
-        else if (dtype == F32)
-          reducescatter_dpcpp<float, sycl::maximum<float>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == F64)
-          reducescatter_dpcpp<double, sycl::maximum<double>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S32)
-          reducescatter_dpcpp<int32_t, sycl::maximum<int32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == S64)
-          reducescatter_dpcpp<int64_t, sycl::maximum<int64_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == BF16)
-          reducescatter_dpcpp<bfloat16, sycl::maximum<float>, float>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U32)
-          reducescatter_dpcpp<uint32_t, sycl::maximum<uint32_t>>(
-              stream, element_count, p, comm->nranks);
-        else if (dtype == U64)
-          reducescatter_dpcpp<uint64_t, sycl::maximum<uint64_t>>(
-              stream, element_count, p, comm->nranks);
-        else
-          LOG(FATAL) << "PrimitiveType "
-                     << primitive_util::LowercasePrimitiveTypeName(dtype)
-                     << " is not supported in ReduceScatter.";
-      } else {
-        LOG(FATAL) << "ReductionKind " << static_cast<int>(reduction_kind)
-                   << " is not supported in ReduceScatter.";
-      }
+Status sycl_allgather(const void* send_buffer, void* recv_buffer,
+                      int element_count, PrimitiveType dtype,
+                      se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                      int current_call, int max_call) {
+  auto run = [&](absl::Span<const Participant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    if (current_call == 0) stream_wait_streamlist(stream, p);
+    Status status;
+    if (comm->transport != nullptr)
+      status = InterNodeAllGather(stream, element_count, dtype, comm, p);
+    else if (dtype == PRED)
+      status = allgather_dpcpp<bool>(stream, element_count, p,
+                                     comm->local_nranks);
+    else if (dtype == F32)
+      status = allgather_dpcpp<float>(stream, element_count, p,
+                                      comm->local_nranks);
+    else if (dtype == F64)
+      status = allgather_dpcpp<double>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == S32)
+      status = allgather_dpcpp<int32_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == S64)
+      status = allgather_dpcpp<int64_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == BF16)
+      status = allgather_dpcpp<bfloat16>(stream, element_count, p,
+                                         comm->local_nranks);
+    else if (dtype == U32)
+      status = allgather_dpcpp<uint32_t>(stream, element_count, p,
+                                         comm->local_nranks);
+    else if (dtype == U64)
+      status = allgather_dpcpp<uint64_t>(stream, element_count, p,
+                                         comm->local_nranks);
+    else if (dtype == F16)
+      status = allgather_dpcpp<sycl::half>(stream, element_count, p,
+                                           comm->local_nranks);
+    else if (dtype == S8)
+      status = allgather_dpcpp<int8_t>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == U8)
+      status = allgather_dpcpp<uint8_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == S16)
+      status = allgather_dpcpp<int16_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == U16)
+      status = allgather_dpcpp<uint16_t>(stream, element_count, p,
+                                         comm->local_nranks);
+    else if (dtype == C64)
+      status = allgather_dpcpp<std::complex<float>>(stream, element_count, p,
+                                                    comm->local_nranks);
+    else if (dtype == C128)
+      status = allgather_dpcpp<std::complex<double>>(stream, element_count, p,
+                                                     comm->local_nranks);
+    else
+      status = Unimplemented("PrimitiveType %s is not supported in AllGather.",
+                             primitive_util::LowercasePrimitiveTypeName(dtype));
+    if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().collectives, comm).Arrive(
+      comm->local_rank, {gpu_stream, send_buffer, recv_buffer, comm->rank},
+      run);
+}
 
-      if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
-      Manager::instance().cv.notify_all();
-    }
-  }
+Status sycl_alltoall(std::vector<const void*> send_buffers,
+                     std::vector<void*> recv_buffers, int element_count,
+                     PrimitiveType dtype, se::gpu::GpuStreamHandle gpu_stream,
+                     ncclComm_t comm) {
+  if (comm->transport != nullptr)
+    return Unimplemented("AllToAll across processes is not supported.");
+  auto run = [&](absl::Span<const AlltoAllParticipant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    stream_wait_streamlist(stream, p);
+    Status status;
+    if (dtype == PRED)
+      status = alltoall_dpcpp<bool>(stream, element_count, p,
+                                    comm->local_nranks);
+    else if (dtype == F32)
+      status = alltoall_dpcpp<float>(stream, element_count, p,
+                                     comm->local_nranks);
+    else if (dtype == F64)
+      status = alltoall_dpcpp<double>(stream, element_count, p,
+                                      comm->local_nranks);
+    else if (dtype == S32)
+      status = alltoall_dpcpp<int32_t>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == S64)
+      status = alltoall_dpcpp<int64_t>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == BF16)
+      status = alltoall_dpcpp<bfloat16>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == U32)
+      status = alltoall_dpcpp<uint32_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == U64)
+      status = alltoall_dpcpp<uint64_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == F16)
+      status = alltoall_dpcpp<sycl::half>(stream, element_count, p,
+                                          comm->local_nranks);
+    else if (dtype == S8)
+      status = alltoall_dpcpp<int8_t>(stream, element_count, p,
+                                      comm->local_nranks);
+    else if (dtype == U8)
+      status = alltoall_dpcpp<uint8_t>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == S16)
+      status = alltoall_dpcpp<int16_t>(stream, element_count, p,
+                                       comm->local_nranks);
+    else if (dtype == U16)
+      status = alltoall_dpcpp<uint16_t>(stream, element_count, p,
+                                        comm->local_nranks);
+    else if (dtype == C64)
+      status = alltoall_dpcpp<std::complex<float>>(stream, element_count, p,
+                                                   comm->local_nranks);
+    else if (dtype == C128)
+      status = alltoall_dpcpp<std::complex<double>>(stream, element_count, p,
+                                                    comm->local_nranks);
+    else
+      status = Unimplemented("PrimitiveType %s is not supported in AllToAll.",
+                             primitive_util::LowercasePrimitiveTypeName(dtype));
+    streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().alltoall_collectives, comm).Arrive(
+      comm->local_rank,
+      {gpu_stream, std::move(send_buffers), std::move(recv_buffers),
+       comm->rank},
+      run);
 }
 
-void sycl_collective_permute(const void* send_buffer, void* recv_buffer,
-                             int element_count, PrimitiveType dtype,
-                             const std::optional<int64_t>& source_id,
-                             const std::optional<int64_t>& target_id,
-                             se::gpu::GpuStreamHandle gpu_stream,
-                             ncclComm_t comm) {
-  std::vector<PermuteParticipant> p;
-  {
-    tsl::mutex_lock l(Manager::instance().mu);
-    if (Manager::instance().permute_collectives.find(comm->id) ==
-        Manager::instance().permute_collectives.end()) {
-      std::vector<PermuteParticipant> participants;
-      participants.push_back({gpu_stream, send_buffer, recv_buffer, source_id,
-                              target_id, comm->rank});
-      Manager::instance().permute_collectives[comm->id] = participants;
-      p = participants;
-    } else {
-      Manager::instance().permute_collectives[comm->id].push_back(
-          {gpu_stream, send_buffer, recv_buffer, source_id, target_id,
-           comm->rank});
-      p = Manager::instance().permute_collectives[comm->id];
-    }
+Status sycl_alltoall_split(std::vector<const void*> send_buffers,
+                           std::vector<void*> recv_buffers, int element_count,
+                           PrimitiveType dtype,
+                           se::gpu::GpuStreamHandle gpu_stream,
+                           ncclComm_t comm) {
+  if (comm->transport != nullptr)
+    return Unimplemented("AllToAll across processes is not supported.");
+  auto run = [&](absl::Span<const AlltoAllParticipant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    stream_wait_streamlist(stream, p);
+    Status status;
+    if (dtype == PRED)
+      status = alltoall_split_dpcpp<bool>(stream, element_count, p,
+                                          comm->local_nranks);
+    else if (dtype == F32)
+      status = alltoall_split_dpcpp<float>(stream, element_count, p,
+                                           comm->local_nranks);
+    else if (dtype == F64)
+      status = alltoall_split_dpcpp<double>(stream, element_count, p,
+                                            comm->local_nranks);
+    else if (dtype == S32)
+      status = alltoall_split_dpcpp<int32_t>(stream, element_count, p,
+                                             comm->local_nranks);
+    else if (dtype == S64)
+      status = alltoall_split_dpcpp<int64_t>(stream, element_count, p,
+                                             comm->local_nranks);
+    else if (dtype == U32)
+      status = alltoall_split_dpcpp<uint32_t>(stream, element_count, p,
+                                              comm->local_nranks);
+    else if (dtype == U64)
+      status = alltoall_split_dpcpp<uint64_t>(stream, element_count, p,
+                                              comm->local_nranks);
+    else if (dtype == BF16)
+      status = alltoall_split_dpcpp<bfloat16>(stream, element_count, p,
+                                              comm->local_nranks);
+    else if (dtype == F16)
+      status = alltoall_split_dpcpp<sycl::half>(stream, element_count, p,
+                                                comm->local_nranks);
+    else if (dtype == S8)
+      status = alltoall_split_dpcpp<int8_t>(stream, element_count, p,
+                                            comm->local_nranks);
+    else if (dtype == U8)
+      status = alltoall_split_dpcpp<uint8_t>(stream, element_count, p,
+                                             comm->local_nranks);
+    else if (dtype == S16)
+      status = alltoall_split_dpcpp<int16_t>(stream, element_count, p,
+                                             comm->local_nranks);
+    else if (dtype == U16)
+      status = alltoall_split_dpcpp<uint16_t>(stream, element_count, p,
+                                              comm->local_nranks);
+    else if (dtype == C64)
+      status = alltoall_split_dpcpp<std::complex<float>>(stream, element_count,
+                                                         p, comm->local_nranks);
+    else if (dtype == C128)
+      status = alltoall_split_dpcpp<std::complex<double>>(stream, element_count,
+                                                          p,
+                                                          comm->local_nranks);
+    else
+      status = Unimplemented("PrimitiveType %s is not supported in AllToAll.",
+                             primitive_util::LowercasePrimitiveTypeName(dtype));
+    streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().alltoall_collectives, comm).Arrive(
+      comm->local_rank,
+      {gpu_stream, std::move(send_buffers), std::move(recv_buffers),
+       comm->rank},
+      run);
+}
 
-    if (p.size() != comm->nranks) {
-      Manager::instance().cv.wait(l);
-    } else {
-      Manager::instance().permute_collectives.erase(comm->id);
-      std::sort(
-          p.begin(), p.end(),
-          [](const PermuteParticipant& a, const PermuteParticipant& b) -> bool {
-            return a.rank < b.rank;
-          });
-
-      se::gpu::GpuStreamHandle stream = p[0].stream;
-      stream_wait_streamlist(stream, p);
+Status sycl_reduce_scatter(const void* send_buffer, void* recv_buffer,
+                           int element_count, PrimitiveType dtype,
+                           ReductionKind reduction_kind,
+                           se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                           int current_call, int max_call) {
+  auto run = [&](absl::Span<const Participant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    if (current_call == 0) stream_wait_streamlist(stream, p);
+
+    Status status;
+    if (comm->transport != nullptr) {
+      status = InterNodeReduceScatter(stream, element_count, dtype,
+                                      reduction_kind, comm, p);
+    } else if (reduction_kind == ReductionKind::SUM) {
       if (dtype == PRED)
-        permute_dpcpp<bool>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<bool, sycl::plus<bool>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == F32)
-        permute_dpcpp<float>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<float, sycl::plus<float>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == F64)
-        permute_dpcpp<double>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<double, sycl::plus<double>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S32)
-        permute_dpcpp<int32_t>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<int32_t, sycl::plus<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == S64)
-        permute_dpcpp<int64_t>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<int64_t, sycl::plus<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U32)
+        status = reducescatter_dpcpp<uint32_t, sycl::plus<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U64)
+        status = reducescatter_dpcpp<uint64_t, sycl::plus<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C64)
+        status = reducescatter_dpcpp<std::complex<float>,
+                                     sycl::plus<std::complex<float>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C128)
+        status = reducescatter_dpcpp<std::complex<double>,
+                                     sycl::plus<std::complex<double>>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == BF16)
-        permute_dpcpp<bfloat16>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<bfloat16, sycl::plus<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = reducescatter_dpcpp<sycl::half, sycl::plus<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = reducescatter_dpcpp<int8_t, sycl::plus<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = reducescatter_dpcpp<uint8_t, sycl::plus<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in ReduceScatter.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::PRODUCT) {
+      if (dtype == PRED)
+        status = reducescatter_dpcpp<bool, sycl::multiplies<bool>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F32)
+        status = reducescatter_dpcpp<float, sycl::multiplies<float>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F64)
+        status = reducescatter_dpcpp<double, sycl::multiplies<double>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S32)
+        status = reducescatter_dpcpp<int32_t, sycl::multiplies<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S64)
+        status = reducescatter_dpcpp<int64_t, sycl::multiplies<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U32)
-        permute_dpcpp<uint32_t>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<uint32_t, sycl::multiplies<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
       else if (dtype == U64)
-        permute_dpcpp<uint64_t>(stream, element_count, p, comm->nranks);
+        status = reducescatter_dpcpp<uint64_t, sycl::multiplies<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C64)
+        status = reducescatter_dpcpp<std::complex<float>,
+                                     sycl::multiplies<std::complex<float>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == C128)
+        status = reducescatter_dpcpp<std::complex<double>,
+                                     sycl::multiplies<std::complex<double>>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = reducescatter_dpcpp<bfloat16, sycl::multiplies<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = reducescatter_dpcpp<sycl::half, sycl::multiplies<float>,
+                                     float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = reducescatter_dpcpp<int8_t, sycl::multiplies<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = reducescatter_dpcpp<uint8_t, sycl::multiplies<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
       else
-        LOG(FATAL) << "PrimitiveType "
-                   << primitive_util::LowercasePrimitiveTypeName(dtype)
-                   << " is not supported in Permute.";
-      streamlist_wait_stream(stream, p);
-
-      Manager::instance().cv.notify_all();
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in ReduceScatter.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::MIN) {
+      if (dtype == PRED)
+        status = reducescatter_dpcpp<bool, sycl::minimum<bool>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F32)
+        status = reducescatter_dpcpp<float, sycl::minimum<float>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F64)
+        status = reducescatter_dpcpp<double, sycl::minimum<double>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S32)
+        status = reducescatter_dpcpp<int32_t, sycl::minimum<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S64)
+        status = reducescatter_dpcpp<int64_t, sycl::minimum<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = reducescatter_dpcpp<bfloat16, sycl::minimum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = reducescatter_dpcpp<sycl::half, sycl::minimum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = reducescatter_dpcpp<int8_t, sycl::minimum<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = reducescatter_dpcpp<uint8_t, sycl::minimum<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U32)
+        status = reducescatter_dpcpp<uint32_t, sycl::minimum<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U64)
+        status = reducescatter_dpcpp<uint64_t, sycl::minimum<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in ReduceScatter.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else if (reduction_kind == ReductionKind::MAX) {
+      if (dtype == PRED)
+        status = reducescatter_dpcpp<bool, sycl::maximum<bool>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F32)
+        status = reducescatter_dpcpp<float, sycl::maximum<float>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F64)
+        status = reducescatter_dpcpp<double, sycl::maximum<double>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S32)
+        status = reducescatter_dpcpp<int32_t, sycl::maximum<int32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S64)
+        status = reducescatter_dpcpp<int64_t, sycl::maximum<int64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == BF16)
+        status = reducescatter_dpcpp<bfloat16, sycl::maximum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == F16)
+        status = reducescatter_dpcpp<sycl::half, sycl::maximum<float>, float>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == S8)
+        status = reducescatter_dpcpp<int8_t, sycl::maximum<int8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U8)
+        status = reducescatter_dpcpp<uint8_t, sycl::maximum<uint8_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U32)
+        status = reducescatter_dpcpp<uint32_t, sycl::maximum<uint32_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else if (dtype == U64)
+        status = reducescatter_dpcpp<uint64_t, sycl::maximum<uint64_t>>(
+            stream, element_count, p, comm->local_nranks);
+      else
+        status = Unimplemented(
+            "PrimitiveType %s is not supported in ReduceScatter.",
+            primitive_util::LowercasePrimitiveTypeName(dtype));
+    } else {
+      status = Unimplemented(
+          "ReductionKind %d is not supported in ReduceScatter.",
+          static_cast<int>(reduction_kind));
     }
-  }
+
+    if (current_call == (max_call - 1)) streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().collectives, comm).Arrive(
+      comm->local_rank, {gpu_stream, send_buffer, recv_buffer, comm->rank},
+      run);
+}
+
+Status sycl_collective_permute(const void* send_buffer, void* recv_buffer,
+                               int element_count, PrimitiveType dtype,
+                               const std::optional<int64_t>& source_id,
+                               const std::optional<int64_t>& target_id,
+                               se::gpu::GpuStreamHandle gpu_stream,
+                               ncclComm_t comm) {
+  if (comm->transport != nullptr)
+    return Unimplemented("Permute across processes is not supported.");
+  auto run = [&](absl::Span<const PermuteParticipant> p) -> Status {
+    se::gpu::GpuStreamHandle stream = p[0].stream;
+    stream_wait_streamlist(stream, p);
+    Status status;
+    if (dtype == PRED)
+      permute_dpcpp<bool>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == F32)
+      permute_dpcpp<float>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == F64)
+      permute_dpcpp<double>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == S32)
+      permute_dpcpp<int32_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == S64)
+      permute_dpcpp<int64_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == BF16)
+      permute_dpcpp<bfloat16>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == U32)
+      permute_dpcpp<uint32_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == U64)
+      permute_dpcpp<uint64_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == F16)
+      permute_dpcpp<sycl::half>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == S8)
+      permute_dpcpp<int8_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == U8)
+      permute_dpcpp<uint8_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == S16)
+      permute_dpcpp<int16_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == U16)
+      permute_dpcpp<uint16_t>(stream, element_count, p, comm->local_nranks);
+    else if (dtype == C64)
+      permute_dpcpp<std::complex<float>>(stream, element_count, p,
+                                         comm->local_nranks);
+    else if (dtype == C128)
+      permute_dpcpp<std::complex<double>>(stream, element_count, p,
+                                          comm->local_nranks);
+    else
+      status = Unimplemented("PrimitiveType %s is not supported in Permute.",
+                             primitive_util::LowercasePrimitiveTypeName(dtype));
+    streamlist_wait_stream(stream, p);
+    return status;
+  };
+  return GetSlot(Manager::instance().permute_collectives, comm).Arrive(
+      comm->local_rank,
+      {gpu_stream, send_buffer, recv_buffer, source_id, target_id, comm->rank},
+      run);
 }
 
 }  // namespace gpu
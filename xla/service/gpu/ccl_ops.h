@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/gpu/ccl_collective_thunk.h"
+#include "xla/status.h"
 #include "xla/stream_executor/gpu/gpu_types.h"
 
 #if !ITEX_USE_CCL
@@ -25,39 +26,54 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
-void sycl_allreduce(const void* send_buffer, void* recv_buffer,
-                    int element_count, PrimitiveType dtype,
-                    ReductionKind reduction_kind,
-                    se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                    int current_call, int max_call);
+// Each rank of the communicator calls the collective with its own buffers and
+// stream. The call returns once the work of all local ranks is enqueued; an
+// error of the inter-process step is returned to every local rank.
+Status sycl_allreduce(const void* send_buffer, void* recv_buffer,
+                      int element_count, PrimitiveType dtype,
+                      ReductionKind reduction_kind,
+                      se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                      int current_call, int max_call);
 
-void sycl_allgather(const void* send_buffer, void* recv_buffer,
-                    int element_count, PrimitiveType dtype,
-                    se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                    int current_call, int max_call);
+// Algorithms of sycl_allgather within a node. kAuto writes every shard into
+// all outputs with one kernel when the leader's device can reach every peer,
+// and falls back to kRing otherwise. kRing passes shards between neighbours
+// and stages them through pinned host memory where a device cannot reach its
+// neighbour; kRingThroughHost stages every shard. The default is kAuto, or
+// kRing with XLA_SYCL_RING_ALLGATHER=1.
+enum class AllGatherAlgorithm { kAuto, kRing, kRingThroughHost };
 
-void sycl_alltoall(std::vector<const void*> send_buffer,
-                   std::vector<void*> recv_buffer, int element_count,
-                   PrimitiveType dtype, se::gpu::GpuStreamHandle gpu_stream,
-                   ncclComm_t comm);
+// Selects the all-gather algorithm for the whole process.
+void SetAllGatherAlgorithm(AllGatherAlgorithm algorithm);
 
-void sycl_alltoall_split(std::vector<const void*> send_buffer,
-                         std::vector<void*> recv_buffer, int element_count,
-                         PrimitiveType dtype,
-                         se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm);
+Status sycl_allgather(const void* send_buffer, void* recv_buffer,
+                      int element_count, PrimitiveType dtype,
+                      se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                      int current_call, int max_call);
 
-void sycl_reduce_scatter(const void* send_buffer, void* recv_buffer,
-                         int element_count, PrimitiveType dtype,
-                         ReductionKind reduction_kind,
-                         se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
-                         int current_call, int max_call);
+Status sycl_alltoall(std::vector<const void*> send_buffer,
+                     std::vector<void*> recv_buffer, int element_count,
+                     PrimitiveType dtype, se::gpu::GpuStreamHandle gpu_stream,
+                     ncclComm_t comm);
 
-void sycl_collective_permute(const void* send_buffer, void* recv_buffer,
-                             int element_count, PrimitiveType dtype,
-                             const std::optional<int64_t>& source_id,
-                             const std::optional<int64_t>& target_id,
-                             se::gpu::GpuStreamHandle gpu_stream,
-                             ncclComm_t comm);
+Status sycl_alltoall_split(std::vector<const void*> send_buffer,
+                           std::vector<void*> recv_buffer, int element_count,
+                           PrimitiveType dtype,
+                           se::gpu::GpuStreamHandle gpu_stream,
+                           ncclComm_t comm);
+
+Status sycl_reduce_scatter(const void* send_buffer, void* recv_buffer,
+                           int element_count, PrimitiveType dtype,
+                           ReductionKind reduction_kind,
+                           se::gpu::GpuStreamHandle gpu_stream, ncclComm_t comm,
+                           int current_call, int max_call);
+
+Status sycl_collective_permute(const void* send_buffer, void* recv_buffer,
+                               int element_count, PrimitiveType dtype,
+                               const std::optional<int64_t>& source_id,
+                               const std::optional<int64_t>& target_id,
+                               se::gpu::GpuStreamHandle gpu_stream,
+                               ncclComm_t comm);
 }  // namespace gpu
 }  // namespace xla
 
@@ -0,0 +1,544 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_ops.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "xla/primitive_util.h"
+#include "xla/service/gpu/ccl_utils.h"
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+
+#if !ITEX_USE_CCL
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Ranks of the correctness tests. The benchmarks scale up to 16 ranks, and the
+// all-gather selection is also checked past that with kMaxRanks.
+constexpr int kNumRanks = 4;
+constexpr int kMaxRanks = 20;
+
+// Element counts below, at and above the 16-byte vector width of the kernels,
+// and one that is not a whole number of vectors for any type.
+constexpr int kElementCounts[] = {1, 16, 4099};
+
+template <typename T>
+struct IsComplex : std::false_type {};
+template <typename T>
+struct IsComplex<std::complex<T>> : std::true_type {};
+
+// Small integers are exact in every type and their sums over kNumRanks ranks
+// fit in 8 bits, so results can be compared exactly.
+template <typename T>
+T FromInt(int value) {
+  if constexpr (IsComplex<T>::value) {
+    using R = typename T::value_type;
+    return T(static_cast<R>(value), static_cast<R>(-value));
+  } else {
+    return static_cast<T>(static_cast<float>(value));
+  }
+}
+
+int Input(int rank, int64_t i) { return (rank * 7 + i) % 5 + 1; }
+
+// The queues of kMaxRanks ranks live as long as the test binary: the
+// collectives cache pointer tables per queue. Ranks are spread round-robin
+// over the GPUs, so with a single GPU all ranks share it.
+std::vector<sycl::queue*>* GetQueues() {
+  static auto* queues = [] {
+    auto* queues = new std::vector<sycl::queue*>();
+    std::vector<sycl::device> devices =
+        sycl::device::get_devices(sycl::info::device_type::gpu);
+    if (devices.empty()) return queues;
+    auto* context = new sycl::context(devices);
+    for (int rank = 0; rank < kMaxRanks; ++rank) {
+      queues->push_back(new sycl::queue(*context,
+                                        devices[rank % devices.size()],
+                                        sycl::property::queue::in_order()));
+    }
+    return queues;
+  }();
+  return queues;
+}
+
+// Calls `fn` for each of `num_ranks` ranks on its own thread, as the thunks
+// of the ranks would, then waits for the queues. `clique` identifies the
+// communicator.
+std::vector<Status> RunOnRanks(
+    int num_ranks, int* clique,
+    const std::function<Status(int, ncclComm_t)>& fn) {
+  const std::string id = "ccl_ops_test";
+  std::vector<std::unique_ptr<ccl::communicator>> comms;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    comms.push_back(std::make_unique<ccl::communicator>(num_ranks, rank, id));
+    comms.back()->clique = clique;
+  }
+  std::vector<Status> statuses(num_ranks);
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    threads.emplace_back(
+        [&, rank] { statuses[rank] = fn(rank, comms[rank].get()); });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int rank = 0; rank < num_ranks; ++rank) (*GetQueues())[rank]->wait();
+  return statuses;
+}
+
+template <typename NativeT, PrimitiveType kPrimitiveType>
+struct TypeCase {
+  using T = NativeT;
+  static constexpr PrimitiveType kType = kPrimitiveType;
+};
+
+template <typename Case>
+class CclOpsTest : public ::testing::Test {
+ protected:
+  using T = typename Case::T;
+  static constexpr PrimitiveType kType = Case::kType;
+
+  void SetUp() override {
+    if (GetQueues()->empty()) GTEST_SKIP() << "No GPU found";
+  }
+
+  void TearDown() override {
+    for (auto& [queue, ptr] : buffers_) sycl::free(ptr, *queue);
+    SetAllGatherAlgorithm(AllGatherAlgorithm::kAuto);
+  }
+
+  sycl::queue* queue(int rank) { return (*GetQueues())[rank]; }
+
+  T* Upload(int rank, const std::vector<T>& values) {
+    T* ptr = sycl::malloc_device<T>(std::max<size_t>(values.size(), 1),
+                                    *queue(rank));
+    buffers_.emplace_back(queue(rank), ptr);
+    queue(rank)->memcpy(ptr, values.data(), values.size() * sizeof(T)).wait();
+    return ptr;
+  }
+
+  T* Allocate(int rank, int64_t count) {
+    return Upload(rank, std::vector<T>(count, FromInt<T>(0)));
+  }
+
+  std::vector<T> Download(int rank, const T* ptr, int64_t count) {
+    std::vector<T> values(count);
+    queue(rank)->memcpy(values.data(), ptr, count * sizeof(T)).wait();
+    return values;
+  }
+
+  std::vector<T> Inputs(int rank, int64_t count) {
+    std::vector<T> values(count);
+    for (int64_t i = 0; i < count; ++i) values[i] = FromInt<T>(Input(rank, i));
+    return values;
+  }
+
+  void RunRanks(const std::function<Status(int, ncclComm_t)>& fn,
+                int num_ranks = kNumRanks) {
+    std::vector<Status> statuses = RunOnRanks(num_ranks, &clique_, fn);
+    for (int rank = 0; rank < num_ranks; ++rank)
+      ASSERT_TRUE(statuses[rank].ok()) << statuses[rank];
+  }
+
+  void CheckAllReduce(ReductionKind kind,
+                      const std::function<int(int, int)>& reduce) {
+    for (int count : kElementCounts) {
+      std::vector<const T*> send(kNumRanks);
+      std::vector<T*> recv(kNumRanks);
+      for (int rank = 0; rank < kNumRanks; ++rank) {
+        send[rank] = Upload(rank, Inputs(rank, count));
+        recv[rank] = Allocate(rank, count);
+      }
+      RunRanks([&](int rank, ncclComm_t comm) {
+        return sycl_allreduce(send[rank], recv[rank], count, kType, kind,
+                              queue(rank), comm, /*current_call=*/0,
+                              /*max_call=*/1);
+      });
+      for (int rank = 0; rank < kNumRanks; ++rank) {
+        std::vector<T> result = Download(rank, recv[rank], count);
+        for (int64_t i = 0; i < count; ++i) {
+          int expected = Input(0, i);
+          for (int r = 1; r < kNumRanks; ++r)
+            expected = reduce(expected, Input(r, i));
+          ASSERT_TRUE(result[i] == FromInt<T>(expected))
+              << "rank " << rank << " element " << i << " count " << count;
+        }
+      }
+    }
+  }
+
+  void CheckAllGather(int num_ranks = kNumRanks) {
+    for (int count : kElementCounts) {
+      std::vector<const T*> send(num_ranks);
+      std::vector<T*> recv(num_ranks);
+      for (int rank = 0; rank < num_ranks; ++rank) {
+        send[rank] = Upload(rank, Inputs(rank, count));
+        recv[rank] = Allocate(rank, count * num_ranks);
+      }
+      RunRanks(
+          [&](int rank, ncclComm_t comm) {
+            return sycl_allgather(send[rank], recv[rank], count, kType,
+                                  queue(rank), comm, /*current_call=*/0,
+                                  /*max_call=*/1);
+          },
+          num_ranks);
+      for (int rank = 0; rank < num_ranks; ++rank) {
+        std::vector<T> result = Download(rank, recv[rank], count * num_ranks);
+        for (int r = 0; r < num_ranks; ++r) {
+          for (int64_t i = 0; i < count; ++i) {
+            ASSERT_TRUE(result[r * count + i] == FromInt<T>(Input(r, i)))
+                << "rank " << rank << " shard " << r << " element " << i
+                << " count " << count;
+          }
+        }
+      }
+    }
+  }
+
+  int clique_ = 0;
+  std::vector<std::pair<sycl::queue*, void*>> buffers_;
+};
+
+using CclTypes = ::testing::Types<
+    TypeCase<sycl::half, F16>, TypeCase<int8_t, S8>, TypeCase<uint8_t, U8>,
+    TypeCase<std::complex<float>, C64>, TypeCase<std::complex<double>, C128>,
+    TypeCase<float, F32>>;
+
+class TypeName {
+ public:
+  template <typename Case>
+  static std::string GetName(int) {
+    return primitive_util::LowercasePrimitiveTypeName(Case::kType);
+  }
+};
+
+TYPED_TEST_SUITE(CclOpsTest, CclTypes, TypeName);
+
+TYPED_TEST(CclOpsTest, AllReduceSum) {
+  this->CheckAllReduce(ReductionKind::SUM, [](int a, int b) { return a + b; });
+}
+
+TYPED_TEST(CclOpsTest, AllReduceMax) {
+  if constexpr (IsComplex<typename TestFixture::T>::value) {
+    GTEST_SKIP() << "Complex numbers are not ordered";
+  } else {
+    this->CheckAllReduce(ReductionKind::MAX,
+                         [](int a, int b) { return std::max(a, b); });
+  }
+}
+
+TYPED_TEST(CclOpsTest, ReduceScatterSum) {
+  using T = typename TestFixture::T;
+  for (int count : kElementCounts) {
+    std::vector<const T*> send(kNumRanks);
+    std::vector<T*> recv(kNumRanks);
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      send[rank] = this->Upload(rank, this->Inputs(rank, count * kNumRanks));
+      recv[rank] = this->Allocate(rank, count);
+    }
+    this->RunRanks([&](int rank, ncclComm_t comm) {
+      return sycl_reduce_scatter(send[rank], recv[rank], count,
+                                 TestFixture::kType, ReductionKind::SUM,
+                                 this->queue(rank), comm, /*current_call=*/0,
+                                 /*max_call=*/1);
+    });
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      std::vector<T> result = this->Download(rank, recv[rank], count);
+      for (int64_t i = 0; i < count; ++i) {
+        int expected = 0;
+        for (int r = 0; r < kNumRanks; ++r)
+          expected += Input(r, int64_t{rank} * count + i);
+        ASSERT_TRUE(result[i] == FromInt<T>(expected))
+            << "rank " << rank << " element " << i << " count " << count;
+      }
+    }
+  }
+}
+
+TYPED_TEST(CclOpsTest, AllGather) { this->CheckAllGather(); }
+
+// The ring runs on P2P-capable devices too when it is selected explicitly.
+TYPED_TEST(CclOpsTest, AllGatherRing) {
+  SetAllGatherAlgorithm(AllGatherAlgorithm::kRing);
+  this->CheckAllGather();
+}
+
+// Staging every shard through host memory is what the ring does between
+// devices without peer access, so this covers that path on any machine.
+TYPED_TEST(CclOpsTest, AllGatherRingThroughHost) {
+  SetAllGatherAlgorithm(AllGatherAlgorithm::kRingThroughHost);
+  this->CheckAllGather();
+}
+
+// Every algorithm the selection can pick, with more ranks than the benchmarks
+// use. Ranks share devices, so the automatic choice is the direct variant
+// unless the node lacks peer access.
+TYPED_TEST(CclOpsTest, AllGatherAcrossManyRanks) {
+  for (AllGatherAlgorithm algorithm :
+       {AllGatherAlgorithm::kAuto, AllGatherAlgorithm::kRing,
+        AllGatherAlgorithm::kRingThroughHost}) {
+    SetAllGatherAlgorithm(algorithm);
+    this->CheckAllGather(kMaxRanks);
+  }
+}
+
+TYPED_TEST(CclOpsTest, AllToAll) {
+  using T = typename TestFixture::T;
+  // Rank r sends block j, filled with Input(r * kNumRanks + j, i), to rank j.
+  for (int count : kElementCounts) {
+    std::vector<std::vector<const void*>> send(kNumRanks);
+    std::vector<std::vector<void*>> recv(kNumRanks);
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      for (int peer = 0; peer < kNumRanks; ++peer) {
+        send[rank].push_back(
+            this->Upload(rank, this->Inputs(rank * kNumRanks + peer, count)));
+        recv[rank].push_back(this->Allocate(rank, count));
+      }
+    }
+    this->RunRanks([&](int rank, ncclComm_t comm) {
+      return sycl_alltoall(send[rank], recv[rank], count, TestFixture::kType,
+                           this->queue(rank), comm);
+    });
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      for (int peer = 0; peer < kNumRanks; ++peer) {
+        std::vector<T> result = this->Download(
+            rank, static_cast<const T*>(recv[rank][peer]), count);
+        for (int64_t i = 0; i < count; ++i) {
+          ASSERT_TRUE(result[i] ==
+                      FromInt<T>(Input(peer * kNumRanks + rank, i)))
+              << "rank " << rank << " from " << peer << " element " << i;
+        }
+      }
+    }
+  }
+}
+
+TYPED_TEST(CclOpsTest, CollectivePermuteRing) {
+  using T = typename TestFixture::T;
+  for (int count : kElementCounts) {
+    std::vector<const T*> send(kNumRanks);
+    std::vector<T*> recv(kNumRanks);
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      send[rank] = this->Upload(rank, this->Inputs(rank, count));
+      recv[rank] = this->Allocate(rank, count);
+    }
+    this->RunRanks([&](int rank, ncclComm_t comm) {
+      std::optional<int64_t> source = (rank + kNumRanks - 1) % kNumRanks;
+      std::optional<int64_t> target = (rank + 1) % kNumRanks;
+      return sycl_collective_permute(send[rank], recv[rank], count,
+                                     TestFixture::kType, source, target,
+                                     this->queue(rank), comm);
+    });
+    for (int rank = 0; rank < kNumRanks; ++rank) {
+      const int source = (rank + kNumRanks - 1) % kNumRanks;
+      std::vector<T> result = this->Download(rank, recv[rank], count);
+      for (int64_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(result[i] == FromInt<T>(Input(source, i)))
+            << "rank " << rank << " element " << i;
+      }
+    }
+  }
+}
+
+using CclOpsF32Test = CclOpsTest<TypeCase<float, F32>>;
+
+// Every output offset below needs its own pointer table, so the cache evicts
+// and later frees tables whose kernels have run, while results stay correct.
+TEST_F(CclOpsF32Test, AllReduceAcrossPointerTableEvictions) {
+  constexpr int kCount = 16;
+  constexpr int kOutputs = 5000;
+  std::vector<const float*> send(kNumRanks);
+  std::vector<float*> recv(kNumRanks);
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    send[rank] = Upload(rank, Inputs(rank, kCount));
+    recv[rank] = Allocate(rank, int64_t{kCount} * kOutputs);
+  }
+  for (int output = 0; output < kOutputs; ++output) {
+    RunRanks([&](int rank, ncclComm_t comm) {
+      return sycl_allreduce(send[rank], recv[rank] + output * kCount, kCount,
+                            F32, ReductionKind::SUM, queue(rank), comm,
+                            /*current_call=*/0, /*max_call=*/1);
+    });
+  }
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    std::vector<float> result =
+        Download(rank, recv[rank], int64_t{kCount} * kOutputs);
+    for (int64_t i = 0; i < result.size(); ++i) {
+      int expected = 0;
+      for (int r = 0; r < kNumRanks; ++r) expected += Input(r, i % kCount);
+      ASSERT_EQ(result[i], expected) << "rank " << rank << " element " << i;
+    }
+  }
+}
+
+// Types without a kernel fail every rank with Unimplemented instead of aborting
+// the process.
+TEST_F(CclOpsF32Test, RejectsUnsupportedTypes) {
+  constexpr int kCount = 16;
+  std::vector<const float*> send(kNumRanks);
+  std::vector<float*> recv(kNumRanks);
+  for (int rank = 0; rank < kNumRanks; ++rank) {
+    send[rank] = Upload(rank, Inputs(rank, kCount * kNumRanks));
+    recv[rank] = Allocate(rank, kCount * kNumRanks);
+  }
+  auto expect_unimplemented =
+      [&](const std::function<Status(int, ncclComm_t)>& fn) {
+        std::vector<Status> statuses = RunOnRanks(kNumRanks, &clique_, fn);
+        for (int rank = 0; rank < kNumRanks; ++rank) {
+          EXPECT_TRUE(tsl::errors::IsUnimplemented(statuses[rank]))
+              << "rank " << rank << ": " << statuses[rank];
+        }
+      };
+  expect_unimplemented([&](int rank, ncclComm_t comm) {
+    return sycl_allreduce(send[rank], recv[rank], kCount, S16,
+                          ReductionKind::SUM, queue(rank), comm,
+                          /*current_call=*/0, /*max_call=*/1);
+  });
+  expect_unimplemented([&](int rank, ncclComm_t comm) {
+    return sycl_reduce_scatter(send[rank], recv[rank], kCount, S16,
+                               ReductionKind::MAX, queue(rank), comm,
+                               /*current_call=*/0, /*max_call=*/1);
+  });
+  expect_unimplemented([&](int rank, ncclComm_t comm) {
+    return sycl_allgather(send[rank], recv[rank], kCount, F8E5M2, queue(rank),
+                          comm, /*current_call=*/0, /*max_call=*/1);
+  });
+  expect_unimplemented([&](int rank, ncclComm_t comm) {
+    std::optional<int64_t> source = (rank + kNumRanks - 1) % kNumRanks;
+    std::optional<int64_t> target = (rank + 1) % kNumRanks;
+    return sycl_collective_permute(send[rank], recv[rank], kCount, F8E5M2,
+                                   source, target, queue(rank), comm);
+  });
+}
+
+// Device buffers for one collective on each of `num_ranks` ranks,
+// zero-filled so that the reductions never see denormals or NaNs.
+class BenchmarkBuffers {
+ public:
+  BenchmarkBuffers(int num_ranks, int64_t send_bytes, int64_t recv_bytes) {
+    for (int rank = 0; rank < num_ranks; ++rank) {
+      sycl::queue& queue = *(*GetQueues())[rank];
+      send_.push_back(sycl::malloc_device(send_bytes, queue));
+      recv_.push_back(sycl::malloc_device(recv_bytes, queue));
+      queue.memset(send_.back(), 0, send_bytes);
+      queue.memset(recv_.back(), 0, recv_bytes);
+      queue.wait();
+    }
+  }
+  ~BenchmarkBuffers() {
+    for (size_t rank = 0; rank < send_.size(); ++rank) {
+      sycl::queue& queue = *(*GetQueues())[rank];
+      sycl::free(send_[rank], queue);
+      sycl::free(recv_[rank], queue);
+    }
+  }
+
+  const void* send(int rank) const { return send_[rank]; }
+  void* recv(int rank) const { return recv_[rank]; }
+
+ private:
+  std::vector<void*> send_;
+  std::vector<void*> recv_;
+};
+
+void RunOnRanksOrDie(int num_ranks, int* clique,
+                     const std::function<Status(int, ncclComm_t)>& fn) {
+  for (const Status& status : RunOnRanks(num_ranks, clique, fn)) {
+    TF_CHECK_OK(status);
+  }
+}
+
+// The benchmarks report bus bandwidth as nccl-tests defines it: the bytes per
+// second each rank moves over the links. An allreduce of B bytes moves
+// 2 (n - 1) / n * B, so the figure is comparable across rank counts and
+// bounded by the link bandwidth. range(0) is the number of ranks and
+// range(1) the bytes per rank; small messages measure the rendezvous, large
+// ones the links. Run with --benchmark_filter=all.
+void BM_AllReduce(::testing::benchmark::State& state) {
+  if (GetQueues()->empty()) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int num_ranks = state.range(0);
+  const int64_t bytes = state.range(1);
+  const int count = bytes / sizeof(float);
+  BenchmarkBuffers buffers(num_ranks, bytes, bytes);
+  int clique = 0;
+  for (auto s : state) {
+    RunOnRanksOrDie(num_ranks, &clique, [&](int rank, ncclComm_t comm) {
+      return sycl_allreduce(buffers.send(rank), buffers.recv(rank), count, F32,
+                            ReductionKind::SUM, (*GetQueues())[rank], comm,
+                            /*current_call=*/0, /*max_call=*/1);
+    });
+  }
+  state.SetBytesProcessed(state.iterations() * bytes * 2 * (num_ranks - 1) /
+                          num_ranks);
+}
+BENCHMARK(BM_AllReduce)
+    ->ArgsProduct({{2, 4, 8, 16},
+                   {4 << 10, 256 << 10, 4 << 20, 64 << 20}})
+    ->UseRealTime();
+
+// An all-gather of B bytes per rank moves (n - 1) * B into every rank, so its
+// bus bandwidth is (n - 1) / n of the gathered output per second. The second
+// argument is the AllGatherAlgorithm.
+void BM_AllGather(::testing::benchmark::State& state) {
+  if (GetQueues()->empty()) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int64_t bytes = state.range(0);
+  const auto algorithm = static_cast<AllGatherAlgorithm>(state.range(1));
+  constexpr const char* kNames[] = {"auto", "ring", "ring_through_host"};
+  state.SetLabel(kNames[state.range(1)]);
+  SetAllGatherAlgorithm(algorithm);
+  BenchmarkBuffers buffers(kNumRanks, bytes, bytes * kNumRanks);
+  int clique = 0;
+  for (auto s : state) {
+    RunOnRanksOrDie(kNumRanks, &clique, [&](int rank, ncclComm_t comm) {
+      return sycl_allgather(buffers.send(rank), buffers.recv(rank), bytes, U8,
+                            (*GetQueues())[rank], comm, /*current_call=*/0,
+                            /*max_call=*/1);
+    });
+  }
+  SetAllGatherAlgorithm(AllGatherAlgorithm::kAuto);
+  state.SetBytesProcessed(state.iterations() * bytes * (kNumRanks - 1));
+}
+BENCHMARK(BM_AllGather)
+    ->ArgsProduct({{1 << 20, 16 << 20, 64 << 20},
+                   {static_cast<int>(AllGatherAlgorithm::kAuto),
+                    static_cast<int>(AllGatherAlgorithm::kRing),
+                    static_cast<int>(AllGatherAlgorithm::kRingThroughHost)}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // !ITEX_USE_CCL
@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_CCL_RENDEZVOUS_H_
+#define XLA_SERVICE_GPU_CCL_RENDEZVOUS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "tsl/platform/logging.h"
+#include "xla/status.h"
+
+namespace xla {
+namespace gpu {
+
+// Rendezvous point for one clique. Every rank publishes its participant into
+// its own slot and bumps an atomic arrival counter; the last rank to arrive
+// runs the collective over all participants in rank order and then releases
+// the others by advancing the generation. Every rank returns the status of the
+// collective. Ranks of one clique issue their collectives in the same order,
+// so one slot serves the whole sequence of operations on it.
+template <typename ParticipantT>
+class RendezvousSlot {
+ public:
+  explicit RendezvousSlot(int nranks) : participants_(nranks) {}
+
+  int nranks() const { return participants_.size(); }
+
+  // `fn` takes the participants and returns Status.
+  template <typename Fn>
+  Status Arrive(int rank, ParticipantT participant, Fn&& fn) {
+    CHECK_GE(rank, 0);
+    CHECK_LT(rank, nranks());
+    const int64_t generation = generation_.load(std::memory_order_acquire);
+    participants_[rank] = std::move(participant);
+    const int arrived = arrived_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (arrived < nranks()) {
+      Wait(generation);
+      // The next round cannot run before this rank arrives again, so the
+      // status is still the one of this round.
+      return status_;
+    }
+    status_ = fn(absl::Span<const ParticipantT>(participants_));
+    Status status = status_;
+    arrived_.store(0, std::memory_order_relaxed);
+    {
+      absl::MutexLock lock(&mu_);
+      generation_.fetch_add(1, std::memory_order_release);
+    }
+    cv_.SignalAll();
+    return status;
+  }
+
+ private:
+  // The last rank usually arrives within microseconds, so spin briefly before
+  // parking on the condition variable.
+  static constexpr int kSpinIterations = 1024;
+
+  bool Released(int64_t generation) const {
+    return generation_.load(std::memory_order_acquire) != generation;
+  }
+
+  void Wait(int64_t generation) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+      if (Released(generation)) return;
+    }
+    absl::MutexLock lock(&mu_);
+    while (!Released(generation)) cv_.Wait(&mu_);
+  }
+
+  std::vector<ParticipantT> participants_;
+  // Written by the last rank before the generation advances.
+  Status status_;
+  std::atomic<int> arrived_{0};
+  std::atomic<int64_t> generation_{0};
+  absl::Mutex mu_;
+  absl::CondVar cv_;
+};
+
+// Slots keyed by clique. Communicator ids are not unique per clique, e.g. the
+// cliques of two replica groups with the same first device, or the sync and
+// async cliques of one group, share an id. The map lock is only held for the
+// lookup, so collectives on different cliques never serialize on each other.
+template <typename ParticipantT>
+class RendezvousMap {
+ public:
+  RendezvousSlot<ParticipantT>& Get(const void* clique, int nranks) {
+    absl::MutexLock lock(&mu_);
+    std::unique_ptr<RendezvousSlot<ParticipantT>>& slot = slots_[clique];
+    if (slot == nullptr) {
+      slot = std::make_unique<RendezvousSlot<ParticipantT>>(nranks);
+    }
+    CHECK_EQ(slot->nranks(), nranks)
+        << "Communicators of one clique disagree on the number of ranks";
+    return *slot;
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<const void*,
+                      std::unique_ptr<RendezvousSlot<ParticipantT>>>
+      slots_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_CCL_RENDEZVOUS_H_
@@ -0,0 +1,166 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_rendezvous.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "xla/util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+struct TestParticipant {
+  int round = -1;
+  int rank = -1;
+};
+
+// Every rank arrives `rounds` times on one slot. Each round must run exactly
+// once, on a consistent view of all participants of that round.
+void RunRounds(RendezvousSlot<TestParticipant>& slot, int nranks, int rounds,
+               std::atomic<int>* calls, std::atomic<int>* errors) {
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < nranks; ++rank) {
+    threads.emplace_back([&, rank] {
+      for (int round = 0; round < rounds; ++round) {
+        Status status = slot.Arrive(
+            rank, {round, rank}, [&](absl::Span<const TestParticipant> p) {
+              calls->fetch_add(1);
+              for (int r = 0; r < static_cast<int>(p.size()); ++r) {
+                if (p[r].round != round || p[r].rank != r)
+                  errors->fetch_add(1);
+              }
+              return OkStatus();
+            });
+        if (!status.ok()) errors->fetch_add(1);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+}
+
+TEST(RendezvousSlotTest, RunsEachRoundOnceWithAllParticipants) {
+  constexpr int kRanks = 4;
+  constexpr int kRounds = 2000;
+  RendezvousSlot<TestParticipant> slot(kRanks);
+  std::atomic<int> calls{0};
+  std::atomic<int> errors{0};
+  RunRounds(slot, kRanks, kRounds, &calls, &errors);
+  EXPECT_EQ(calls.load(), kRounds);
+  EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(RendezvousSlotTest, SingleRankRunsImmediately) {
+  RendezvousSlot<TestParticipant> slot(1);
+  std::atomic<int> calls{0};
+  std::atomic<int> errors{0};
+  RunRounds(slot, /*nranks=*/1, /*rounds=*/10, &calls, &errors);
+  EXPECT_EQ(calls.load(), 10);
+  EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(RendezvousSlotTest, IndependentSlotsProgressConcurrently) {
+  RendezvousMap<TestParticipant> map;
+  int clique_a = 0, clique_b = 0;
+  RendezvousSlot<TestParticipant>& slot_a = map.Get(&clique_a, 2);
+  RendezvousSlot<TestParticipant>& slot_b = map.Get(&clique_b, 4);
+  std::atomic<int> calls_a{0}, calls_b{0}, errors{0};
+  std::thread a([&] { RunRounds(slot_a, 2, 500, &calls_a, &errors); });
+  std::thread b([&] { RunRounds(slot_b, 4, 500, &calls_b, &errors); });
+  a.join();
+  b.join();
+  EXPECT_EQ(calls_a.load(), 500);
+  EXPECT_EQ(calls_b.load(), 500);
+  EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(RendezvousSlotTest, EveryRankSeesTheStatusOfItsRound) {
+  constexpr int kRanks = 4;
+  constexpr int kRounds = 500;
+  RendezvousSlot<TestParticipant> slot(kRanks);
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int rank = 0; rank < kRanks; ++rank) {
+    threads.emplace_back([&, rank] {
+      for (int round = 0; round < kRounds; ++round) {
+        // Odd rounds fail, so a rank reading the status of a neighbouring
+        // round would see the wrong result.
+        Status status = slot.Arrive(
+            rank, {round, rank}, [round](absl::Span<const TestParticipant>) {
+              return round % 2 == 1 ? InternalError("round %d", round)
+                                    : OkStatus();
+            });
+        if (status.ok() != (round % 2 == 0)) mismatches.fetch_add(1);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST(RendezvousMapTest, SlotsAreKeyedByClique) {
+  RendezvousMap<TestParticipant> map;
+  int clique_a = 0, clique_b = 0;
+  RendezvousSlot<TestParticipant>& a = map.Get(&clique_a, 2);
+  RendezvousSlot<TestParticipant>& b = map.Get(&clique_b, 4);
+  EXPECT_NE(&a, &b);
+  EXPECT_EQ(&a, &map.Get(&clique_a, 2));
+  EXPECT_EQ(a.nranks(), 2);
+  EXPECT_EQ(b.nranks(), 4);
+}
+
+TEST(RendezvousMapDeathTest, RejectsMismatchedRankCount) {
+  RendezvousMap<TestParticipant> map;
+  int clique = 0;
+  map.Get(&clique, 2);
+  EXPECT_DEATH(map.Get(&clique, 4), "disagree on the number of ranks");
+}
+
+TEST(RendezvousSlotDeathTest, RejectsOutOfRangeRank) {
+  RendezvousSlot<TestParticipant> slot(2);
+  EXPECT_DEATH(slot.Arrive(2, {},
+                           [](absl::Span<const TestParticipant>) {
+                             return OkStatus();
+                           })
+                   .IgnoreError(),
+               "");
+}
+
+// Rendezvous per second of range(0) host threads that arrive on one slot
+// with an empty collective, so the figure is the synchronization cost alone.
+void BM_Rendezvous(::testing::benchmark::State& state) {
+  constexpr int kRounds = 1000;
+  const int nranks = state.range(0);
+  RendezvousSlot<TestParticipant> slot(nranks);
+  std::atomic<int> calls{0};
+  std::atomic<int> errors{0};
+  for (auto s : state) {
+    RunRounds(slot, nranks, kRounds, &calls, &errors);
+  }
+  CHECK_EQ(errors.load(), 0);
+  state.SetItemsProcessed(state.iterations() * kRounds);
+}
+BENCHMARK(BM_Rendezvous)->DenseRange(2, 16, 2)->UseRealTime();
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,331 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_transport.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tsl/platform/logging.h"
+#include "xla/status_macros.h"
+#include "xla/util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Peers publish their addresses once they are listening, which may take a
+// while if their process is still compiling.
+constexpr absl::Duration kAddressTimeout = absl::Minutes(5);
+constexpr absl::Duration kConnectTimeout = absl::Minutes(1);
+
+Status ErrnoError(const char* what) {
+  return InternalError("%s failed: %s", what, std::strerror(errno));
+}
+
+// Reads or writes exactly `bytes` on a blocking socket.
+Status SendAll(int fd, const void* data, size_t bytes) {
+  const char* ptr = static_cast<const char*>(data);
+  while (bytes > 0) {
+    ssize_t n = ::send(fd, ptr, bytes, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("send");
+    }
+    ptr += n;
+    bytes -= n;
+  }
+  return OkStatus();
+}
+
+Status RecvAll(int fd, void* data, size_t bytes) {
+  char* ptr = static_cast<char*>(data);
+  while (bytes > 0) {
+    ssize_t n = ::recv(fd, ptr, bytes, 0);
+    if (n == 0) return InternalError("Peer closed the connection");
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("recv");
+    }
+    ptr += n;
+    bytes -= n;
+  }
+  return OkStatus();
+}
+
+std::string LocalHostName() {
+  if (const char* host = std::getenv("XLA_CCL_TRANSPORT_HOST")) return host;
+  char host[256] = {};
+  if (gethostname(host, sizeof(host) - 1) != 0) return "localhost";
+  return host;
+}
+
+// Closes the socket unless ownership is released.
+class ScopedSocket {
+ public:
+  explicit ScopedSocket(int fd = -1) : fd_(fd) {}
+  ScopedSocket(ScopedSocket&& other) : fd_(other.release()) {}
+  ScopedSocket& operator=(ScopedSocket&& other) {
+    reset(other.release());
+    return *this;
+  }
+  ~ScopedSocket() { reset(); }
+
+  int get() const { return fd_; }
+  int release() { return std::exchange(fd_, -1); }
+  void reset(int fd = -1) {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = fd;
+  }
+
+ private:
+  int fd_;
+};
+
+StatusOr<ScopedSocket> Listen(int backlog, int* port) {
+  ScopedSocket fd(::socket(AF_INET, SOCK_STREAM, 0));
+  if (fd.get() < 0) return ErrnoError("socket");
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = 0;
+  if (::bind(fd.get(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    return ErrnoError("bind");
+  if (::listen(fd.get(), backlog) != 0) return ErrnoError("listen");
+  socklen_t len = sizeof(addr);
+  if (::getsockname(fd.get(), reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    return ErrnoError("getsockname");
+  *port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// Connects to "host:port", retrying while the peer is not accepting yet.
+StatusOr<ScopedSocket> Connect(const std::string& address) {
+  std::vector<std::string> parts = absl::StrSplit(address, ':');
+  TF_RET_CHECK(parts.size() == 2) << "Bad transport address " << address;
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  if (int err = ::getaddrinfo(parts[0].c_str(), parts[1].c_str(), &hints,
+                              &result);
+      err != 0) {
+    return InternalError("getaddrinfo(%s) failed: %s", address,
+                         gai_strerror(err));
+  }
+  std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> cleanup(
+      result, &::freeaddrinfo);
+
+  const absl::Time deadline = absl::Now() + kConnectTimeout;
+  while (true) {
+    ScopedSocket fd(::socket(result->ai_family, result->ai_socktype,
+                             result->ai_protocol));
+    if (fd.get() < 0) return ErrnoError("socket");
+    if (::connect(fd.get(), result->ai_addr, result->ai_addrlen) == 0) {
+      return fd;
+    }
+    if (absl::Now() > deadline) return ErrnoError("connect");
+    absl::SleepFor(absl::Milliseconds(100));
+  }
+}
+
+class TcpTransport : public CclTransport {
+ public:
+  TcpTransport(int node, std::vector<ScopedSocket> sockets)
+      : CclTransport(node, sockets.size()), sockets_(std::move(sockets)) {}
+
+  Status SendRecv(int send_to, const void* send, size_t send_bytes,
+                  int recv_from, void* recv, size_t recv_bytes) override;
+
+ private:
+  // Indexed by peer node; the entry for this node is unused.
+  std::vector<ScopedSocket> sockets_;
+};
+
+Status TcpTransport::SendRecv(int send_to, const void* send, size_t send_bytes,
+                              int recv_from, void* recv, size_t recv_bytes) {
+  TF_RET_CHECK(send_to != node() && recv_from != node());
+  const char* out = static_cast<const char*>(send);
+  char* in = static_cast<char*>(recv);
+  const int send_fd = sockets_[send_to].get();
+  const int recv_fd = sockets_[recv_from].get();
+
+  while (send_bytes > 0 || recv_bytes > 0) {
+    pollfd fds[2];
+    int nfds = 0;
+    int send_idx = -1, recv_idx = -1;
+    if (send_bytes > 0) {
+      send_idx = nfds;
+      fds[nfds++] = {send_fd, POLLOUT, 0};
+    }
+    if (recv_bytes > 0) {
+      recv_idx = nfds;
+      fds[nfds++] = {recv_fd, POLLIN, 0};
+    }
+    if (::poll(fds, nfds, /*timeout=*/-1) < 0) {
+      if (errno == EINTR) continue;
+      return ErrnoError("poll");
+    }
+    for (int i = 0; i < nfds; ++i) {
+      if (fds[i].revents & (POLLERR | POLLNVAL))
+        return InternalError("Transport socket error");
+    }
+    if (send_idx >= 0 && (fds[send_idx].revents & POLLOUT)) {
+      ssize_t n = ::send(send_fd, out, send_bytes, MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        return ErrnoError("send");
+      if (n > 0) {
+        out += n;
+        send_bytes -= n;
+      }
+    }
+    if (recv_idx >= 0 && (fds[recv_idx].revents & (POLLIN | POLLHUP))) {
+      ssize_t n = ::recv(recv_fd, in, recv_bytes, MSG_DONTWAIT);
+      if (n == 0) return InternalError("Peer closed the connection");
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        return ErrnoError("recv");
+      if (n > 0) {
+        in += n;
+        recv_bytes -= n;
+      }
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<CclTransport>> CreateTcpTransport(
+    int node, int num_nodes, const std::string& key_prefix,
+    const CclKeyValueGetCallback& kv_get,
+    const CclKeyValuePutCallback& kv_put) {
+  TF_RET_CHECK(node >= 0 && node < num_nodes);
+  auto address_key = [&](int n) { return absl::StrCat(key_prefix, "/", n); };
+
+  int port = 0;
+  TF_ASSIGN_OR_RETURN(ScopedSocket listener, Listen(num_nodes, &port));
+  TF_RETURN_IF_ERROR(
+      kv_put(address_key(node), absl::StrCat(LocalHostName(), ":", port)));
+
+  std::vector<ScopedSocket> sockets(num_nodes);
+  // Connect to every lower node and introduce ourselves, then accept the
+  // higher nodes. Connecting never waits for the peer to call accept, so the
+  // two phases cannot deadlock.
+  for (int peer = 0; peer < node; ++peer) {
+    TF_ASSIGN_OR_RETURN(std::string address,
+                        kv_get(address_key(peer), kAddressTimeout));
+    TF_ASSIGN_OR_RETURN(sockets[peer], Connect(address));
+    int32_t id = node;
+    TF_RETURN_IF_ERROR(SendAll(sockets[peer].get(), &id, sizeof(id)));
+  }
+  for (int i = node + 1; i < num_nodes; ++i) {
+    ScopedSocket fd(::accept(listener.get(), nullptr, nullptr));
+    if (fd.get() < 0) return ErrnoError("accept");
+    int32_t peer = -1;
+    TF_RETURN_IF_ERROR(RecvAll(fd.get(), &peer, sizeof(peer)));
+    TF_RET_CHECK(peer > node && peer < num_nodes && sockets[peer].get() < 0)
+        << "Unexpected transport peer " << peer;
+    sockets[peer] = std::move(fd);
+  }
+
+  for (int peer = 0; peer < num_nodes; ++peer) {
+    if (peer == node) continue;
+    int one = 1;
+    ::setsockopt(sockets[peer].get(), IPPROTO_TCP, TCP_NODELAY, &one,
+                 sizeof(one));
+  }
+  VLOG(1) << "CCL TCP transport ready: node " << node << " of " << num_nodes;
+  return std::unique_ptr<CclTransport>(
+      std::make_unique<TcpTransport>(node, std::move(sockets)));
+}
+
+Status RingAllReduce(CclTransport& transport, void* buffer, int64_t count,
+                     size_t element_size, CclReduceFn reduce) {
+  const int n = transport.num_nodes();
+  const int me = transport.node();
+  if (n == 1) return OkStatus();
+  const int right = (me + 1) % n;
+  const int left = (me + n - 1) % n;
+
+  char* data = static_cast<char*>(buffer);
+  auto begin = [&](int chunk) { return count * chunk / n; };
+  auto size = [&](int chunk) { return begin(chunk + 1) - begin(chunk); };
+  auto ptr = [&](int chunk) { return data + begin(chunk) * element_size; };
+  std::vector<char> incoming((count / n + 1) * element_size);
+
+  // Reduce-scatter: after n - 1 steps this node holds the reduced chunk
+  // me + 1.
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_chunk = (me - step + n) % n;
+    const int recv_chunk = (me - step - 1 + n) % n;
+    TF_RETURN_IF_ERROR(transport.SendRecv(
+        right, ptr(send_chunk), size(send_chunk) * element_size, left,
+        incoming.data(), size(recv_chunk) * element_size));
+    reduce(ptr(recv_chunk), incoming.data(), size(recv_chunk));
+  }
+  // All-gather the reduced chunks.
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_chunk = (me + 1 - step + n) % n;
+    const int recv_chunk = (me - step + n) % n;
+    TF_RETURN_IF_ERROR(transport.SendRecv(
+        right, ptr(send_chunk), size(send_chunk) * element_size, left,
+        ptr(recv_chunk), size(recv_chunk) * element_size));
+  }
+  return OkStatus();
+}
+
+Status RingAllGather(CclTransport& transport, void* buffer,
+                     absl::Span<const size_t> block_bytes) {
+  const int n = transport.num_nodes();
+  const int me = transport.node();
+  TF_RET_CHECK(static_cast<int>(block_bytes.size()) == n);
+  if (n == 1) return OkStatus();
+  const int right = (me + 1) % n;
+  const int left = (me + n - 1) % n;
+
+  std::vector<size_t> offsets(n + 1, 0);
+  for (int i = 0; i < n; ++i) offsets[i + 1] = offsets[i] + block_bytes[i];
+  char* data = static_cast<char*>(buffer);
+
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_block = (me - step + n) % n;
+    const int recv_block = (me - step - 1 + n) % n;
+    TF_RETURN_IF_ERROR(transport.SendRecv(
+        right, data + offsets[send_block], block_bytes[send_block], left,
+        data + offsets[recv_block], block_bytes[recv_block]));
+  }
+  return OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_CCL_TRANSPORT_H_
+#define XLA_SERVICE_GPU_CCL_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "xla/service/gpu/ccl_utils.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Moves host memory between the processes of a communicator that spans
+// several nodes. Nodes are numbered 0..num_nodes()-1 within the communicator.
+// Collectives use it for the inter-node step after reducing or gathering the
+// ranks of each process on the device.
+class CclTransport {
+ public:
+  virtual ~CclTransport() = default;
+
+  int node() const { return node_; }
+  int num_nodes() const { return num_nodes_; }
+
+  // Sends `send_bytes` to `send_to` while receiving `recv_bytes` from
+  // `recv_from`. Both directions progress together, so a ring step in which
+  // every node sends before it receives cannot deadlock.
+  virtual Status SendRecv(int send_to, const void* send, size_t send_bytes,
+                          int recv_from, void* recv, size_t recv_bytes) = 0;
+
+ protected:
+  CclTransport(int node, int num_nodes) : node_(node), num_nodes_(num_nodes) {}
+
+ private:
+  int node_;
+  int num_nodes_;
+};
+
+// Connects the processes over TCP. Every process listens on an ephemeral port,
+// publishes its address under `key_prefix` and connects to the processes
+// numbered below it. The host name can be overridden with
+// XLA_CCL_TRANSPORT_HOST. Running all processes on one host exercises the
+// transport over loopback, without GPUs.
+StatusOr<std::unique_ptr<CclTransport>> CreateTcpTransport(
+    int node, int num_nodes, const std::string& key_prefix,
+    const CclKeyValueGetCallback& kv_get, const CclKeyValuePutCallback& kv_put);
+
+// Reduces `count` elements of `element_size` bytes into `acc`.
+using CclReduceFn =
+    absl::FunctionRef<void(void* acc, const void* in, int64_t count)>;
+
+// Ring all-reduce of `buffer` across all nodes of `transport`.
+Status RingAllReduce(CclTransport& transport, void* buffer, int64_t count,
+                     size_t element_size, CclReduceFn reduce);
+
+// Ring all-gather of per-node blocks laid out back to back in node order in
+// `buffer`. On entry only this node's block has to be filled in.
+Status RingAllGather(CclTransport& transport, void* buffer,
+                     absl::Span<const size_t> block_bytes);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_CCL_TRANSPORT_H_
@@ -0,0 +1,207 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/ccl_transport.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tsl/platform/test.h"
+#include "xla/status_macros.h"
+#include "xla/util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// In-process stand-in for the distributed key-value store.
+class KeyValueStore {
+ public:
+  CclKeyValueGetCallback Getter() {
+    return [this](const std::string& key,
+                  absl::Duration timeout) -> StatusOr<std::string> {
+      absl::MutexLock lock(&mu_);
+      auto has_key = [&]() ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+        return values_.contains(key);
+      };
+      if (!mu_.AwaitWithTimeout(absl::Condition(&has_key), timeout))
+        return InternalError("Timed out waiting for %s", key);
+      return values_[key];
+    };
+  }
+
+  CclKeyValuePutCallback Putter() {
+    return [this](const std::string& key, const std::string& value) {
+      absl::MutexLock lock(&mu_);
+      values_[key] = value;
+      return OkStatus();
+    };
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::string> values_ ABSL_GUARDED_BY(mu_);
+};
+
+// Runs `fn` on one thread per node, each with its own TCP transport over
+// loopback, and returns the statuses by node.
+std::vector<Status> RunOnNodes(
+    int num_nodes, const std::function<Status(CclTransport&)>& fn) {
+  setenv("XLA_CCL_TRANSPORT_HOST", "127.0.0.1", /*overwrite=*/1);
+  KeyValueStore store;
+  std::vector<Status> statuses(num_nodes);
+  std::vector<std::thread> threads;
+  for (int node = 0; node < num_nodes; ++node) {
+    threads.emplace_back([&, node] {
+      StatusOr<std::unique_ptr<CclTransport>> transport = CreateTcpTransport(
+          node, num_nodes, "test", store.Getter(), store.Putter());
+      if (!transport.ok()) {
+        statuses[node] = transport.status();
+        return;
+      }
+      EXPECT_EQ((*transport)->node(), node);
+      EXPECT_EQ((*transport)->num_nodes(), num_nodes);
+      statuses[node] = fn(**transport);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  return statuses;
+}
+
+void AddInt64(void* acc, const void* in, int64_t count) {
+  for (int64_t i = 0; i < count; ++i)
+    static_cast<int64_t*>(acc)[i] += static_cast<const int64_t*>(in)[i];
+}
+
+int64_t Input(int node, int64_t i) { return (node + 1) * 1000 + i % 7; }
+
+class CclTransportTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(CclTransportTest, RingAllReduce) {
+  const int num_nodes = GetParam();
+  // Counts below, equal to and not divisible by the number of nodes exercise
+  // empty and uneven ring chunks.
+  for (int64_t count : {int64_t{1}, int64_t{num_nodes}, int64_t{1000003}}) {
+    std::vector<std::vector<int64_t>> buffers(num_nodes);
+    std::vector<Status> statuses =
+        RunOnNodes(num_nodes, [&](CclTransport& transport) {
+          std::vector<int64_t>& buffer = buffers[transport.node()];
+          buffer.resize(count);
+          for (int64_t i = 0; i < count; ++i)
+            buffer[i] = Input(transport.node(), i);
+          return RingAllReduce(transport, buffer.data(), count,
+                               sizeof(int64_t), AddInt64);
+        });
+    for (int node = 0; node < num_nodes; ++node) {
+      ASSERT_TRUE(statuses[node].ok()) << statuses[node];
+      for (int64_t i = 0; i < count; ++i) {
+        int64_t expected = 0;
+        for (int n = 0; n < num_nodes; ++n) expected += Input(n, i);
+        ASSERT_EQ(buffers[node][i], expected)
+            << "node " << node << " element " << i << " count " << count;
+      }
+    }
+  }
+}
+
+TEST_P(CclTransportTest, RingAllGather) {
+  const int num_nodes = GetParam();
+  // Blocks of different sizes, including an empty one, as when processes
+  // hold different numbers of ranks.
+  std::vector<size_t> block_bytes(num_nodes);
+  std::vector<size_t> offsets(num_nodes + 1, 0);
+  for (int n = 0; n < num_nodes; ++n) {
+    block_bytes[n] = n == 1 ? 0 : (n + 1) * 100003;
+    offsets[n + 1] = offsets[n] + block_bytes[n];
+  }
+  auto byte = [](int node, size_t i) {
+    return static_cast<char>(node * 31 + i);
+  };
+
+  std::vector<std::vector<char>> buffers(num_nodes);
+  std::vector<Status> statuses =
+      RunOnNodes(num_nodes, [&](CclTransport& transport) {
+        const int me = transport.node();
+        std::vector<char>& buffer = buffers[me];
+        buffer.assign(offsets[num_nodes], 0);
+        for (size_t i = 0; i < block_bytes[me]; ++i)
+          buffer[offsets[me] + i] = byte(me, i);
+        return RingAllGather(transport, buffer.data(), block_bytes);
+      });
+  for (int node = 0; node < num_nodes; ++node) {
+    ASSERT_TRUE(statuses[node].ok()) << statuses[node];
+    for (int n = 0; n < num_nodes; ++n) {
+      for (size_t i = 0; i < block_bytes[n]; ++i) {
+        ASSERT_EQ(buffers[node][offsets[n] + i], byte(n, i))
+            << "node " << node << " block " << n << " byte " << i;
+      }
+    }
+  }
+}
+
+TEST_P(CclTransportTest, ReusesConnectionsAcrossCollectives) {
+  const int num_nodes = GetParam();
+  constexpr int kIterations = 50;
+  std::vector<Status> statuses =
+      RunOnNodes(num_nodes, [&](CclTransport& transport) -> Status {
+        for (int it = 0; it < kIterations; ++it) {
+          int64_t value = transport.node() + it;
+          TF_RETURN_IF_ERROR(RingAllReduce(transport, &value, 1,
+                                           sizeof(int64_t), AddInt64));
+          const int64_t expected =
+              num_nodes * (num_nodes - 1) / 2 + num_nodes * it;
+          TF_RET_CHECK(value == expected) << "iteration " << it;
+        }
+        return OkStatus();
+      });
+  for (const Status& status : statuses) EXPECT_TRUE(status.ok()) << status;
+}
+
+INSTANTIATE_TEST_SUITE_P(Nodes, CclTransportTest, ::testing::Values(1, 2, 3, 4),
+                         [](const ::testing::TestParamInfo<int>& info) {
+                           return absl::StrCat(info.param, "Nodes");
+                         });
+
+TEST(CclTransportErrorTest, MissingPeerAddressIsAnError) {
+  KeyValueStore store;
+  CclKeyValueGetCallback get = store.Getter();
+  CclKeyValueGetCallback get_with_short_timeout =
+      [&](const std::string& key, absl::Duration) {
+        return get(key, absl::Milliseconds(10));
+      };
+  // Node 1 connects to node 0, which never publishes its address.
+  StatusOr<std::unique_ptr<CclTransport>> transport = CreateTcpTransport(
+      1, 2, "missing", get_with_short_timeout, store.Putter());
+  EXPECT_FALSE(transport.ok());
+}
+
+TEST(CclTransportErrorTest, RejectsOutOfRangeNode) {
+  KeyValueStore store;
+  EXPECT_FALSE(
+      CreateTcpTransport(2, 2, "bad", store.Getter(), store.Putter()).ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
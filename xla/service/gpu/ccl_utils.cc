@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "xla/service/gpu/ccl_utils.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -26,12 +28,15 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/random.h"
 #include "xla/debug_options_flags.h"
 #include "xla/service/global_device_id.h"
+#include "xla/service/gpu/ccl_transport.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/service/rendezvous.h"
 #include "xla/status_macros.h"
@@ -68,6 +73,54 @@ ccl::reduction ToNcclReduction(ReductionKind kind) {
 }
 #endif  // ITEX_USE_CCL
 
+namespace {
+ABSL_CONST_INIT absl::Mutex distributed_config_mu(absl::kConstInit);
+CclDistributedConfig* distributed_config
+    ABSL_GUARDED_BY(distributed_config_mu) = nullptr;
+
+// Multi-process cliques wait this long for the owner of the first device to
+// publish their id, which happens once that process reaches the collective.
+constexpr absl::Duration kUniqueIdTimeout = absl::Minutes(10);
+}  // namespace
+
+void SetCclDistributedConfig(CclDistributedConfig config) {
+  absl::MutexLock lock(&distributed_config_mu);
+  // Collectives may still read a previous config, so it is leaked on purpose.
+  distributed_config = new CclDistributedConfig(std::move(config));
+}
+
+const CclDistributedConfig* GetCclDistributedConfig() {
+  absl::MutexLock lock(&distributed_config_mu);
+  return distributed_config;
+}
+
+bool IsMultiProcessClique(const std::vector<GlobalDeviceId>& devices) {
+  const CclDistributedConfig* config = GetCclDistributedConfig();
+  if (config == nullptr || config->num_nodes <= 1) return false;
+  for (GlobalDeviceId device : devices) {
+    auto it = config->device_to_node.find(device);
+    if (it == config->device_to_node.end() || it->second != config->node_id)
+      return true;
+  }
+  return false;
+}
+
+StatusOr<std::string> ExchangeCliqueUniqueId(const NcclCliqueKey& clique_key) {
+  const CclDistributedConfig* config = GetCclDistributedConfig();
+  TF_RET_CHECK(config != nullptr && !clique_key.devices().empty());
+  const std::string key =
+      absl::StrCat("xpu_ccl_unique_id/", clique_key.ToString());
+  auto owner = config->device_to_node.find(clique_key.devices().front());
+  TF_RET_CHECK(owner != config->device_to_node.end())
+      << "No process owns device " << clique_key.devices().front().value();
+  if (owner->second == config->node_id) {
+    std::string id = absl::StrCat(key, "/", absl::Hex(tsl::random::New64()));
+    TF_RETURN_IF_ERROR(config->kv_put(key, id));
+    return id;
+  }
+  return config->kv_get(key, kUniqueIdTimeout);
+}
+
 namespace {
 StatusOr<std::string> ToNcclUniqueId(const std::string& id_str) {
   return id_str;
@@ -82,7 +135,8 @@ StatusOr<std::string> LocalNcclUniqueIdCallback(const NcclCliqueKey&) {
 
 struct NcclCliqueState {
   std::string unique_id;
-  int64_t run_id = -1;
+  // Read without the clique lock by communicator cache hits.
+  std::atomic<int64_t> run_id{-1};
 
   // `mu` guards `communicators` and `status` during initialization.
   // Once `ready` has been notified, the communicators may be accessed without
@@ -91,6 +145,9 @@ struct NcclCliqueState {
   absl::Notification ready;
   Status status;
   absl::flat_hash_map<int, std::unique_ptr<NcclComm>> communicators;
+  // Connects the processes of a multi-process clique. Created by the first
+  // local rank to initialize and shared by all of them.
+  std::unique_ptr<CclTransport> transport;
 };
 
 using NcclClique = Lockable<NcclCliqueState>;
@@ -129,23 +186,74 @@ std::shared_ptr<StatusOr<NcclClique::Lock>> AcquireNcclClique(
         const NcclCliqueKey& clique_key = std::get<2>(rendezvous_key);
         NcclClique::Lock clique = cliques[clique_key].Acquire();
         if (clique->run_id < 0) {
-          TF_ASSIGN_OR_RETURN(std::string id,
-                              unique_id_callback(run_id.ToString()));
+          TF_ASSIGN_OR_RETURN(
+              std::string id,
+              unique_id_callback(clique_key, run_id.ToString()));
           TF_ASSIGN_OR_RETURN(clique->unique_id, ToNcclUniqueId(id));
         }
-        // If multiple executable are running simultaneously while using
-        // multiple hosts, it is possible that different executables could
-        // acquire the same clique on different hosts. We protect against this
-        // by checking that the run ID increases monotonically.
         bool is_local = clique_key.devices().size() == num_local_participants;
-        TF_RET_CHECK(is_local || (run_id.ToInt() >= clique->run_id));
-        clique->run_id = run_id.ToInt();
+        TF_RETURN_IF_ERROR(
+            AdvanceCliqueRunId(clique->run_id, run_id.ToInt(), !is_local));
         return clique;
       },
       /*warn_stuck_timeout=*/absl::Seconds(10),
       (terminate_timeout >= 0) ? absl::Seconds(terminate_timeout)
                                : absl::InfiniteDuration());
 }
+
+#if !ITEX_USE_CCL
+// Records which process hosts each rank of a communicator that spans
+// processes, and connects the processes once per clique. Processes are
+// numbered by increasing node id among those taking part in the clique.
+Status InitMultiProcessComm(const std::vector<GlobalDeviceId>& devices,
+                            NcclCliqueState& state, ccl::communicator* comm) {
+  const CclDistributedConfig* config = GetCclDistributedConfig();
+  TF_RET_CHECK(config != nullptr);
+  std::vector<int> device_nodes;
+  device_nodes.reserve(devices.size());
+  for (GlobalDeviceId device : devices) {
+    auto it = config->device_to_node.find(device);
+    TF_RET_CHECK(it != config->device_to_node.end())
+        << "No process owns device " << device.value();
+    device_nodes.push_back(it->second);
+  }
+  std::vector<int> nodes = device_nodes;
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  auto node_index = [&](int node_id) {
+    return std::lower_bound(nodes.begin(), nodes.end(), node_id) -
+           nodes.begin();
+  };
+
+  const int node = node_index(config->node_id);
+  comm->rank_to_node.resize(devices.size());
+  comm->local_nranks = 0;
+  for (int r = 0; r < devices.size(); ++r) {
+    comm->rank_to_node[r] = node_index(device_nodes[r]);
+    if (comm->rank_to_node[r] != node) continue;
+    if (r == comm->rank) comm->local_rank = comm->local_nranks;
+    ++comm->local_nranks;
+  }
+
+  absl::MutexLock lock(&state.mu);
+  if (state.transport == nullptr) {
+    const std::string key_prefix =
+        absl::StrCat("xpu_ccl_transport/", state.unique_id);
+    const int num_nodes = nodes.size();
+    StatusOr<std::unique_ptr<CclTransport>> transport =
+        config->transport_factory
+            ? config->transport_factory(node, num_nodes, key_prefix,
+                                        config->kv_get, config->kv_put)
+            : CreateTcpTransport(node, num_nodes, key_prefix, config->kv_get,
+                                 config->kv_put);
+    TF_RETURN_IF_ERROR(transport.status());
+    state.transport = std::move(*transport);
+  }
+  comm->transport = state.transport.get();
+  return OkStatus();
+}
+#endif  // !ITEX_USE_CCL
+
 #if 0
 void CheckNcclAsyncError(NcclComm& lockable_comm) {
   ncclComm_t comm = *lockable_comm.Acquire();
@@ -200,28 +308,18 @@ StatusOr<const NcclUniqueIdCallback*> GetNcclUniqueIdCallback(
   return local_callback;
 }
 
-StatusOr<NcclComm::Lock> AcquireNcclComm(
-    RunId run_id, OpId op_id, std::vector<GlobalDeviceId> participants,
-    size_t num_local_participants,
-    const CustomNcclUniqueIdCallback& unique_id_callback, int rank,
-    int64_t stream_id, bool enable_clique_optimization) {
-  // Ensure that this group of threads have exclusive access to the clique to
-  // prevent threads from different groups locking communicators in the clique.
-  NcclCliqueKey clique_key(std::move(participants), stream_id);
-  std::shared_ptr<StatusOr<NcclClique::Lock>> clique = AcquireNcclClique(
-      run_id, op_id, clique_key, unique_id_callback, num_local_participants,
-      enable_clique_optimization ||
-          stream_id == GetStreamId(true, kAsyncStreamP2P));
-
-  if (!clique->ok()) return clique->status();
-
+namespace {
+// Creates this rank's communicator of `state` unless the clique is already
+// initialized. Returns once all local ranks of the clique have theirs.
+StatusOr<NcclComm*> InitNcclComm(const NcclCliqueKey& clique_key,
+                                 NcclCliqueState& state, int rank,
+                                 size_t num_local_participants) {
   struct AllCommunicators {
     absl::Mutex mu;
     std::vector<NcclComm*> communicators ABSL_GUARDED_BY(mu);
   };
   static auto& all_communicators = *new AllCommunicators;
 
-  NcclCliqueState& state = ***clique;
   if (!state.ready.HasBeenNotified()) {
     int nranks = clique_key.devices().size();
     const std::string& id = state.unique_id;
@@ -231,6 +329,11 @@ StatusOr<NcclComm::Lock> AcquireNcclComm(
     // Status status = XLA_CUDA_STATUS(ncclCommInitRank(&comm, nranks, id,
     // rank));
     Status status = tsl::OkStatus();
+#if !ITEX_USE_CCL
+    comm->clique = &state;
+    if (IsMultiProcessClique(clique_key.devices()))
+      status = InitMultiProcessComm(clique_key.devices(), state, comm);
+#endif  // !ITEX_USE_CCL
     size_t num_initialized = [&] {
       absl::MutexLock lock(&state.mu);
       state.status.Update(status);
@@ -255,7 +358,48 @@ StatusOr<NcclComm::Lock> AcquireNcclComm(
   }
 
   TF_RETURN_IF_ERROR(state.status);
-  return state.communicators[rank]->Acquire();
+  return state.communicators[rank].get();
+}
+}  // namespace
+
+StatusOr<NcclComm::Lock> AcquireNcclComm(
+    RunId run_id, OpId op_id, std::vector<GlobalDeviceId> participants,
+    size_t num_local_participants,
+    const CustomNcclUniqueIdCallback& unique_id_callback, int rank,
+    int64_t stream_id, bool enable_clique_optimization,
+    NcclCommCache* comm_cache, int device_ordinal) {
+  NcclCliqueKey clique_key(std::move(participants), stream_id);
+  // Held until the communicator is acquired.
+  std::shared_ptr<StatusOr<NcclClique::Lock>> clique;
+  auto create = [&]() -> StatusOr<NcclCommCache::CachedComm> {
+    // Ensure that this group of threads have exclusive access to the clique to
+    // prevent threads from different groups locking communicators in the
+    // clique.
+    clique = AcquireNcclClique(
+        run_id, op_id, clique_key, unique_id_callback, num_local_participants,
+        enable_clique_optimization ||
+            stream_id == GetStreamId(true, kAsyncStreamP2P));
+    if (!clique->ok()) return clique->status();
+    NcclCliqueState& state = ***clique;
+    TF_ASSIGN_OR_RETURN(NcclComm * comm,
+                        InitNcclComm(clique_key, state, rank,
+                                     num_local_participants));
+    bool spans_hosts = clique_key.devices().size() != num_local_participants;
+    return NcclCommCache::CachedComm{comm, &state.run_id, spans_hosts};
+  };
+
+  // Communicators live as long as the process, so once this op has seen its
+  // communicator on this device, no other thread needs to be met.
+  NcclComm* comm;
+  if (comm_cache != nullptr) {
+    TF_ASSIGN_OR_RETURN(
+        comm, comm_cache->GetOrCreate(device_ordinal, clique_key,
+                                      run_id.ToInt(), create));
+  } else {
+    TF_ASSIGN_OR_RETURN(NcclCommCache::CachedComm cached, create());
+    comm = cached.comm;
+  }
+  return comm->Acquire();
 }
 }  // namespace gpu
 }  // namespace xla
@@ -18,28 +18,54 @@ limitations under the License.
 #ifndef XLA_SERVICE_GPU_CCL_UTILS_H_
 #define XLA_SERVICE_GPU_CCL_UTILS_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "xla/service/collective_ops_utils.h"
+#include "xla/service/gpu/ccl_comm_cache.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/service/gpu/thunk.h"
 #include "xla/status.h"
 #include "xla/statusor.h"
 #include "xla/xla_data.pb.h"
 
+namespace xla {
+namespace gpu {
+class CclTransport;
+}  // namespace gpu
+}  // namespace xla
+
 #if ITEX_USE_CCL
 #include "oneapi/ccl.hpp"
 #else
 namespace ccl {
 struct communicator {
   communicator(int nranks, int rank, const std::string& id)
-      : nranks(nranks), rank(rank), id(id) {}
+      : nranks(nranks),
+        rank(rank),
+        id(id),
+        local_nranks(nranks),
+        local_rank(rank) {}
   int nranks;
   int rank;
   const std::string& id;
+  // Identifies the clique. Ids are not unique per clique, so the ranks of one
+  // collective meet on this instead.
+  const void* clique = nullptr;
+  // Ranks hosted by this process and this rank's index among them. They only
+  // differ from `nranks` and `rank` when the communicator spans processes.
+  int local_nranks;
+  int local_rank;
+  // Multi-process communicators only: the process of every rank, numbered
+  // like the transport's nodes, and the transport connecting the processes.
+  std::vector<int> rank_to_node;
+  xla::gpu::CclTransport* transport = nullptr;
 };
 }  // namespace ccl
 #endif  // ITEX_USE_CCL
@@ -56,6 +82,46 @@ StatusOr<std::pair<ccl::datatype, int>> ToNcclDataTypeAndCountMultiplier(
 bool IsGlobalNcclConfig();
 bool IsNcclLaunchModeParallel();
 
+// Key-value store callbacks, with the signatures of PjRtClient's.
+using CclKeyValueGetCallback = std::function<StatusOr<std::string>(
+    const std::string& key, absl::Duration timeout)>;
+using CclKeyValuePutCallback =
+    std::function<Status(const std::string& key, const std::string& value)>;
+
+// Creates the transport for the `node`-th of `num_nodes` processes of one
+// communicator. Processes find each other through keys under `key_prefix`.
+using CclTransportFactory =
+    std::function<StatusOr<std::unique_ptr<CclTransport>>(
+        int node, int num_nodes, const std::string& key_prefix,
+        const CclKeyValueGetCallback& kv_get,
+        const CclKeyValuePutCallback& kv_put)>;
+
+// Describes a run that spans several processes. It is set by the PJRT client
+// before any collective runs. Collectives whose devices all live in
+// this process never consult it.
+struct CclDistributedConfig {
+  int node_id = 0;
+  int num_nodes = 1;
+  absl::flat_hash_map<GlobalDeviceId, int> device_to_node;
+  CclKeyValueGetCallback kv_get;
+  CclKeyValuePutCallback kv_put;
+  // Defaults to CreateTcpTransport when empty.
+  CclTransportFactory transport_factory;
+};
+
+void SetCclDistributedConfig(CclDistributedConfig config);
+
+// Returns null unless SetCclDistributedConfig has been called.
+const CclDistributedConfig* GetCclDistributedConfig();
+
+// Whether `devices` live in more than one process.
+bool IsMultiProcessClique(const std::vector<GlobalDeviceId>& devices);
+
+// Agrees on a unique id for a multi-process clique: the process owning the
+// clique's first device publishes a fresh id in the key-value store and the
+// other processes read it.
+StatusOr<std::string> ExchangeCliqueUniqueId(const NcclCliqueKey& clique_key);
+
 size_t GetNumLocalParticipants(
     const std::vector<GlobalDeviceId>& participants,
     const std::vector<GlobalDeviceId>* local_devices);  // may be null
@@ -79,7 +145,12 @@ class CustomNcclUniqueIdCallback {
     replica_id_ = participants[0].value();
   }
 
-  StatusOr<std::string> operator()(const std::string& run_id) const {
+  StatusOr<std::string> operator()(const NcclCliqueKey& clique_key,
+                                   const std::string& run_id) const {
+    // Run ids are not shared between processes, so multi-process cliques
+    // agree on their id through the key-value store instead.
+    if (IsMultiProcessClique(clique_key.devices()))
+      return ExchangeCliqueUniqueId(clique_key);
     if (replica_id_ == kMissingId_)
       return run_id;
     else
@@ -129,11 +200,18 @@ struct NcclComm : public Lockable<ccl::communicator*> {
   explicit NcclComm(ccl::communicator* comm) : Lockable(comm) {}
 };
 
+// Communicators one collective op has already initialized, so that its later
+// executions skip the clique rendezvous.
+using NcclCommCache = CommCache<NcclCliqueKey, NcclComm>;
+
+// `comm_cache` may be null. Otherwise it is consulted before the clique
+// rendezvous and filled in once the communicator is ready.
 StatusOr<NcclComm::Lock> AcquireNcclComm(
     RunId run_id, OpId op_id, std::vector<GlobalDeviceId> participants,
     size_t num_local_participants,
     const CustomNcclUniqueIdCallback& unique_id_callback, int rank,
-    int64_t stream_id, bool enable_clique_optimization);
+    int64_t stream_id, bool enable_clique_optimization,
+    NcclCommCache* comm_cache = nullptr, int device_ordinal = 0);
 
 }  // namespace gpu
 }  // namespace xla
@@ -55,6 +55,7 @@ limitations under the License.
 #include "xla/service/buffer_value.h"
 #include "xla/service/dump.h"
 #include "xla/service/gpu/buffer_sharing.h"
+#include "xla/service/gpu/ccl_collective_thunk.h"
 #include "xla/service/gpu/conditional_thunk.h"
 #include "xla/service/gpu/for_thunk.h"
 #include "xla/service/gpu/gpu_constants.h"
@@ -451,6 +452,9 @@ Status CompileModuleToLlvmIrImpl(
   auto thunk_sequence = ir_emitter->ConsumeThunkSequence();
   ForAllThunks([](Thunk* thunk) { thunk->ClearCompileTimeInfo(); },
                thunk_sequence.get());
+  // The first collective a device executes sets up the communicators of all
+  // others, so only it waits on the clique rendezvous.
+  EnableNcclCollectiveWarmUp(*thunk_sequence);
   results->executable = std::move(thunk_sequence);
   return OkStatus();
 }
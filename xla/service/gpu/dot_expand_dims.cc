@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/shape_util.h"
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 
@@ -36,8 +38,47 @@ namespace gpu {
 
 namespace {
 
-StatusOr<bool> ExpandDotDims(HloInstruction* original_dot) {
-  if (original_dot->opcode() != HloOpcode::kDot) {
+// Returns true if `operand` has only batch and contracting dimensions, with
+// the single contracting dimension either first or right after the batch
+// dimensions.
+bool IsExpandableVector(const Shape& shape,
+                        absl::Span<const int64_t> batch_dims,
+                        absl::Span<const int64_t> contracting_dims) {
+  if (contracting_dims.size() != 1 ||
+      shape.rank() != batch_dims.size() + contracting_dims.size()) {
+    return false;
+  }
+  int64_t c_dim = contracting_dims[0];
+  return c_dim == 0 || c_dim == batch_dims.size();
+}
+
+// Decides from the shapes whether `dot` is a matrix-vector product that
+// should be expanded into a GEMM the GEMV/oneDNN runtime can take.
+bool ShouldExpandDot(const HloInstruction* dot, int64_t min_matrix_elements) {
+  const auto& dnums = dot->dot_dimension_numbers();
+  const Shape& lhs_shape = dot->operand(0)->shape();
+  const Shape& rhs_shape = dot->operand(1)->shape();
+  if (!lhs_shape.IsArray() || !rhs_shape.IsArray()) return false;
+  bool lhs_vector = IsExpandableVector(lhs_shape, dnums.lhs_batch_dimensions(),
+                                       dnums.lhs_contracting_dimensions());
+  bool rhs_vector = IsExpandableVector(rhs_shape, dnums.rhs_batch_dimensions(),
+                                       dnums.rhs_contracting_dimensions());
+  // A vector-vector dot is a plain reduction; a matrix-matrix dot already maps
+  // to a GEMM.
+  if (lhs_vector == rhs_vector) return false;
+  // The expanded dot keeps the matrix operand as it is, so it must already be
+  // a (batched) matrix with one non-contracting dimension.
+  const Shape& matrix_shape = lhs_vector ? rhs_shape : lhs_shape;
+  if (matrix_shape.rank() != dnums.lhs_batch_dimensions_size() + 2) {
+    return false;
+  }
+  return ShapeUtil::ElementsIn(matrix_shape) >= min_matrix_elements;
+}
+
+StatusOr<bool> ExpandDotDims(HloInstruction* original_dot,
+                             int64_t min_matrix_elements) {
+  if (original_dot->opcode() != HloOpcode::kDot ||
+      !ShouldExpandDot(original_dot, min_matrix_elements)) {
     return false;
   }
   auto computation = original_dot->parent();
@@ -72,7 +113,7 @@ StatusOr<bool> ExpandDotDims(HloInstruction* original_dot) {
   DotDimensionNumbers dot_dnums;
   HloInstruction* lhs_operand = original_dot->mutable_operand(0);
   HloInstruction* reshaped_lhs = lhs_operand;
-  if (lhs_non_contracting_size == 1) {
+  if (num_lhs_non_contracting_dims == 0) {
     CHECK_EQ(original_dnums.lhs_contracting_dimensions().size(), 1);
     auto batch_dimensions = original_dnums.lhs_batch_dimensions();
     int c_dim = original_dnums.lhs_contracting_dimensions()[0];
@@ -129,7 +170,7 @@ StatusOr<bool> ExpandDotDims(HloInstruction* original_dot) {
 
   HloInstruction* rhs_operand = original_dot->mutable_operand(1);
   HloInstruction* reshaped_rhs = rhs_operand;
-  if (rhs_non_contracting_size == 1) {
+  if (num_rhs_non_contracting_dims == 0) {
     CHECK_EQ(original_dnums.rhs_contracting_dimensions().size(), 1);
     auto batch_dimensions = original_dnums.rhs_batch_dimensions();
     int c_dim = original_dnums.rhs_contracting_dimensions()[0];
@@ -188,7 +229,8 @@ StatusOr<bool> ExpandDotDims(HloInstruction* original_dot) {
 
 }  // namespace
 
-DotExpandDims::DotExpandDims() = default;
+DotExpandDims::DotExpandDims(int64_t min_matrix_elements)
+    : min_matrix_elements_(min_matrix_elements) {}
 
 StatusOr<bool> DotExpandDims::Run(
     HloModule* module,
@@ -198,7 +240,7 @@ StatusOr<bool> DotExpandDims::Run(
        module->MakeNonfusionComputations(execution_threads)) {
     for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
       bool changed = false;
-      TF_ASSIGN_OR_RETURN(changed, ExpandDotDims(instr));
+      TF_ASSIGN_OR_RETURN(changed, ExpandDotDims(instr, min_matrix_elements_));
       any_changed |= changed;
     }
   }
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef XLA_SERVICE_GPU_DOT_EXPAND_DIMS_H_
 #define XLA_SERVICE_GPU_DOT_EXPAND_DIMS_H_
 
+#include <cstdint>
+
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/service/hlo_pass_interface.h"
@@ -23,16 +25,28 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
-// Expand dot dims for dimension 1 so that it can call onednn.
+// Matrices with fewer elements than this, 128 x 128, stay fused reductions.
+// Streaming them takes less time than the fixed host-side cost of a library
+// call, so expanding them cannot pay off.
+inline constexpr int64_t kDefaultMinGemvMatrixElements = 128 * 128;
+
+// Expands matrix-vector dots, where one operand has no non-contracting
+// dimension, into rank-2 GEMMs with a unit dimension so that they run on the
+// GEMV kernel or oneDNN instead of the loop emitter. Dots whose matrix has
+// fewer than `min_matrix_elements` elements are kept as they are.
 class DotExpandDims : public HloModulePass {
  public:
-  explicit DotExpandDims();
+  explicit DotExpandDims(
+      int64_t min_matrix_elements = kDefaultMinGemvMatrixElements);
   absl::string_view name() const override { return "dot-expand-dims"; }
 
   using HloPassInterface::Run;
   StatusOr<bool> Run(
       HloModule* module,
       const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  int64_t min_matrix_elements_;
 };
 
 }  // namespace gpu
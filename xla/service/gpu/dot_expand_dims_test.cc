@@ -0,0 +1,198 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/dot_expand_dims.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/hlo_parser.h"
+#include "xla/service/hlo_verifier.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/service/pattern_matcher_gmock.h"
+#include "xla/shape_util.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace m = ::xla::match;
+
+class DotExpandDimsTest : public ::testing::Test {
+ protected:
+  // Runs the pass on `hlo` and returns whether it changed the module. The
+  // result is verified, so every expanded dot has consistent shapes.
+  bool RunPass(absl::string_view hlo,
+               int64_t min_matrix_elements = kDefaultMinGemvMatrixElements) {
+    auto module = ParseAndReturnUnverifiedModule(hlo);
+    TF_CHECK_OK(module.status());
+    module_ = std::move(module).value();
+    auto changed = DotExpandDims(min_matrix_elements).Run(module_.get(), {});
+    TF_CHECK_OK(changed.status());
+    TF_CHECK_OK(HloVerifier(/*layout_sensitive=*/false,
+                            /*allow_mixed_precision=*/false)
+                    .Run(module_.get())
+                    .status());
+    return *changed;
+  }
+
+  const HloInstruction* root() const {
+    return module_->entry_computation()->root_instruction();
+  }
+
+  std::unique_ptr<HloModule> module_;
+};
+
+TEST_F(DotExpandDimsTest, ExpandsMatrixVector) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[256,128] parameter(0)
+  x = f32[128] parameter(1)
+  ROOT d = f32[256] dot(a, x), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})"));
+  const HloInstruction* dot;
+  ASSERT_THAT(root(),
+              GmockMatch(m::Reshape(m::Dot(&dot, m::Parameter(0),
+                                           m::Reshape(m::Parameter(1))))));
+  EXPECT_TRUE(ShapeUtil::Equal(dot->shape(),
+                               ShapeUtil::MakeShape(F32, {256, 1})));
+  EXPECT_TRUE(ShapeUtil::Equal(dot->operand(1)->shape(),
+                               ShapeUtil::MakeShape(F32, {128, 1})));
+}
+
+TEST_F(DotExpandDimsTest, ExpandsVectorMatrix) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  x = f32[128] parameter(0)
+  a = f32[128,256] parameter(1)
+  ROOT d = f32[256] dot(x, a), lhs_contracting_dims={0},
+    rhs_contracting_dims={0}
+})"));
+  const HloInstruction* dot;
+  ASSERT_THAT(root(),
+              GmockMatch(m::Reshape(m::Dot(&dot, m::Reshape(m::Parameter(0)),
+                                           m::Parameter(1)))));
+  EXPECT_TRUE(ShapeUtil::Equal(dot->shape(),
+                               ShapeUtil::MakeShape(F32, {1, 256})));
+}
+
+TEST_F(DotExpandDimsTest, ExpandsBatchedMatrixVector) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = bf16[4,64,128] parameter(0)
+  x = bf16[4,128] parameter(1)
+  ROOT d = bf16[4,64] dot(a, x), lhs_batch_dims={0}, rhs_batch_dims={0},
+    lhs_contracting_dims={2}, rhs_contracting_dims={1}
+})"));
+  const HloInstruction* dot;
+  ASSERT_THAT(root(),
+              GmockMatch(m::Reshape(m::Dot(&dot, m::Parameter(0),
+                                           m::Reshape(m::Parameter(1))))));
+  EXPECT_TRUE(ShapeUtil::Equal(dot->shape(),
+                               ShapeUtil::MakeShape(BF16, {4, 64, 1})));
+}
+
+TEST_F(DotExpandDimsTest, KeepsSmallMatrixVector) {
+  // 16x16 is below the GEMV threshold; a fused reduction is faster.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[16,16] parameter(0)
+  x = f32[16] parameter(1)
+  ROOT d = f32[16] dot(a, x), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})"));
+}
+
+TEST_F(DotExpandDimsTest, ExpandsSmallMatrixVectorWithLowerThreshold) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[16,16] parameter(0)
+  x = f32[16] parameter(1)
+  ROOT d = f32[16] dot(a, x), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})",
+                      /*min_matrix_elements=*/16 * 16));
+}
+
+TEST_F(DotExpandDimsTest, KeepsMatrixMatrix) {
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[256,128] parameter(0)
+  b = f32[128,256] parameter(1)
+  ROOT d = f32[256,256] dot(a, b), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})"));
+}
+
+TEST_F(DotExpandDimsTest, KeepsMatrixWithUnitDimension) {
+  // The vector already has a non-contracting dimension of size 1.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[256,128] parameter(0)
+  x = f32[128,1] parameter(1)
+  ROOT d = f32[256,1] dot(a, x), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+})"));
+}
+
+TEST_F(DotExpandDimsTest, KeepsVectorVector) {
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  x = f32[32768] parameter(0)
+  y = f32[32768] parameter(1)
+  ROOT d = f32[] dot(x, y), lhs_contracting_dims={0},
+    rhs_contracting_dims={0}
+})"));
+}
+
+TEST_F(DotExpandDimsTest, KeepsMatrixWithSeveralNonContractingDims) {
+  // The expanded dot would need the matrix flattened first.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  a = f32[8,32,128] parameter(0)
+  x = f32[128] parameter(1)
+  ROOT d = f32[8,32] dot(a, x), lhs_contracting_dims={2},
+    rhs_contracting_dims={0}
+})"));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,158 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/gemv_kernel.h"
+
+#include <sycl/ext/oneapi/bfloat16.hpp>
+
+#include "xla/primitive_util.h"
+#include "xla/util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+constexpr int kSubGroupSize = 16;
+// Rows handled by one work-group when the reduction dim is contiguous; one
+// sub-group per row.
+constexpr int kRowsPerGroup = 16;
+// Work-group size when the row dim is contiguous; one work-item per row.
+constexpr int kColumnGroupSize = 256;
+
+template <typename T>
+struct GemvRowKernel;
+
+template <typename T>
+struct GemvColumnKernel;
+
+int64_t RoundUp(int64_t x, int64_t multiple) {
+  return (x + multiple - 1) / multiple * multiple;
+}
+
+// k_stride == 1: every row is contiguous, so a sub-group walks it with
+// coalesced loads and reduces across lanes at the end.
+template <typename T>
+void LaunchGemvRows(sycl::queue* stream, const GemvDescriptor& desc) {
+  const T* matrix = static_cast<const T*>(desc.matrix);
+  const T* vector = static_cast<const T*>(desc.vector);
+  const T* bias = static_cast<const T*>(desc.bias);
+  T* out = static_cast<T*>(desc.out);
+  GemvDescriptor d = desc;
+  sycl::range<2> global(d.batch_size,
+                        RoundUp(d.rows, kRowsPerGroup) * kSubGroupSize);
+  sycl::range<2> local(1, kRowsPerGroup * kSubGroupSize);
+  stream->submit([&](sycl::handler& cgh) {
+    cgh.parallel_for<GemvRowKernel<T>>(
+        sycl::nd_range<2>(global, local),
+        [=](sycl::nd_item<2> item)
+            [[intel::reqd_sub_group_size(kSubGroupSize)]] {
+              sycl::sub_group sg = item.get_sub_group();
+              int64_t b = item.get_global_id(0);
+              int64_t row =
+                  item.get_group(1) * kRowsPerGroup + sg.get_group_id()[0];
+              if (row >= d.rows) return;
+              const T* m = matrix + b * d.matrix_batch_stride +
+                           row * d.row_stride;
+              const T* v = vector + b * d.vector_batch_stride;
+              float acc = 0.0f;
+              for (int64_t p = sg.get_local_id()[0]; p < d.k;
+                   p += kSubGroupSize) {
+                acc += static_cast<float>(m[p]) *
+                       static_cast<float>(v[p * d.vector_stride]);
+              }
+              acc = sycl::reduce_over_group(sg, acc, sycl::plus<float>());
+              if (sg.get_local_id()[0] == 0) {
+                if (bias) acc += static_cast<float>(bias[row * d.bias_stride]);
+                out[b * d.out_batch_stride + row * d.out_stride] =
+                    static_cast<T>(acc);
+              }
+            });
+  });
+}
+
+// row_stride == 1: neighbouring rows are contiguous, so each work-item owns a
+// row and the work-group loads one contiguous segment per step of k.
+template <typename T>
+void LaunchGemvColumns(sycl::queue* stream, const GemvDescriptor& desc) {
+  const T* matrix = static_cast<const T*>(desc.matrix);
+  const T* vector = static_cast<const T*>(desc.vector);
+  const T* bias = static_cast<const T*>(desc.bias);
+  T* out = static_cast<T*>(desc.out);
+  GemvDescriptor d = desc;
+  sycl::range<2> global(d.batch_size, RoundUp(d.rows, kColumnGroupSize));
+  sycl::range<2> local(1, kColumnGroupSize);
+  stream->submit([&](sycl::handler& cgh) {
+    cgh.parallel_for<GemvColumnKernel<T>>(
+        sycl::nd_range<2>(global, local), [=](sycl::nd_item<2> item) {
+          int64_t b = item.get_global_id(0);
+          int64_t row = item.get_global_id(1);
+          if (row >= d.rows) return;
+          const T* m = matrix + b * d.matrix_batch_stride + row;
+          const T* v = vector + b * d.vector_batch_stride;
+          float acc = 0.0f;
+          for (int64_t p = 0; p < d.k; ++p) {
+            acc += static_cast<float>(m[p * d.k_stride]) *
+                   static_cast<float>(v[p * d.vector_stride]);
+          }
+          if (bias) acc += static_cast<float>(bias[row * d.bias_stride]);
+          out[b * d.out_batch_stride + row * d.out_stride] =
+              static_cast<T>(acc);
+        });
+  });
+}
+
+template <typename T>
+void LaunchGemv(sycl::queue* stream, const GemvDescriptor& desc) {
+  if (desc.k_stride == 1) {
+    LaunchGemvRows<T>(stream, desc);
+  } else {
+    LaunchGemvColumns<T>(stream, desc);
+  }
+}
+
+}  // namespace
+
+bool IsGemvSupported(PrimitiveType dtype, const GemvDescriptor& desc) {
+  if (dtype != F32 && dtype != F16 && dtype != BF16) return false;
+  return desc.batch_size > 0 && desc.rows > 0 && desc.k > 0 &&
+         (desc.k_stride == 1 || desc.row_stride == 1);
+}
+
+Status RunGemv(se::gpu::GpuStreamHandle stream, PrimitiveType dtype,
+               const GemvDescriptor& desc) {
+  if (!IsGemvSupported(dtype, desc)) {
+    return InternalError("Unsupported GEMV: %s, rows=%d, k=%d",
+                         primitive_util::LowercasePrimitiveTypeName(dtype),
+                         desc.rows, desc.k);
+  }
+  switch (dtype) {
+    case F32:
+      LaunchGemv<float>(stream, desc);
+      break;
+    case F16:
+      LaunchGemv<sycl::half>(stream, desc);
+      break;
+    case BF16:
+      LaunchGemv<sycl::ext::oneapi::bfloat16>(stream, desc);
+      break;
+    default:
+      break;
+  }
+  return OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef XLA_SERVICE_GPU_GEMV_KERNEL_H_
+#define XLA_SERVICE_GPU_GEMV_KERNEL_H_
+
+#include <cstdint>
+
+#include "xla/status.h"
+#include "xla/stream_executor/gpu/gpu_types.h"
+#include "xla/xla_data.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Strided view of out[b][r] = sum_p matrix[b][r][p] * vector[b][p] + bias[r].
+// All strides are in elements. Either `row_stride` or `k_stride` must be 1.
+struct GemvDescriptor {
+  int64_t batch_size;
+  int64_t rows;
+  int64_t k;
+
+  const void* matrix;
+  int64_t matrix_batch_stride;
+  int64_t row_stride;
+  int64_t k_stride;
+
+  const void* vector;
+  int64_t vector_batch_stride;
+  int64_t vector_stride;
+
+  void* out;
+  int64_t out_batch_stride;
+  int64_t out_stride;
+
+  // Optional, indexed by bias[r * bias_stride].
+  const void* bias = nullptr;
+  int64_t bias_stride = 0;
+};
+
+// Returns true if RunGemv can handle `desc` with elements of type `dtype`.
+bool IsGemvSupported(PrimitiveType dtype, const GemvDescriptor& desc);
+
+// Matrix-vector product for decode-time shapes (M == 1 or N == 1), which
+// are memory bound: the kernel streams the matrix once and accumulates in
+// f32.
+Status RunGemv(se::gpu::GpuStreamHandle stream, PrimitiveType dtype,
+               const GemvDescriptor& desc);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_GEMV_KERNEL_H_
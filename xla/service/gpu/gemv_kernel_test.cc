@@ -0,0 +1,254 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/gemv_kernel.h"
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include <sycl/ext/oneapi/bfloat16.hpp>
+
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Returns a queue on the first device, or nullptr without one.
+sycl::queue* GetQueue() {
+  static sycl::queue* queue = []() -> sycl::queue* {
+    int count = 0;
+    if (SYCLGetDeviceCount(&count) != SYCL_SUCCESS || count == 0) {
+      return nullptr;
+    }
+    sycl::device* device = nullptr;
+    if (SYCLGetDevice(&device, 0) != SYCL_SUCCESS) return nullptr;
+    sycl::queue* queue = nullptr;
+    if (SYCLCreateStream(device, &queue) != SYCL_SUCCESS) return nullptr;
+    return queue;
+  }();
+  return queue;
+}
+
+struct GemvShape {
+  int64_t batch_size;
+  int64_t rows;
+  int64_t k;
+};
+
+// Host copy of a GEMV problem. The matrix is stored with k contiguous
+// (k_stride == 1) or with rows contiguous (row_stride == 1); the vector,
+// bias and output are dense.
+struct GemvProblem {
+  GemvProblem(GemvShape shape, bool k_contiguous, bool with_bias)
+      : shape(shape), k_contiguous(k_contiguous) {
+    matrix.resize(shape.batch_size * shape.rows * shape.k);
+    vector.resize(shape.batch_size * shape.k);
+    if (with_bias) bias.resize(shape.rows);
+    // Small multiples of 1/4 keep the f32 sums exact.
+    auto value = [](int64_t i) { return ((i * 7) % 11 - 5) / 4.0f; };
+    for (int64_t i = 0; i < matrix.size(); ++i) matrix[i] = value(i);
+    for (int64_t i = 0; i < vector.size(); ++i) vector[i] = value(i + 3);
+    for (int64_t i = 0; i < bias.size(); ++i) bias[i] = value(i + 5);
+  }
+
+  int64_t row_stride() const { return k_contiguous ? shape.k : 1; }
+  int64_t k_stride() const { return k_contiguous ? 1 : shape.rows; }
+
+  std::vector<double> Reference() const {
+    std::vector<double> out(shape.batch_size * shape.rows);
+    for (int64_t b = 0; b < shape.batch_size; ++b) {
+      for (int64_t r = 0; r < shape.rows; ++r) {
+        double acc = bias.empty() ? 0.0 : bias[r];
+        for (int64_t p = 0; p < shape.k; ++p) {
+          acc += double{matrix[b * shape.rows * shape.k + r * row_stride() +
+                               p * k_stride()]} *
+                 vector[b * shape.k + p];
+        }
+        out[b * shape.rows + r] = acc;
+      }
+    }
+    return out;
+  }
+
+  GemvShape shape;
+  bool k_contiguous;
+  std::vector<float> matrix;
+  std::vector<float> vector;
+  std::vector<float> bias;
+};
+
+template <typename T>
+T* CopyToDevice(sycl::queue* queue, const std::vector<float>& values) {
+  if (values.empty()) return nullptr;
+  std::vector<T> host(values.begin(), values.end());
+  T* device = sycl::malloc_device<T>(host.size(), *queue);
+  queue->memcpy(device, host.data(), host.size() * sizeof(T)).wait();
+  return device;
+}
+
+// Device buffers of `problem` in element type T, and the descriptor over
+// them.
+template <typename T>
+struct DeviceGemv {
+  DeviceGemv(sycl::queue* queue, const GemvProblem& problem)
+      : queue(queue),
+        matrix(CopyToDevice<T>(queue, problem.matrix)),
+        vector(CopyToDevice<T>(queue, problem.vector)),
+        bias(CopyToDevice<T>(queue, problem.bias)),
+        out(sycl::malloc_device<T>(
+            problem.shape.batch_size * problem.shape.rows, *queue)) {
+    const GemvShape& shape = problem.shape;
+    desc.batch_size = shape.batch_size;
+    desc.rows = shape.rows;
+    desc.k = shape.k;
+    desc.matrix = matrix;
+    desc.matrix_batch_stride = shape.rows * shape.k;
+    desc.row_stride = problem.row_stride();
+    desc.k_stride = problem.k_stride();
+    desc.vector = vector;
+    desc.vector_batch_stride = shape.k;
+    desc.vector_stride = 1;
+    desc.out = out;
+    desc.out_batch_stride = shape.rows;
+    desc.out_stride = 1;
+    desc.bias = bias;
+    desc.bias_stride = 1;
+  }
+  ~DeviceGemv() {
+    for (T* buffer : {matrix, vector, bias, out}) {
+      if (buffer != nullptr) sycl::free(buffer, *queue);
+    }
+  }
+
+  std::vector<float> Out() const {
+    std::vector<T> host(desc.batch_size * desc.rows);
+    queue->memcpy(host.data(), out, host.size() * sizeof(T)).wait();
+    return std::vector<float>(host.begin(), host.end());
+  }
+
+  sycl::queue* queue;
+  T* matrix;
+  T* vector;
+  T* bias;
+  T* out;
+  GemvDescriptor desc;
+};
+
+class GemvKernelTest
+    : public ::testing::TestWithParam<std::tuple<GemvShape, bool, bool>> {
+ protected:
+  void SetUp() override {
+    queue_ = GetQueue();
+    if (queue_ == nullptr) GTEST_SKIP() << "No GPU found";
+  }
+
+  // Runs `problem` in element type T and compares against the f64 reference
+  // within `relative_error` of the sum of absolute products.
+  template <typename T>
+  void RunAndCompare(PrimitiveType dtype, const GemvProblem& problem,
+                     double relative_error) {
+    DeviceGemv<T> gemv(queue_, problem);
+    ASSERT_TRUE(IsGemvSupported(dtype, gemv.desc));
+    ASSERT_TRUE(RunGemv(queue_, dtype, gemv.desc).ok());
+    std::vector<float> out = gemv.Out();
+    std::vector<double> expected = problem.Reference();
+    // Every product is at most (5/4)^2, plus a bias of at most 5/4.
+    const double bound = relative_error * (problem.shape.k * 1.5625 + 1.25);
+    for (int64_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(out[i], expected[i], bound) << "output " << i;
+    }
+  }
+
+  sycl::queue* queue_ = nullptr;
+};
+
+TEST_P(GemvKernelTest, MatchesReferenceF32) {
+  auto [shape, k_contiguous, with_bias] = GetParam();
+  RunAndCompare<float>(F32, GemvProblem(shape, k_contiguous, with_bias),
+                       1e-6);
+}
+
+TEST_P(GemvKernelTest, MatchesReferenceF16) {
+  auto [shape, k_contiguous, with_bias] = GetParam();
+  // Inputs are exact in f16 and the kernel accumulates in f32, so only the
+  // rounding of the output remains.
+  RunAndCompare<sycl::half>(F16, GemvProblem(shape, k_contiguous, with_bias),
+                            1e-3);
+}
+
+TEST_P(GemvKernelTest, MatchesReferenceBF16) {
+  auto [shape, k_contiguous, with_bias] = GetParam();
+  RunAndCompare<sycl::ext::oneapi::bfloat16>(
+      BF16, GemvProblem(shape, k_contiguous, with_bias), 1e-2);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    GemvKernel, GemvKernelTest,
+    ::testing::Combine(
+        // Single elements, sizes that fill no sub-group or work-group evenly,
+        // batches and a decode-sized projection.
+        ::testing::Values(GemvShape{1, 1, 1}, GemvShape{1, 37, 101},
+                          GemvShape{3, 129, 257}, GemvShape{2, 4099, 17},
+                          GemvShape{1, 1000, 4096}),
+        /*k_contiguous=*/::testing::Bool(), /*with_bias=*/::testing::Bool()));
+
+TEST(GemvKernelUnsupportedTest, RejectsMatrixWithoutUnitStride) {
+  GemvDescriptor desc{};
+  desc.batch_size = 1;
+  desc.rows = 4;
+  desc.k = 4;
+  desc.row_stride = 4;
+  desc.k_stride = 1;
+  EXPECT_TRUE(IsGemvSupported(F32, desc));
+  EXPECT_FALSE(IsGemvSupported(F64, desc));
+  desc.row_stride = 8;
+  desc.k_stride = 2;
+  EXPECT_FALSE(IsGemvSupported(F32, desc));
+  // Rejected before anything is launched.
+  EXPECT_FALSE(RunGemv(/*stream=*/nullptr, F32, desc).ok());
+}
+
+// Bandwidth of an f16 GEMV over a range(0) x range(0) matrix with k
+// contiguous (range(1) = 1) or rows contiguous (range(1) = 0). Bytes
+// processed count the matrix only, which dominates the traffic.
+void BM_Gemv(::testing::benchmark::State& state) {
+  sycl::queue* queue = GetQueue();
+  if (queue == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int64_t size = state.range(0);
+  GemvProblem problem({1, size, size}, /*k_contiguous=*/state.range(1),
+                      /*with_bias=*/false);
+  DeviceGemv<sycl::half> gemv(queue, problem);
+  for (auto s : state) {
+    CHECK(RunGemv(queue, F16, gemv.desc).ok());
+    queue->wait();
+  }
+  state.SetBytesProcessed(state.iterations() * size * size *
+                          sizeof(sycl::half));
+}
+BENCHMARK(BM_Gemv)
+    ->ArgsProduct({{1024, 4096, 16384}, {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
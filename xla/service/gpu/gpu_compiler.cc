@@ -46,7 +46,6 @@ limitations under the License.
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/IR/Diagnostics.h"  // from @llvm-project
 #include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_instruction.h"
@@ -66,6 +65,7 @@ limitations under the License.
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
+#include "tsl/util/env_var.h"
 #include "xla/service/algebraic_simplifier.h"
 #include "xla/service/all_gather_broadcast_reorder.h"
 #include "xla/service/all_gather_combiner.h"
@@ -129,9 +129,11 @@ limitations under the License.
 #include "xla/service/gpu/gpu_reduce_scatter_creator.h"
 #include "xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "xla/service/gpu/gpu_scatter_expander.h"
+#include "xla/service/gpu/gpu_spmd_partitioner.h"
 #include "xla/service/gpu/hlo_fusion_stats.h"
 #include "xla/service/gpu/horizontal_loop_fusion.h"
 #include "xla/service/gpu/ir_emission_utils.h"
+#include "xla/service/gpu/llvm_module_split.h"
 #include "xla/service/gpu/loop_double_buffer_transformer.h"
 #include "xla/service/gpu/matmul_utils.h"
 #include "xla/service/gpu/metrics.h"
@@ -301,6 +303,34 @@ void SetInstructionMetadata(HloModule* module) {
     }
   }
 }
+
+// XLA_ENABLE_DOT_EXPAND_DIMS
+//   True: Run DotExpandDims before layout assignment, so that matrix-vector
+//         dots become GEMMs for the GEMV kernel and oneDNN.
+//   False (default behaviour): Leave matrix-vector dots to the emitters.
+// XLA_DOT_EXPAND_DIMS_MIN_ELEMENTS
+//   Smallest matrix, in elements, that DotExpandDims expands. Defaults to
+//   kDefaultMinGemvMatrixElements.
+bool IsDotExpandDimsEnabled() {
+  static bool enabled = [] {
+    bool value = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_ENABLE_DOT_EXPAND_DIMS",
+                                        /*default_val=*/false, &value));
+    return value;
+  }();
+  return enabled;
+}
+
+int64_t GetDotExpandDimsMinElements() {
+  static int64_t min_elements = [] {
+    int64_t value = kDefaultMinGemvMatrixElements;
+    TF_CHECK_OK(tsl::ReadInt64FromEnvVar("XLA_DOT_EXPAND_DIMS_MIN_ELEMENTS",
+                                         kDefaultMinGemvMatrixElements,
+                                         &value));
+    return value;
+  }();
+  return min_elements;
+}
 }  // namespace
 
 // Runs optimization passes on the given HLO module.
@@ -448,8 +478,15 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
     spmd_pipeline.AddPass<ShardingPropagation>(
         /*is_spmd=*/true, /*propagate_metadata=*/false,
         hlo_module->config().allow_spmd_sharding_propagation_to_output());
-    spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
-        num_partitions, hlo_module->config().replica_count());
+    // SYCL: partition tensor-parallel dots as windowed einsums when enabled.
+    if (IsWindowedEinsumEnabled()) {
+      spmd_pipeline.AddPass<GpuSpmdPartitioner>(
+          num_partitions, hlo_module->config().replica_count(),
+          GetWindowedEinsumThresholdMib());
+    } else {
+      spmd_pipeline.AddPass<spmd::StatefulRngSpmdPartitioner>(
+          num_partitions, hlo_module->config().replica_count());
+    }
     spmd_pipeline.AddPass<CollectivePermuteMotion>();
     TF_RETURN_IF_ERROR(spmd_pipeline.Run(hlo_module).status());
   } else {
@@ -737,10 +774,11 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
     HloPassPipeline pipeline("layout assignment");
     // Layout assignment uses alias analysis, which requires the call graph to
     // be flattened.
-    // SYCL
-    bool llm_flag = false;
-    tsl::ReadBoolFromEnvVar("LLM", false, &llm_flag);
-    if (llm_flag) pipeline.AddPass<DotExpandDims>();
+    // SYCL: DotExpandDims stays opt-in until the GEMV path has been measured
+    // against the fused reductions it replaces.
+    if (IsDotExpandDimsEnabled()) {
+      pipeline.AddPass<DotExpandDims>(GetDotExpandDimsMinElements());
+    }
     pipeline.AddPass<FlattenCallGraph>();
     ChannelLayoutConstraints layout_constraints;
     pipeline.AddPass<GpuLayoutAssignment>(
@@ -1315,7 +1353,12 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
       // SYCL: dump spv
       auto spir_vector = result->second;
       std::string spir(spir_vector.begin(), spir_vector.end());
-      DumpToFileInDirOrStdout(*debug_module, "", "spv", spir);
+      if (shard_number.has_value()) {
+        DumpToFileInDirOrStdout(*debug_module, "",
+                                std::to_string(*shard_number) + ".spv", spir);
+      } else {
+        DumpToFileInDirOrStdout(*debug_module, "", "spv", spir);
+      }
 
       absl::string_view ptx = result->first;
       if (debug_module) {
@@ -1375,53 +1418,9 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
     return compile_single_module(llvm_module.get(), /*relocatable=*/false,
                                  /*shard_number=*/std::nullopt);
   }
-  std::vector<std::unique_ptr<llvm::Module>> llvm_modules;
-  int num_functions = 0;
-  for (llvm::Function& func : llvm_module->functions()) {
-    if (!func.isDeclaration() &&
-        func.getLinkage() == llvm::GlobalValue::LinkageTypes::ExternalLinkage) {
-      num_functions++;
-    }
-  }
-
-  // Record the name of some constant global variables and their initializers.
-  // We'll change the linkage type of these variables from external to internal
-  // to ensure constant-folding works properly after calling llvm::SplitModule.
-  llvm::DenseMap<llvm::StringRef, llvm::Constant*> const_initializer_map;
-  for (llvm::GlobalVariable& gv : llvm_module->globals()) {
-    if (gv.hasName() && gv.isConstant() && gv.hasInitializer() &&
-        gv.hasExternalLinkage()) {
-      llvm::Constant* initializer = gv.getInitializer();
-      unsigned int num_elements = 0;
-      if (auto* caz =
-              llvm::dyn_cast<llvm::ConstantAggregateZero>(initializer)) {
-        num_elements = caz->getElementCount().getFixedValue();
-      } else if (auto* cds = llvm::dyn_cast<llvm::ConstantDataSequential>(
-                     initializer)) {
-        num_elements = cds->getNumElements();
-      }
-      if (num_elements > 0) {
-        const_initializer_map[gv.getName()] = initializer;
-      }
-    }
-  }
-
-  llvm::SplitModule(
-      *llvm_module,
-      std::max<unsigned>(
-          1, std::min<unsigned>(thread_pool->NumThreads(), num_functions)),
-      [&](std::unique_ptr<llvm::Module> module) {
-        // Change the linkage type of some global constant variables to internal
-        for (llvm::GlobalVariable& gv : module->globals()) {
-          if (gv.hasName() && gv.isConstant() && !gv.hasInitializer() &&
-              const_initializer_map.count(gv.getName()) != 0) {
-            gv.setInitializer(const_initializer_map[gv.getName()]);
-            gv.setLinkage(llvm::GlobalValue::InternalLinkage);
-          }
-        }
-        llvm_modules.push_back(std::move(module));
-      },
-      /*PreserveLocals=*/true);
+  std::vector<std::unique_ptr<llvm::Module>> llvm_modules =
+      SplitModuleForParallelCompilation(*llvm_module,
+                                        thread_pool->NumThreads());
 
   std::vector<StatusOr<BackendCompileResult>> compile_results(
       llvm_modules.size());
@@ -0,0 +1,71 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/gpu_spmd_partitioner.h"
+
+#include <utility>
+
+#include "tsl/platform/logging.h"
+#include "tsl/util/env_var.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Dots with operands below this size gain less from overlap than the
+// per-step launch and rendezvous cost of the in-process collectives.
+constexpr int64_t kDefaultWindowedEinsumThresholdMib = 64;
+
+}  // namespace
+
+bool IsWindowedEinsumEnabled() {
+  static bool enabled = [] {
+    bool value = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_GPU_ENABLE_WINDOWED_EINSUM",
+                                        /*default_val=*/false, &value));
+    return value;
+  }();
+  return enabled;
+}
+
+int64_t GetWindowedEinsumThresholdMib() {
+  static int64_t threshold = [] {
+    int64_t value = kDefaultWindowedEinsumThresholdMib;
+    TF_CHECK_OK(
+        tsl::ReadInt64FromEnvVar("XLA_GPU_WINDOWED_EINSUM_THRESHOLD_MIB",
+                                 kDefaultWindowedEinsumThresholdMib, &value));
+    return value;
+  }();
+  return threshold;
+}
+
+std::unique_ptr<spmd::SpmdPartitioningVisitor>
+GpuSpmdPartitioner::CreateVisitor(
+    HloComputation* computation, int64_t num_partitions, int64_t num_replicas,
+    const spmd::SPMDCollectiveOpsCreator& collective_ops_creator,
+    int64_t* next_channel_id, spmd::SpmdLogger* logger,
+    spmd::SpmdPartitionerOptions options, const CallGraph& call_graph) {
+  options.threshold_for_windowed_einsum_mib = windowed_einsum_threshold_mib_;
+  options.unroll_windowed_einsum = true;
+  VLOG(2) << "Windowed einsum threshold: " << windowed_einsum_threshold_mib_
+          << " MiB";
+  return spmd::StatefulRngSpmdPartitioner::CreateVisitor(
+      computation, num_partitions, num_replicas, collective_ops_creator,
+      next_channel_id, logger, std::move(options), call_graph);
+}
+
+}  // namespace gpu
+}  // namespace xla
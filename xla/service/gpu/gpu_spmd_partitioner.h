@@ -0,0 +1,66 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_GPU_SPMD_PARTITIONER_H_
+#define XLA_SERVICE_GPU_GPU_SPMD_PARTITIONER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "xla/service/spmd/spmd_partitioner.h"
+#include "xla/service/spmd/stateful_rng_spmd_partitioner.h"
+
+namespace xla {
+namespace gpu {
+
+// Whether the SPMD pipeline uses GpuSpmdPartitioner, set by
+// XLA_GPU_ENABLE_WINDOWED_EINSUM. Off by default until the overlap has been
+// measured across models.
+bool IsWindowedEinsumEnabled();
+
+// Returns the operand size in MiB above which tensor-parallel dots are
+// partitioned as windowed einsums, read from
+// XLA_GPU_WINDOWED_EINSUM_THRESHOLD_MIB.
+int64_t GetWindowedEinsumThresholdMib();
+
+// StatefulRngSpmdPartitioner that lowers all-gather+dot and dot+reduce-scatter
+// to windowed einsum loops. Each iteration computes one per-rank chunk while
+// a collective-permute shifts the next chunk around the ring; the loop is
+// unrolled so the permute of step i+1 is independent of the dot of step i
+// and can run on the async collective stream.
+class GpuSpmdPartitioner : public spmd::StatefulRngSpmdPartitioner {
+ public:
+  GpuSpmdPartitioner(int64_t num_partitions, int64_t num_replicas,
+                     int64_t windowed_einsum_threshold_mib)
+      : spmd::StatefulRngSpmdPartitioner(num_partitions, num_replicas),
+        windowed_einsum_threshold_mib_(windowed_einsum_threshold_mib) {}
+
+ protected:
+  std::unique_ptr<spmd::SpmdPartitioningVisitor> CreateVisitor(
+      HloComputation* computation, int64_t num_partitions,
+      int64_t num_replicas,
+      const spmd::SPMDCollectiveOpsCreator& collective_ops_creator,
+      int64_t* next_channel_id, spmd::SpmdLogger* logger,
+      spmd::SpmdPartitionerOptions options,
+      const CallGraph& call_graph) override;
+
+ private:
+  const int64_t windowed_einsum_threshold_mib_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_GPU_SPMD_PARTITIONER_H_
@@ -0,0 +1,118 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/gpu_spmd_partitioner.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/hlo_module_config.h"
+#include "xla/service/hlo_parser.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// A dot whose RHS is sharded along a non-contracting dimension, which the
+// partitioner either all-gathers or rotates around the ring.
+constexpr char kShardedDot[] = R"(
+HloModule module
+
+ENTRY entry {
+  lhs = f32[32,24,64,128] parameter(0)
+  lhs.copy = f32[32,24,64,128] copy(lhs), sharding={devices=[1,2,1,1]0,1}
+  rhs = f32[32,39296,64,128] parameter(1)
+  rhs.copy = f32[32,39296,64,128] copy(rhs), sharding={devices=[1,2,1,1]0,1}
+  ROOT dot = f32[32,24,39296] dot(lhs.copy, rhs.copy),
+    lhs_batch_dims={0}, rhs_batch_dims={0},
+    lhs_contracting_dims={2,3}, rhs_contracting_dims={2,3},
+    sharding={devices=[1,2,1]0,1}
+})";
+
+class GpuSpmdPartitionerTest : public ::testing::Test {
+ protected:
+  // Partitions kShardedDot over two devices.
+  std::unique_ptr<HloModule> Partition(int64_t threshold_mib) {
+    HloModuleConfig config;
+    config.set_use_spmd_partitioning(true);
+    config.set_num_partitions(2);
+    auto module = ParseAndReturnUnverifiedModule(kShardedDot, config);
+    TF_CHECK_OK(module.status());
+    GpuSpmdPartitioner partitioner(/*num_partitions=*/2, /*num_replicas=*/1,
+                                   threshold_mib);
+    auto changed = partitioner.Run(module->get(), {});
+    TF_CHECK_OK(changed.status());
+    EXPECT_TRUE(*changed);
+    return std::move(module).value();
+  }
+
+  static int64_t Count(const HloModule& module, HloOpcode opcode) {
+    int64_t count = 0;
+    for (const HloComputation* computation : module.computations()) {
+      for (const HloInstruction* instr : computation->instructions()) {
+        if (instr->opcode() == opcode) ++count;
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(GpuSpmdPartitionerTest, WindowedEinsumAboveThreshold) {
+  std::unique_ptr<HloModule> module = Partition(/*threshold_mib=*/0);
+  // The chunks are rotated with collective-permutes inside a loop instead of
+  // all-gathering the RHS ahead of one big dot.
+  EXPECT_EQ(Count(*module, HloOpcode::kWhile), 1);
+  EXPECT_GT(Count(*module, HloOpcode::kCollectivePermute), 0);
+}
+
+TEST_F(GpuSpmdPartitionerTest, WindowedEinsumIsUnrolled) {
+  std::unique_ptr<HloModule> module = Partition(/*threshold_mib=*/0);
+  // An unrolled loop computes two chunks per iteration, so its body holds
+  // more than one dot.
+  for (const HloComputation* computation : module->computations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      if (instr->opcode() != HloOpcode::kWhile) continue;
+      int64_t dots = 0;
+      for (const HloInstruction* body_instr :
+           instr->while_body()->instructions()) {
+        if (body_instr->opcode() == HloOpcode::kDot) ++dots;
+      }
+      EXPECT_GT(dots, 1);
+    }
+  }
+}
+
+TEST_F(GpuSpmdPartitionerTest, AllGatherBelowThreshold) {
+  // The RHS is about 38 GiB, far below this threshold.
+  std::unique_ptr<HloModule> module = Partition(/*threshold_mib=*/1 << 20);
+  EXPECT_EQ(Count(*module, HloOpcode::kWhile), 0);
+  EXPECT_EQ(Count(*module, HloOpcode::kCollectivePermute), 0);
+  EXPECT_GT(Count(*module, HloOpcode::kAllGather), 0);
+}
+
+TEST(WindowedEinsumFlagsTest, DisabledByDefault) {
+  EXPECT_FALSE(IsWindowedEinsumEnabled());
+  EXPECT_EQ(GetWindowedEinsumThresholdMib(), 64);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
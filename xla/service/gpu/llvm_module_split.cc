@@ -0,0 +1,51 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/llvm_module_split.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+
+namespace xla {
+namespace gpu {
+
+std::vector<std::unique_ptr<llvm::Module>> SplitModuleForParallelCompilation(
+    llvm::Module& module, int max_partitions) {
+  int num_functions = 0;
+  for (llvm::Function& func : module.functions()) {
+    if (!func.isDeclaration() &&
+        func.getLinkage() == llvm::GlobalValue::LinkageTypes::ExternalLinkage) {
+      num_functions++;
+    }
+  }
+
+  // Unlike the PTX path, constants are not turned into internal copies per
+  // partition: an internal constant has no symbol in the linked module, so
+  // ResolveConstantGlobals would bind its buffer allocation to a null global.
+  std::vector<std::unique_ptr<llvm::Module>> partitions;
+  llvm::SplitModule(
+      module,
+      std::max<unsigned>(1, std::min<unsigned>(max_partitions, num_functions)),
+      [&](std::unique_ptr<llvm::Module> partition) {
+        partitions.push_back(std::move(partition));
+      },
+      /*PreserveLocals=*/true);
+  return partitions;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,40 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
+#define XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
+
+#include <memory>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+
+namespace xla {
+namespace gpu {
+
+// Splits `module` into at most `max_partitions` modules, one per thread of
+// parallel compilation, and never more than it has kernels.
+//
+// Every constant global keeps a single external definition in one partition
+// and is declared in the others. The runtime links the partitions into one
+// Level Zero module, so the constants stay resolvable by name when the
+// executable binds them to their buffer allocations.
+std::vector<std::unique_ptr<llvm::Module>> SplitModuleForParallelCompilation(
+    llvm::Module& module, int max_partitions);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_LLVM_MODULE_SPLIT_H_
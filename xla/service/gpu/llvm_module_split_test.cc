@@ -0,0 +1,130 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/llvm_module_split.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/SourceMgr.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// Four kernels reading two constants, the way IrEmitterUnnested emits
+// constants with initializers.
+constexpr char kModuleWithConstants[] = R"(
+@buffer_for_c0 = constant [4 x float] [float 1.0, float 2.0, float 3.0, float 4.0], align 64
+@buffer_for_c1 = constant [2 x i32] [i32 7, i32 9], align 64
+
+define void @fusion_0(float* %out) {
+  %p = getelementptr [4 x float], [4 x float]* @buffer_for_c0, i64 0, i64 1
+  %v = load float, float* %p
+  store float %v, float* %out
+  ret void
+}
+
+define void @fusion_1(float* %out) {
+  %p = getelementptr [4 x float], [4 x float]* @buffer_for_c0, i64 0, i64 2
+  %v = load float, float* %p
+  store float %v, float* %out
+  ret void
+}
+
+define void @fusion_2(i32* %out) {
+  %p = getelementptr [2 x i32], [2 x i32]* @buffer_for_c1, i64 0, i64 0
+  %v = load i32, i32* %p
+  store i32 %v, i32* %out
+  ret void
+}
+
+define void @fusion_3(i32* %out) {
+  %p = getelementptr [2 x i32], [2 x i32]* @buffer_for_c1, i64 0, i64 1
+  %v = load i32, i32* %p
+  store i32 %v, i32* %out
+  ret void
+}
+)";
+
+std::unique_ptr<llvm::Module> ParseModule(llvm::LLVMContext& context) {
+  llvm::SMDiagnostic error;
+  std::unique_ptr<llvm::Module> module =
+      llvm::parseAssemblyString(kModuleWithConstants, error, context);
+  if (module == nullptr) error.print("llvm_module_split_test", llvm::errs());
+  return module;
+}
+
+TEST(SplitModuleForParallelCompilationTest, KeepsOneDefinitionPerConstant) {
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(context);
+  ASSERT_NE(module, nullptr);
+
+  std::vector<std::unique_ptr<llvm::Module>> partitions =
+      SplitModuleForParallelCompilation(*module, /*max_partitions=*/4);
+  ASSERT_GT(partitions.size(), 1);
+
+  for (const std::string name : {"buffer_for_c0", "buffer_for_c1"}) {
+    int definitions = 0;
+    for (const auto& partition : partitions) {
+      llvm::GlobalVariable* global = partition->getGlobalVariable(name);
+      if (global == nullptr) continue;
+      // Internal copies would leave no symbol to resolve the buffer
+      // allocation of the constant against in the linked module.
+      EXPECT_TRUE(global->hasExternalLinkage()) << name;
+      if (global->hasInitializer()) ++definitions;
+    }
+    EXPECT_EQ(definitions, 1) << name;
+  }
+}
+
+TEST(SplitModuleForParallelCompilationTest, KeepsEveryKernel) {
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(context);
+  ASSERT_NE(module, nullptr);
+
+  std::vector<std::unique_ptr<llvm::Module>> partitions =
+      SplitModuleForParallelCompilation(*module, /*max_partitions=*/4);
+  for (const std::string name :
+       {"fusion_0", "fusion_1", "fusion_2", "fusion_3"}) {
+    int definitions = 0;
+    for (const auto& partition : partitions) {
+      llvm::Function* function = partition->getFunction(name);
+      if (function != nullptr && !function->isDeclaration()) ++definitions;
+    }
+    EXPECT_EQ(definitions, 1) << name;
+  }
+}
+
+TEST(SplitModuleForParallelCompilationTest, NoMorePartitionsThanKernels) {
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(context);
+  ASSERT_NE(module, nullptr);
+
+  EXPECT_LE(SplitModuleForParallelCompilation(*module, 64).size(), 4);
+  llvm::LLVMContext context1;
+  std::unique_ptr<llvm::Module> module1 = ParseModule(context1);
+  ASSERT_NE(module1, nullptr);
+  EXPECT_EQ(SplitModuleForParallelCompilation(*module1, 1).size(), 1);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
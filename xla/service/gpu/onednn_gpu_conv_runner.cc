@@ -520,8 +520,9 @@ Status CreateOneDnnPrimitive(
       onednn_primitive->fwd_primitive = dnnl::convolution_forward(fwd_pd);
       size_t scratchpad_size = fwd_pd.scratchpad_desc().get_size();
       void* workspace;
-      TF_RETURN_IF_ERROR(
-          AllocateWorkspace(&workspace, scratch_allocator, scratchpad_size));
+      TF_RETURN_IF_ERROR(GetStreamWorkspace(
+          &workspace, params.stream, buffer_allocations.memory_allocator(),
+          scratchpad_size));
       onednn_primitive->scratchpad_memory = dnnl::memory(
           fwd_pd.scratchpad_desc(), onednn_primitive->engine, workspace);
 
@@ -572,8 +573,9 @@ Status CreateOneDnnPrimitive(
 
       size_t scratchpad_size = bwd_input_pd.scratchpad_desc().get_size();
       void* workspace;
-      TF_RETURN_IF_ERROR(
-          AllocateWorkspace(&workspace, scratch_allocator, scratchpad_size));
+      TF_RETURN_IF_ERROR(GetStreamWorkspace(
+          &workspace, params.stream, buffer_allocations.memory_allocator(),
+          scratchpad_size));
       onednn_primitive->scratchpad_memory = dnnl::memory(
           bwd_input_pd.scratchpad_desc(), onednn_primitive->engine, workspace);
 
@@ -631,8 +633,9 @@ Status CreateOneDnnPrimitive(
 
       size_t scratchpad_size = bwd_filter_pd.scratchpad_desc().get_size();
       void* workspace;
-      TF_RETURN_IF_ERROR(
-          AllocateWorkspace(&workspace, scratch_allocator, scratchpad_size));
+      TF_RETURN_IF_ERROR(GetStreamWorkspace(
+          &workspace, params.stream, buffer_allocations.memory_allocator(),
+          scratchpad_size));
       onednn_primitive->scratchpad_memory = dnnl::memory(
           bwd_filter_pd.scratchpad_desc(), onednn_primitive->engine, workspace);
 
@@ -37,6 +37,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/mlir_hlo/lhlo_gpu/IR/lhlo_gpu_ops.h"
+#include "xla/service/gpu/gemv_kernel.h"
 #include "xla/service/gpu/matrix_descriptor.h"
 #include "xla/service/gpu/xetla/gemm/gemm.h"
 #include "xla/service/onednn_util.h"
@@ -290,13 +291,94 @@ std::unique_ptr<OneDnnMatMulParams> CreateMatMulParams(
       out_strides, bias_strides);
 }
 
+template <typename InputT>
+constexpr PrimitiveType GemvType() {
+  if constexpr (std::is_same_v<InputT, float>) {
+    return F32;
+  } else if constexpr (std::is_same_v<InputT, sycl::half>) {
+    return F16;
+  } else {
+    return BF16;
+  }
+}
+
+// XLA_ENABLE_GEMV_KERNEL
+//   True: Run GEMMs with M == 1 or N == 1 on the GEMV kernel.
+//   False (default behaviour): Run them on XeTLA or oneDNN like other GEMMs.
+bool UseGemvKernel() {
+  static bool use_gemv = [] {
+    bool flag = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_ENABLE_GEMV_KERNEL",
+                                        /*default_val=*/false, &flag));
+    return flag;
+  }();
+  return use_gemv;
+}
+
+// Maps a GEMM with M == 1 or N == 1 onto the GEMV kernel. Returns nullopt if
+// the shape or epilogue needs the general path.
+std::optional<GemvDescriptor> GetGemvDescriptor(
+    int64_t batch_size, const MatrixDescriptor& lhs,
+    const MatrixDescriptor& rhs, const MatrixDescriptor& c,
+    const MatrixDescriptor& output, se::DeviceMemoryBase bias, float alpha,
+    float beta, se::gpu::BlasLt::Epilogue epilogue) {
+  if (fabs(alpha - 1.0f) > 1e-6) return std::nullopt;
+  if (c.data.opaque() && fabs(beta) > 1e-6) return std::nullopt;
+  if (epilogue != se::gpu::BlasLt::Epilogue::kDefault &&
+      epilogue != se::gpu::BlasLt::Epilogue::kBias) {
+    return std::nullopt;
+  }
+  // Output is row-major [m, n] after MakeBlasGemmCompatible.
+  int64_t m = output.num_rows;
+  int64_t n = output.num_cols;
+  if (m != 1 && n != 1) return std::nullopt;
+
+  bool lhs_trans = lhs.transpose == se::blas::Transpose::kTranspose;
+  bool rhs_trans = rhs.transpose == se::blas::Transpose::kTranspose;
+  int64_t lhs_ld = lhs.leading_dim_stride;
+  int64_t rhs_ld = rhs.leading_dim_stride;
+
+  GemvDescriptor desc;
+  desc.batch_size = batch_size;
+  desc.k = lhs.reduced_dim();
+  desc.out = output.data.opaque();
+  desc.out_batch_stride = output.batch_stride;
+  desc.bias = bias.opaque();
+  if (n == 1) {
+    // out[i] = sum_p lhs(i, p) * rhs(p, 0)
+    desc.rows = m;
+    desc.matrix = lhs.data.opaque();
+    desc.matrix_batch_stride = lhs.batch_stride;
+    desc.row_stride = lhs_trans ? 1 : lhs_ld;
+    desc.k_stride = lhs_trans ? lhs_ld : 1;
+    desc.vector = rhs.data.opaque();
+    desc.vector_batch_stride = rhs.batch_stride;
+    desc.vector_stride = rhs_trans ? 1 : rhs_ld;
+    desc.out_stride = output.leading_dim_stride;
+    desc.bias_stride = 0;
+  } else {
+    // out[j] = sum_p rhs(p, j) * lhs(0, p)
+    desc.rows = n;
+    desc.matrix = rhs.data.opaque();
+    desc.matrix_batch_stride = rhs.batch_stride;
+    desc.row_stride = rhs_trans ? rhs_ld : 1;
+    desc.k_stride = rhs_trans ? 1 : rhs_ld;
+    desc.vector = lhs.data.opaque();
+    desc.vector_batch_stride = lhs.batch_stride;
+    desc.vector_stride = lhs_trans ? lhs_ld : 1;
+    desc.out_stride = 1;
+    desc.bias_stride = 1;
+  }
+  return desc;
+}
+
 template <typename InputT>
 Status DoGemm(int64_t batch_size, int64_t m, int64_t n, int64_t k,
               const MatrixDescriptor& lhs, const MatrixDescriptor& rhs,
               const MatrixDescriptor& c, const MatrixDescriptor& output,
               se::DeviceMemoryBase bias, float alpha, float beta,
               se::gpu::BlasLt::Epilogue epilogue, se::Stream* stream,
-              se::ScratchAllocator* scratch_allocator,
+              se::DeviceMemoryAllocator* memory_allocator,
               se::blas::ComputePrecision compute_precision) {
   CHECK(output.transpose == se::blas::Transpose::kNoTranspose);
   se::gpu::GpuStreamHandle stream_handle =
@@ -322,6 +404,17 @@ Status DoGemm(int64_t batch_size, int64_t m, int64_t n, int64_t k,
   VLOG(2) << "lhs trans: " << TransposeString(lhs.transpose);
   VLOG(2) << "rhs trans: " << TransposeString(rhs.transpose);
 
+  // Decode-time matrix-vector products are memory bound; neither XeTLA's
+  // tiled GEMM nor oneDNN's matmul reach bandwidth there.
+  if (UseGemvKernel()) {
+    std::optional<GemvDescriptor> gemv = GetGemvDescriptor(
+        batch_size, lhs, rhs, c, output, bias, alpha, beta, epilogue);
+    if (gemv && IsGemvSupported(GemvType<InputT>(), *gemv)) {
+      VLOG(2) << "Running GEMV: rows=" << gemv->rows << " k=" << gemv->k;
+      return RunGemv(stream_handle, GemvType<InputT>(), *gemv);
+    }
+  }
+
   bool flag = false;
   tsl::ReadBoolFromEnvVar("XETLA_GEMM", false, &flag);
   bool xetla_support = flag && IsXetlaHardwareSupport() && (batch_size == 1) &&
@@ -332,69 +425,29 @@ Status DoGemm(int64_t batch_size, int64_t m, int64_t n, int64_t k,
                                              bias, epilogue, beta));
     if (!fallback) return OkStatus();
   }
-  auto params = CreateMatMulParams(batch_size, lhs, rhs, output);
-
-  auto src_md = dnnl::memory::desc(params->a_dims, OneDnnType<InputT>(),
-                                   params->a_strides);
-  auto weights_md = dnnl::memory::desc(params->b_dims, OneDnnType<InputT>(),
-                                       params->b_strides);
-  auto dst_md = dnnl::memory::desc(params->c_dims, OneDnnType<InputT>(),
-                                   params->c_strides);
-  auto bias_md =
-      bias_data ? dnnl::memory::desc(params->bias_dims, OneDnnType<InputT>(),
-                                     params->bias_strides)
-                : dnnl::memory::desc();
-
-  auto dnnl_engine = FindOrCreateEngine(stream_handle);
-  dnnl::primitive_attr post_ops_attr;
-  post_ops_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
-
-  // Set fp32 mode.
-  dnnl::fpmath_mode fp32_math_mode = GetFP32MathMode();
-  if (std::is_same<InputT, float>::value) {
-    post_ops_attr.set_fpmath_mode(fp32_math_mode);
-  }
-
-  dnnl::post_ops post_ops = dnnl::post_ops();
-  // C = activation(MatMul(x, w, bias) + beta * C)
-  //   po.append_sum(beta)
-  //   po.append_eltwise(dnnl::algorithm::activation, 1, 0);
   CHECK(fabs(alpha - 1.0f) < 1e-6);
-  if (c_data && fabs(beta - 0.0f) > 1e-6) post_ops.append_sum(beta);
-  switch (epilogue) {
-    case se::gpu::BlasLt::Epilogue::kReLU:
-    case se::gpu::BlasLt::Epilogue::kBiasThenReLU:
-      post_ops.append_eltwise(dnnl::algorithm::eltwise_relu, 0, 0);
-      break;
-    case se::gpu::BlasLt::Epilogue::kGELU:
-    case se::gpu::BlasLt::Epilogue::kBiasThenGELU:
-      post_ops.append_eltwise(dnnl::algorithm::eltwise_gelu_tanh, 0, 0);
-      break;
-    case se::gpu::BlasLt::Epilogue::kDefault:
-    case se::gpu::BlasLt::Epilogue::kBias:
-      break;
-    default:
-      return InternalError("Unsupported Activation mode");
-  }
-  post_ops_attr.set_post_ops(post_ops);
+  auto dnnl_engine = FindOrCreateEngine(stream_handle);
+  TF_ASSIGN_OR_RETURN(
+      auto matmul_pd,
+      CreateMatMulPrimitiveDesc(dnnl_engine, OneDnnType<InputT>(), batch_size,
+                                lhs, rhs, output, bias_data != nullptr,
+                                c_data ? beta : 0.0f, epilogue));
+  auto src_md = matmul_pd.src_desc();
+  auto weights_md = matmul_pd.weights_desc();
+  auto dst_md = matmul_pd.dst_desc();
+  auto bias_md = matmul_pd.bias_desc();
 
-  auto matmul_pd =
-      bias_data
-          ? std::make_shared<dnnl::matmul::primitive_desc>(
-                dnnl_engine, src_md, weights_md, bias_md, dst_md, post_ops_attr)
-          : std::make_shared<dnnl::matmul::primitive_desc>(
-                dnnl_engine, src_md, weights_md, dst_md, post_ops_attr);
   std::unordered_map<int, dnnl::memory> fwd_primitive_args;
 
-  size_t scratchpad_size = matmul_pd->scratchpad_desc().get_size();
+  size_t scratchpad_size = matmul_pd.scratchpad_desc().get_size();
   void* workspace;
-  TF_RETURN_IF_ERROR(
-      AllocateWorkspace(&workspace, scratch_allocator, scratchpad_size));
+  TF_RETURN_IF_ERROR(GetStreamWorkspace(&workspace, stream, memory_allocator,
+                                        scratchpad_size));
 
   auto scratchpad_mem =
-      dnnl::memory(matmul_pd->scratchpad_desc(), dnnl_engine, workspace);
+      dnnl::memory(matmul_pd.scratchpad_desc(), dnnl_engine, workspace);
 
-  auto matmul_primitive = dnnl::matmul(*matmul_pd);
+  auto matmul_primitive = dnnl::matmul(matmul_pd);
 
   auto dnnl_stream = dnnl::sycl_interop::make_stream(
       dnnl_engine, *(stream_executor::gpu::AsGpuStreamValue(stream)));
@@ -447,12 +500,64 @@ void MakeBlasGemmCompatible(MatrixDescriptor& lhs, MatrixDescriptor& rhs,
 }
 }  // namespace
 
+StatusOr<dnnl::matmul::primitive_desc> CreateMatMulPrimitiveDesc(
+    const dnnl::engine& engine, dnnl::memory::data_type type,
+    int64_t batch_size, const MatrixDescriptor& lhs,
+    const MatrixDescriptor& rhs, const MatrixDescriptor& output,
+    bool with_bias, float beta, se::gpu::BlasLt::Epilogue epilogue) {
+  auto params = CreateMatMulParams(batch_size, lhs, rhs, output);
+
+  auto src_md = dnnl::memory::desc(params->a_dims, type, params->a_strides);
+  auto weights_md =
+      dnnl::memory::desc(params->b_dims, type, params->b_strides);
+  auto dst_md = dnnl::memory::desc(params->c_dims, type, params->c_strides);
+
+  dnnl::primitive_attr post_ops_attr;
+  post_ops_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+
+  // Set fp32 mode.
+  if (type == dnnl::memory::data_type::f32) {
+    post_ops_attr.set_fpmath_mode(GetFP32MathMode());
+  }
+
+  dnnl::post_ops post_ops = dnnl::post_ops();
+  // C = activation(MatMul(x, w, bias) + beta * C)
+  //   po.append_sum(beta)
+  //   po.append_eltwise(dnnl::algorithm::activation, 1, 0);
+  if (fabs(beta - 0.0f) > 1e-6) post_ops.append_sum(beta);
+  switch (epilogue) {
+    case se::gpu::BlasLt::Epilogue::kReLU:
+    case se::gpu::BlasLt::Epilogue::kBiasThenReLU:
+      post_ops.append_eltwise(dnnl::algorithm::eltwise_relu, 0, 0);
+      break;
+    case se::gpu::BlasLt::Epilogue::kGELU:
+    case se::gpu::BlasLt::Epilogue::kBiasThenGELU:
+      post_ops.append_eltwise(dnnl::algorithm::eltwise_gelu_tanh, 0, 0);
+      break;
+    case se::gpu::BlasLt::Epilogue::kDefault:
+    case se::gpu::BlasLt::Epilogue::kBias:
+      break;
+    default:
+      return InternalError("Unsupported Activation mode");
+  }
+  post_ops_attr.set_post_ops(post_ops);
+
+  if (with_bias) {
+    auto bias_md =
+        dnnl::memory::desc(params->bias_dims, type, params->bias_strides);
+    return dnnl::matmul::primitive_desc(engine, src_md, weights_md, bias_md,
+                                        dst_md, post_ops_attr);
+  }
+  return dnnl::matmul::primitive_desc(engine, src_md, weights_md, dst_md,
+                                      post_ops_attr);
+}
+
 Status RunGemm(const GemmConfig& config, se::DeviceMemoryBase lhs_buffer,
                se::DeviceMemoryBase rhs_buffer, se::DeviceMemoryBase c_buffer,
                se::DeviceMemoryBase output_buffer,
                se::DeviceMemoryBase bias_buffer, se::Stream* stream,
                se::gpu::BlasLt::Epilogue epilogue,
-               se::ScratchAllocator* scratch_allocator) {
+               se::DeviceMemoryAllocator* memory_allocator) {
   VLOG(2) << "Executing a GemmThunk";
 
   auto lhs_layout = MatrixLayout{config.lhs_layout},
@@ -486,17 +591,17 @@ Status RunGemm(const GemmConfig& config, se::DeviceMemoryBase lhs_buffer,
     case F16:
       return DoGemm<sycl::half>(batch_size, m, n, k, lhs, rhs, c, output,
                                 bias_buffer, config.alpha.real(), config.beta,
-                                epilogue, stream, scratch_allocator,
+                                epilogue, stream, memory_allocator,
                                 config.compute_precision);
     case BF16:
       return DoGemm<::gpu::xetla::bf16>(
           batch_size, m, n, k, lhs, rhs, c, output, bias_buffer,
-          config.alpha.real(), config.beta, epilogue, stream, scratch_allocator,
+          config.alpha.real(), config.beta, epilogue, stream, memory_allocator,
           config.compute_precision);
     case F32:
       return DoGemm<float>(batch_size, m, n, k, lhs, rhs, c, output,
                            bias_buffer, config.alpha.real(), config.beta,
-                           epilogue, stream, scratch_allocator,
+                           epilogue, stream, memory_allocator,
                            config.compute_precision);
     case S32:
     case F64:
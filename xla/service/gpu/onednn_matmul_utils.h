@@ -24,10 +24,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/types/span.h"
+#include "dnnl.hpp"  // NOLINT(build/include_subdir)
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/ir_emission_utils.h"
 #include "xla/service/gpu/matmul_utils.h"
+#include "xla/service/gpu/matrix_descriptor.h"
 #include "xla/service/gpu/scratch_allocator.h"
 #include "xla/shape.h"
 #include "xla/statusor.h"
@@ -38,12 +40,22 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+// Returns the oneDNN matmul of `lhs` x `rhs` into `output` on `engine`, with
+// a bias when `with_bias`, plus `beta` times the prior output and then
+// `epilogue`. The primitive runs in user scratchpad mode: the caller passes
+// a buffer of scratchpad_desc().get_size() bytes as DNNL_ARG_SCRATCHPAD.
+StatusOr<dnnl::matmul::primitive_desc> CreateMatMulPrimitiveDesc(
+    const dnnl::engine& engine, dnnl::memory::data_type type,
+    int64_t batch_size, const MatrixDescriptor& lhs,
+    const MatrixDescriptor& rhs, const MatrixDescriptor& output,
+    bool with_bias, float beta, se::gpu::BlasLt::Epilogue epilogue);
+
 Status RunGemm(const GemmConfig& config, se::DeviceMemoryBase lhs_buffer,
                se::DeviceMemoryBase rhs_buffer, se::DeviceMemoryBase add_buffer,
                se::DeviceMemoryBase output_buffer,
                se::DeviceMemoryBase bias_buffer, se::Stream* stream,
                se::gpu::BlasLt::Epilogue epilogue,
-               se::ScratchAllocator* scratch_allocator = nullptr);
+               se::DeviceMemoryAllocator* memory_allocator);
 
 }  // namespace gpu
 }  // namespace xla
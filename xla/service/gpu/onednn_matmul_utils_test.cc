@@ -0,0 +1,178 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Sizes the user scratchpad of oneDNN matmuls on the CPU engine, so that the
+// checks run without a GPU. The matmul is built exactly as on the GPU; only
+// the engine differs.
+
+#include "xla/service/gpu/onednn_matmul_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "dnnl.hpp"  // NOLINT(build/include_subdir)
+#include "xla/service/gpu/matrix_descriptor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+struct MatMulShape {
+  int64_t batch_size;
+  int64_t m;
+  int64_t n;
+  int64_t k;
+};
+
+// Row-major matrix of `rows` x `cols`, read transposed when `transpose`.
+MatrixDescriptor Matrix(int64_t rows, int64_t cols, bool transpose) {
+  if (transpose) std::swap(rows, cols);
+  return MatrixDescriptor{se::DeviceMemoryBase(),
+                          transpose ? se::blas::Transpose::kTranspose
+                                    : se::blas::Transpose::kNoTranspose,
+                          rows,
+                          cols,
+                          rows * cols,
+                          cols};
+}
+
+// Small multiples of 1/4 keep the f32 sums exact.
+float Value(int64_t i) { return ((i * 7) % 11 - 5) / 4.0f; }
+
+void Fill(const dnnl::memory& memory, int64_t offset) {
+  const size_t count = memory.get_desc().get_size() / sizeof(float);
+  float* data = memory.map_data<float>();
+  for (size_t i = 0; i < count; ++i) data[i] = Value(i + offset);
+  memory.unmap_data(data);
+}
+
+std::vector<float> Read(const dnnl::memory& memory) {
+  const size_t count = memory.get_desc().get_size() / sizeof(float);
+  float* data = memory.map_data<float>();
+  std::vector<float> values(data, data + count);
+  memory.unmap_data(data);
+  return values;
+}
+
+class OneDnnMatMulScratchpadTest
+    : public ::testing::TestWithParam<
+          std::tuple<MatMulShape, bool, bool, bool>> {
+ protected:
+  void SetUp() override {
+    if (dnnl::engine::get_count(dnnl::engine::kind::cpu) == 0) {
+      GTEST_SKIP() << "No oneDNN CPU engine";
+    }
+    engine_ = dnnl::engine(dnnl::engine::kind::cpu, 0);
+  }
+
+  dnnl::engine engine_;
+};
+
+// Runs the matmul with a user scratchpad of exactly the reported size, and
+// compares it against a host reference.
+TEST_P(OneDnnMatMulScratchpadTest, RunsWithScratchpadOfReportedSize) {
+  auto [shape, transpose_lhs, transpose_rhs, with_bias] = GetParam();
+  const float beta = 0.5f;
+  auto pd = CreateMatMulPrimitiveDesc(
+      engine_, dnnl::memory::data_type::f32, shape.batch_size,
+      Matrix(shape.m, shape.k, transpose_lhs),
+      Matrix(shape.k, shape.n, transpose_rhs),
+      Matrix(shape.m, shape.n, /*transpose=*/false),
+      with_bias, beta,
+      with_bias ? se::gpu::BlasLt::Epilogue::kBiasThenReLU
+                : se::gpu::BlasLt::Epilogue::kReLU);
+  ASSERT_TRUE(pd.ok()) << pd.status();
+  EXPECT_EQ(pd->get_primitive_attr().get_scratchpad_mode(),
+            dnnl::scratchpad_mode::user);
+
+  dnnl::memory src(pd->src_desc(), engine_);
+  dnnl::memory weights(pd->weights_desc(), engine_);
+  dnnl::memory dst(pd->dst_desc(), engine_);
+  Fill(src, 0);
+  Fill(weights, 3);
+  Fill(dst, 7);
+  std::unordered_map<int, dnnl::memory> args = {{DNNL_ARG_SRC, src},
+                                                {DNNL_ARG_WEIGHTS, weights},
+                                                {DNNL_ARG_DST, dst}};
+  if (with_bias) {
+    dnnl::memory bias(pd->bias_desc(), engine_);
+    Fill(bias, 5);
+    args.emplace(DNNL_ARG_BIAS, bias);
+  }
+  dnnl::memory scratchpad(pd->scratchpad_desc(), engine_);
+  args.emplace(DNNL_ARG_SCRATCHPAD, scratchpad);
+
+  // Expected values before the primitive overwrites dst.
+  std::vector<float> a = Read(src), b = Read(weights), c = Read(dst);
+  std::vector<float> expected(c.size());
+  const int64_t lhs_ld = transpose_lhs ? shape.m : shape.k;
+  const int64_t rhs_ld = transpose_rhs ? shape.k : shape.n;
+  for (int64_t batch = 0; batch < shape.batch_size; ++batch) {
+    for (int64_t i = 0; i < shape.m; ++i) {
+      for (int64_t j = 0; j < shape.n; ++j) {
+        float acc = with_bias ? Value(j + 5) : 0.0f;
+        for (int64_t p = 0; p < shape.k; ++p) {
+          float lhs = a[batch * shape.m * shape.k +
+                        (transpose_lhs ? p * lhs_ld + i : i * lhs_ld + p)];
+          float rhs = b[batch * shape.k * shape.n +
+                        (transpose_rhs ? j * rhs_ld + p : p * rhs_ld + j)];
+          acc += lhs * rhs;
+        }
+        const int64_t out = (batch * shape.m + i) * shape.n + j;
+        expected[out] = std::max(acc + beta * c[out], 0.0f);
+      }
+    }
+  }
+
+  dnnl::stream stream(engine_);
+  dnnl::matmul(*pd).execute(stream, args);
+  stream.wait();
+  std::vector<float> result = Read(dst);
+  for (int64_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR(result[i], expected[i], 1e-4 * (shape.k + 2))
+        << "output " << i;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    OneDnnMatMul, OneDnnMatMulScratchpadTest,
+    ::testing::Combine(
+        // Single elements, sizes that fill no block evenly, and batches.
+        ::testing::Values(MatMulShape{1, 1, 1, 1}, MatMulShape{1, 37, 53, 101},
+                          MatMulShape{3, 64, 96, 128},
+                          MatMulShape{2, 257, 129, 33}),
+        /*transpose_lhs=*/::testing::Bool(),
+        /*transpose_rhs=*/::testing::Bool(), /*with_bias=*/::testing::Bool()));
+
+TEST(OneDnnMatMulPrimitiveDescTest, RejectsUnsupportedEpilogue) {
+  if (dnnl::engine::get_count(dnnl::engine::kind::cpu) == 0) {
+    GTEST_SKIP() << "No oneDNN CPU engine";
+  }
+  dnnl::engine engine(dnnl::engine::kind::cpu, 0);
+  auto pd = CreateMatMulPrimitiveDesc(
+      engine, dnnl::memory::data_type::f32, /*batch_size=*/1,
+      Matrix(4, 4, false), Matrix(4, 4, false), Matrix(4, 4, false),
+      /*with_bias=*/false, /*beta=*/0.0f,
+      se::gpu::BlasLt::Epilogue::kGELUWithAux);
+  EXPECT_FALSE(pd.ok());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
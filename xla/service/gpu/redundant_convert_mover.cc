@@ -15,54 +15,85 @@ limitations under the License.
 
 #include "xla/service/gpu/redundant_convert_mover.h"
 
+#include <vector>
+
 #include "xla/hlo/ir/hlo_instruction.h"
-#include "xla/service/hlo_creation_utils.h"
-#include "xla/service/pattern_matcher.h"
+#include "xla/primitive_util.h"
+#include "xla/shape_util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
 
 namespace xla {
 namespace gpu {
 
 namespace {
-namespace m = match;
-
-template <typename Pattern>
-auto OptionalBitcast(Pattern pattern) {
-  return m::AnyOf<HloInstruction>(m::Bitcast(pattern), std::move(pattern));
-}
 
-bool IsConvert(const HloInstruction* instr) {
-  return instr->opcode() == HloOpcode::kConvert;
+// Ops that only move elements around, so a convert commutes with them.
+bool IsConvertTransparent(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kBroadcast:
+    case HloOpcode::kCopy:
+    case HloOpcode::kReshape:
+    case HloOpcode::kSlice:
+    case HloOpcode::kTranspose:
+      return true;
+    case HloOpcode::kAllGather:
+    case HloOpcode::kAllToAll:
+    case HloOpcode::kCollectivePermute:
+      // Collectives that forward elements unchanged; only the single-array
+      // forms can be rebuilt with a different element type.
+      return instr->operand_count() == 1 && instr->shape().IsArray();
+    default:
+      return false;
+  }
 }
 
-bool MatchDuplicateConvertPatterns(HloInstruction* instr,
-                                   HloInstruction** bitcast_input,
-                                   HloInstruction** convert_2) {
-  // try to match convert(optionalbitcast(convert(optionalbitcast(input))))
-  // where input's shape and element type is same as the final output
-  auto default_duplicate_convert_pattern =
-      m::Op(convert_2).WithPredicate(IsConvert).WithOneUse().WithOperand(
-          0, OptionalBitcast(
-                 m::Op()
-                     .WithOperand(0, OptionalBitcast(m::Op(bitcast_input)))
-                     .WithPredicate(IsConvert)
-                     .WithOneUse()));
-  if (Match(instr, default_duplicate_convert_pattern) &&
-      (*convert_2)->shape() == (*bitcast_input)->shape() &&
-      (*convert_2)->shape().element_type() ==
-          (*bitcast_input)->shape().element_type()) {
-    return true;
+// Matches convert_2(m_n(...m_1(convert_1(input)))) where every m_i is convert
+// transparent and has one user, and convert_1 widens `input` losslessly to the
+// type convert_2 narrows from. On success `chain` holds m_1..m_n.
+bool MatchConvertPair(HloInstruction* convert_2, HloInstruction** input,
+                      std::vector<HloInstruction*>* chain) {
+  if (convert_2->opcode() != HloOpcode::kConvert) return false;
+  chain->clear();
+  HloInstruction* operand = convert_2->mutable_operand(0);
+  while (IsConvertTransparent(operand) && operand->user_count() == 1) {
+    chain->push_back(operand);
+    operand = operand->mutable_operand(0);
+  }
+  if (operand->opcode() != HloOpcode::kConvert || operand->user_count() != 1) {
+    return false;
   }
-  return false;
+  HloInstruction* convert_1 = operand;
+  *input = convert_1->mutable_operand(0);
+  PrimitiveType input_type = (*input)->shape().element_type();
+  PrimitiveType wide_type = convert_1->shape().element_type();
+  // convert(convert(x)) is only the identity if the intermediate type holds
+  // every value of x exactly, e.g. bf16 -> f32 -> bf16, but not f32 -> bf16 ->
+  // f32.
+  return convert_2->shape().element_type() == input_type &&
+         primitive_util::CastPreservesValues(input_type, wide_type);
 }
 
-StatusOr<bool> RemoveRedundantConversion(HloInstruction* instr) {
-  HloInstruction* bitcast_input = nullptr;
-  HloInstruction* convert_2 = nullptr;
-  if (MatchDuplicateConvertPatterns(instr, &bitcast_input, &convert_2)) {
-    instr->ReplaceOperandWith(0, bitcast_input);
-    return true;
+// Replaces convert_2 by the chain of data movement ops applied to `input`
+// directly, in the narrow element type.
+Status RemoveConvertPair(HloInstruction* convert_2, HloInstruction* input,
+                         const std::vector<HloInstruction*>& chain) {
+  HloComputation* computation = convert_2->parent();
+  PrimitiveType type = input->shape().element_type();
+  HloInstruction* result = input;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    HloInstruction* op = *it;
+    result = computation->AddInstruction(op->CloneWithNewOperands(
+        ShapeUtil::ChangeElementType(op->shape(), type), {result}));
+  }
+  if (!ShapeUtil::Equal(result->shape(), convert_2->shape())) {
+    // Only the layout can differ; keep it as the consumers expect.
+    result = computation->AddInstruction(
+        HloInstruction::CreateUnary(convert_2->shape(), HloOpcode::kCopy,
+                                    result));
   }
-  return false;
+  return computation->ReplaceInstruction(convert_2, result);
 }
 
 }  // namespace
@@ -70,17 +101,23 @@ StatusOr<bool> RemoveRedundantConversion(HloInstruction* instr) {
 StatusOr<bool> RedundantConvertMover::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  bool any_changed = false;
+  int64_t removed = 0;
   for (HloComputation* computation :
        module->MakeNonfusionComputations(execution_threads)) {
     for (HloInstruction* instr : computation->MakeInstructionPostOrder()) {
-      bool changed = false;
-      TF_ASSIGN_OR_RETURN(changed, RemoveRedundantConversion(instr));
-      any_changed |= changed;
+      HloInstruction* input = nullptr;
+      std::vector<HloInstruction*> chain;
+      if (!MatchConvertPair(instr, &input, &chain)) continue;
+      VLOG(3) << "Removing convert pair around " << chain.size()
+              << " ops ending at " << instr->ToString();
+      TF_RETURN_IF_ERROR(RemoveConvertPair(instr, input, chain));
+      removed += 2;
     }
   }
-  return any_changed;
+  VLOG(1) << "RedundantConvertMover removed " << removed << " converts in "
+          << module->name();
+  return removed > 0;
 }
 
 }  // namespace gpu
-}  // namespace xla
\ No newline at end of file
+}  // namespace xla
@@ -26,6 +26,11 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
+// Cancels convert pairs that round-trip through a wider type, e.g.
+// convert<bf16>(reshape(convert<f32>(x: bf16))) becomes reshape(x). The
+// data movement ops between the converts (bitcast, reshape, transpose,
+// broadcast, slice, copy and forwarding collectives) are rebuilt in the
+// narrow type, so they also move fewer bytes.
 class RedundantConvertMover : public HloModulePass {
  public:
   RedundantConvertMover() = default;
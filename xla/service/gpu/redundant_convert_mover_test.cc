@@ -0,0 +1,213 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/redundant_convert_mover.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/hlo_parser.h"
+#include "xla/service/pattern_matcher.h"
+#include "xla/service/pattern_matcher_gmock.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace m = ::xla::match;
+
+class RedundantConvertMoverTest : public ::testing::Test {
+ protected:
+  // Runs the pass on `hlo` and returns whether it changed the module.
+  bool RunPass(absl::string_view hlo) {
+    auto module = ParseAndReturnUnverifiedModule(hlo);
+    TF_CHECK_OK(module.status());
+    module_ = std::move(module).value();
+    auto changed = RedundantConvertMover().Run(module_.get(), {});
+    TF_CHECK_OK(changed.status());
+    return *changed;
+  }
+
+  const HloInstruction* root() const {
+    return module_->entry_computation()->root_instruction();
+  }
+
+  int64_t ConvertCount() const {
+    int64_t count = 0;
+    for (const HloInstruction* instr :
+         module_->entry_computation()->instructions()) {
+      if (instr->opcode() == HloOpcode::kConvert) ++count;
+    }
+    return count;
+  }
+
+  std::unique_ptr<HloModule> module_;
+};
+
+TEST_F(RedundantConvertMoverTest, CancelsLosslessRoundTrip) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = bf16[4,8] parameter(0)
+  c1 = f32[4,8] convert(p)
+  r = f32[32] reshape(c1)
+  ROOT c2 = bf16[32] convert(r)
+})"));
+  EXPECT_THAT(root(), GmockMatch(m::Reshape(m::Parameter(0))));
+  EXPECT_EQ(root()->shape().element_type(), BF16);
+  EXPECT_EQ(ConvertCount(), 0);
+}
+
+TEST_F(RedundantConvertMoverTest, CancelsDirectRoundTrip) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = f16[16] parameter(0)
+  c1 = f32[16] convert(p)
+  ROOT c2 = f16[16] convert(c1)
+})"));
+  EXPECT_THAT(root(), GmockMatch(m::Parameter(0)));
+}
+
+TEST_F(RedundantConvertMoverTest, KeepsLossyRoundTrip) {
+  // f32 -> bf16 -> f32 rounds away mantissa bits.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = f32[4,8] parameter(0)
+  c1 = bf16[4,8] convert(p)
+  r = bf16[32] reshape(c1)
+  ROOT c2 = f32[32] convert(r)
+})"));
+  EXPECT_EQ(ConvertCount(), 2);
+}
+
+TEST_F(RedundantConvertMoverTest, KeepsConvertsToAnotherType) {
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = bf16[16] parameter(0)
+  c1 = f32[16] convert(p)
+  ROOT c2 = f16[16] convert(c1)
+})"));
+  EXPECT_EQ(ConvertCount(), 2);
+}
+
+TEST_F(RedundantConvertMoverTest, RebuildsDataMovementInTheNarrowType) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = bf16[4,8] parameter(0)
+  c1 = f32[4,8] convert(p)
+  t = f32[8,4] transpose(c1), dimensions={1,0}
+  b = f32[2,8,4] broadcast(t), dimensions={1,2}
+  s = f32[1,8,4] slice(b), slice={[0:1], [0:8], [0:4]}
+  cp = f32[1,8,4] copy(s)
+  bc = f32[32] bitcast(cp)
+  ROOT c2 = bf16[32] convert(bc)
+})"));
+  EXPECT_THAT(root(),
+              GmockMatch(m::Bitcast(m::Copy(m::Slice(
+                  m::Broadcast(m::Transpose(m::Parameter(0))))))));
+  for (const HloInstruction* instr :
+       module_->entry_computation()->instructions()) {
+    EXPECT_EQ(instr->shape().element_type(), BF16) << instr->ToString();
+  }
+}
+
+TEST_F(RedundantConvertMoverTest, LooksThroughSingleArrayCollectives) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = bf16[4,8] parameter(0)
+  c1 = f32[4,8] convert(p)
+  ag = f32[8,8] all-gather(c1), dimensions={0}, replica_groups={{0,1}}
+  ROOT c2 = bf16[8,8] convert(ag)
+})"));
+  EXPECT_THAT(root(), GmockMatch(m::AllGather(m::Parameter(0))));
+  EXPECT_EQ(root()->shape().element_type(), BF16);
+}
+
+TEST_F(RedundantConvertMoverTest, KeepsChainsWithOtherUsers) {
+  // The wide reshape is also returned, so it has to stay in f32.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p = bf16[4,8] parameter(0)
+  c1 = f32[4,8] convert(p)
+  r = f32[32] reshape(c1)
+  c2 = bf16[32] convert(r)
+  ROOT t = (f32[32], bf16[32]) tuple(r, c2)
+})"));
+  EXPECT_EQ(ConvertCount(), 2);
+}
+
+TEST_F(RedundantConvertMoverTest, KeepsConvertsAroundDots) {
+  // The dot accumulates in f32, which is not the same computation in bf16.
+  EXPECT_FALSE(RunPass(R"(
+HloModule m
+
+ENTRY e {
+  p0 = bf16[4,8] parameter(0)
+  p1 = f32[8,4] parameter(1)
+  c1 = f32[4,8] convert(p0)
+  d = f32[4,4] dot(c1, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT c2 = bf16[4,4] convert(d)
+})"));
+  EXPECT_EQ(ConvertCount(), 2);
+}
+
+TEST_F(RedundantConvertMoverTest, CancelsPairsInEveryComputation) {
+  EXPECT_TRUE(RunPass(R"(
+HloModule m
+
+body {
+  p = bf16[8] parameter(0)
+  c1 = f32[8] convert(p)
+  ROOT c2 = bf16[8] convert(c1)
+}
+
+ENTRY e {
+  p = bf16[8] parameter(0)
+  c = bf16[8] call(p), to_apply=body
+  c1 = f32[8] convert(c)
+  r = f32[2,4] reshape(c1)
+  ROOT c2 = bf16[2,4] convert(r)
+})"));
+  EXPECT_EQ(ConvertCount(), 0);
+  for (const HloComputation* computation : module_->computations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      EXPECT_NE(instr->opcode(), HloOpcode::kConvert) << instr->ToString();
+    }
+  }
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
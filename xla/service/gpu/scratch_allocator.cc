@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "xla/service/gpu/scratch_allocator.h"
 
+#include "xla/stream_executor/sycl/sycl_stream_workspace.h"
+
 namespace xla {
 namespace gpu {
+
 tsl::Status AllocateWorkspace(
     void** workspace, stream_executor::ScratchAllocator* scratch_allocator,
     size_t num_bytes) {
@@ -26,5 +29,15 @@ tsl::Status AllocateWorkspace(
   return tsl::OkStatus();
 }
 
+tsl::Status GetStreamWorkspace(
+    void** workspace, stream_executor::Stream* stream,
+    stream_executor::DeviceMemoryAllocator* allocator, size_t num_bytes) {
+  TF_ASSIGN_OR_RETURN(
+      stream_executor::DeviceMemoryBase workspace_bytes,
+      stream_executor::gpu::GetStreamWorkspace(stream, allocator, num_bytes));
+  *workspace = workspace_bytes.opaque();
+  return tsl::OkStatus();
+}
+
 }  // namespace gpu
-}  // namespace xla
\ No newline at end of file
+}  // namespace xla
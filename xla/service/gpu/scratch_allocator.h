@@ -15,7 +15,9 @@ limitations under the License.
 
 #ifndef XLA_SERVICE_GPU_SCRATCH_ALLOCATOR_H_
 #define XLA_SERVICE_GPU_SCRATCH_ALLOCATOR_H_
+#include "xla/stream_executor/device_memory_allocator.h"
 #include "xla/stream_executor/scratch_allocator.h"
+#include "xla/stream_executor/stream.h"
 
 namespace xla {
 namespace gpu {
@@ -23,6 +25,16 @@ tsl::Status AllocateWorkspace(
     void** workspace, stream_executor::ScratchAllocator* scratch_allocator,
     size_t num_bytes);
 
+// Returns a scratchpad of at least `num_bytes` that stays owned by `stream`
+// and is allocated from `allocator`. oneDNN scratchpads are only live while
+// their primitive runs, and primitives on an in-order stream never overlap, so
+// every GEMM and convolution on the stream shares one buffer. It grows to the
+// largest request seen, which makes the hot path allocation free after the
+// first iteration.
+tsl::Status GetStreamWorkspace(
+    void** workspace, stream_executor::Stream* stream,
+    stream_executor::DeviceMemoryAllocator* allocator, size_t num_bytes);
+
 }  // namespace gpu
 }  // namespace xla
 #endif  // XLA_SERVICE_GPU_SCRATCH_ALLOCATOR_H_
\ No newline at end of file
@@ -61,6 +61,7 @@ limitations under the License.
 #include "xla/service/tuple_simplifier.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/sycl/sycl_platform_id.h"
+#include "xla/stream_executor/sycl/sycl_spirv_bundle.h"
 #include "xla/types.h"
 #include "xla/util.h"
 
@@ -191,8 +192,7 @@ Status SPIRCompiler::OptimizeHloPostLayoutAssignment(
     mha_fusion_pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
 
     // Rewrite Multi-Headed Attention modules to Fused MHA custom-calls.
-    // SYCL: RedundantConvertMover causes UT failure
-    // mha_fusion_pipeline.AddPass<RedundantConvertMover>();
+    mha_fusion_pipeline.AddPass<RedundantConvertMover>();
     mha_fusion_pipeline.AddPass<HloDCE>();
     mha_fusion_pipeline.AddPass<CudnnFusedMHARewriter>(
         cuda_compute_capability, stream_exec);
@@ -308,6 +308,25 @@ SPIRCompiler::CompileTargetBinary(const HloModuleConfig& module_config,
   return std::pair<std::string, std::vector<uint8_t>>("", std::move(spir_bin));
 }
 
+StatusOr<bool> SPIRCompiler::CanUseLinkModules(const HloModuleConfig& config) {
+  static bool use_link_modules = [] {
+    bool flag = false;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_SYCL_PARALLEL_COMPILATION", false,
+                                        &flag));
+    return flag;
+  }();
+  return use_link_modules;
+}
+
+StatusOr<std::vector<uint8_t>> SPIRCompiler::LinkModules(
+    se::StreamExecutor* stream_exec, std::vector<std::vector<uint8_t>> modules,
+    const DebugOptions& debug_options) {
+  if (modules.empty()) {
+    return InternalError("No SPIR-V modules to link");
+  }
+  return se::gpu::PackSpirvModules(modules);
+}
+
 /*static*/ SPIRCompiler* SPIRCompiler::CreateSPIRCompiler() {
   static auto compiler = absl::make_unique<SPIRCompiler>();
   return compiler.get();
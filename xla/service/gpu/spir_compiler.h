@@ -55,6 +55,16 @@ class SPIRCompiler : public GpuCompiler {
   static SPIRCompiler* CreateSPIRCompiler();
 
  private:
+  // Split LLVM modules are translated to SPIR-V in parallel and bundled; the
+  // runtime links the bundle into one Level Zero module at load time. Opt-in
+  // with XLA_SYCL_PARALLEL_COMPILATION=1.
+  StatusOr<bool> CanUseLinkModules(const HloModuleConfig& config) override;
+
+  StatusOr<std::vector<uint8_t>> LinkModules(
+      se::StreamExecutor* stream_exec,
+      std::vector<std::vector<uint8_t>> modules,
+      const DebugOptions& debug_options) override;
+
   SPIRCompiler(const SPIRCompiler&) = delete;
   SPIRCompiler& operator=(const SPIRCompiler&) = delete;
 };
@@ -0,0 +1,192 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "xla/service/gpu/llvm_gpu_backend/gpu_backend_lib.h"
+#include "xla/tests/filecheck.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+constexpr absl::string_view kModuleHeader =
+    "target datalayout = \"e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-"
+    "v192:256-v256:256-v512:512-v1024:1024-n8:16:32:64\"\n"
+    "target triple = \"spir64-unknown-unknown\"\n";
+
+// Runs the Xe vectorization pipeline on `ir` and matches the result against
+// the FileCheck `pattern`. Runs on the host; no device is needed.
+void RunAndFileCheck(absl::string_view ir, absl::string_view pattern) {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic error;
+  std::unique_ptr<llvm::Module> module = llvm::parseAssemblyString(
+      absl::StrCat(kModuleHeader, ir), error, context);
+  ASSERT_NE(module, nullptr) << error.getMessage().str();
+
+  spir::RunXeVectorizationPipeline(module.get());
+
+  std::string result;
+  llvm::raw_string_ostream stream(result);
+  module->print(stream, nullptr);
+  stream.flush();
+  auto matched = RunFileCheck(result, pattern);
+  ASSERT_TRUE(matched.ok()) << matched.status();
+  EXPECT_TRUE(*matched) << result;
+}
+
+TEST(SpirVectorizationTest, VectorizesContiguousAlignedAccesses) {
+  RunAndFileCheck(R"(
+define spir_kernel void @add(ptr addrspace(1) noalias align 16 %a,
+                             ptr addrspace(1) noalias align 16 %b,
+                             ptr addrspace(1) noalias align 16 %out) {
+  %a1 = getelementptr inbounds float, ptr addrspace(1) %a, i64 1
+  %a2 = getelementptr inbounds float, ptr addrspace(1) %a, i64 2
+  %a3 = getelementptr inbounds float, ptr addrspace(1) %a, i64 3
+  %b1 = getelementptr inbounds float, ptr addrspace(1) %b, i64 1
+  %b2 = getelementptr inbounds float, ptr addrspace(1) %b, i64 2
+  %b3 = getelementptr inbounds float, ptr addrspace(1) %b, i64 3
+  %o1 = getelementptr inbounds float, ptr addrspace(1) %out, i64 1
+  %o2 = getelementptr inbounds float, ptr addrspace(1) %out, i64 2
+  %o3 = getelementptr inbounds float, ptr addrspace(1) %out, i64 3
+  %x0 = load float, ptr addrspace(1) %a, align 16
+  %x1 = load float, ptr addrspace(1) %a1, align 4
+  %x2 = load float, ptr addrspace(1) %a2, align 8
+  %x3 = load float, ptr addrspace(1) %a3, align 4
+  %y0 = load float, ptr addrspace(1) %b, align 16
+  %y1 = load float, ptr addrspace(1) %b1, align 4
+  %y2 = load float, ptr addrspace(1) %b2, align 8
+  %y3 = load float, ptr addrspace(1) %b3, align 4
+  %s0 = fadd float %x0, %y0
+  %s1 = fadd float %x1, %y1
+  %s2 = fadd float %x2, %y2
+  %s3 = fadd float %x3, %y3
+  store float %s0, ptr addrspace(1) %out, align 16
+  store float %s1, ptr addrspace(1) %o1, align 4
+  store float %s2, ptr addrspace(1) %o2, align 8
+  store float %s3, ptr addrspace(1) %o3, align 4
+  ret void
+}
+)",
+                  R"(
+CHECK-LABEL: define spir_kernel void @add
+CHECK-DAG: load <4 x float>, ptr addrspace(1) %a, align 16
+CHECK-DAG: load <4 x float>, ptr addrspace(1) %b, align 16
+CHECK: store <4 x float> {{.*}}, ptr addrspace(1) %out, align 16
+CHECK-NOT: load float
+CHECK-NOT: store float
+CHECK: ret void
+)");
+}
+
+TEST(SpirVectorizationTest, KeepsMisalignedAccessesScalar) {
+  // Without target information that allows misaligned vector accesses,
+  // accesses only known to be 4-byte aligned stay scalar.
+  RunAndFileCheck(R"(
+define spir_kernel void @copy(ptr addrspace(1) noalias %in,
+                              ptr addrspace(1) noalias %out) {
+  %i1 = getelementptr inbounds float, ptr addrspace(1) %in, i64 1
+  %o1 = getelementptr inbounds float, ptr addrspace(1) %out, i64 1
+  %x0 = load float, ptr addrspace(1) %in, align 4
+  %x1 = load float, ptr addrspace(1) %i1, align 4
+  store float %x0, ptr addrspace(1) %out, align 4
+  store float %x1, ptr addrspace(1) %o1, align 4
+  ret void
+}
+)",
+                  R"(
+CHECK-LABEL: define spir_kernel void @copy
+CHECK-NOT: x float>
+CHECK: ret void
+)");
+}
+
+TEST(SpirVectorizationTest, KeepsStridedAccessesScalar) {
+  RunAndFileCheck(R"(
+define spir_kernel void @strided(ptr addrspace(1) noalias align 16 %in,
+                                 ptr addrspace(1) noalias align 16 %out) {
+  %i2 = getelementptr inbounds float, ptr addrspace(1) %in, i64 2
+  %x0 = load float, ptr addrspace(1) %in, align 16
+  %x2 = load float, ptr addrspace(1) %i2, align 8
+  %s = fadd float %x0, %x2
+  store float %s, ptr addrspace(1) %out, align 16
+  ret void
+}
+)",
+                  R"(
+CHECK-LABEL: define spir_kernel void @strided
+CHECK-NOT: x float>
+CHECK: ret void
+)");
+}
+
+TEST(SpirVectorizationTest, VectorizesHalfAccessesUpTo128Bits) {
+  // Eight halves fill one 128-bit message.
+  RunAndFileCheck(R"(
+define spir_kernel void @copy8(ptr addrspace(1) noalias align 16 %in,
+                               ptr addrspace(1) noalias align 16 %out) {
+  %i1 = getelementptr inbounds half, ptr addrspace(1) %in, i64 1
+  %i2 = getelementptr inbounds half, ptr addrspace(1) %in, i64 2
+  %i3 = getelementptr inbounds half, ptr addrspace(1) %in, i64 3
+  %i4 = getelementptr inbounds half, ptr addrspace(1) %in, i64 4
+  %i5 = getelementptr inbounds half, ptr addrspace(1) %in, i64 5
+  %i6 = getelementptr inbounds half, ptr addrspace(1) %in, i64 6
+  %i7 = getelementptr inbounds half, ptr addrspace(1) %in, i64 7
+  %o1 = getelementptr inbounds half, ptr addrspace(1) %out, i64 1
+  %o2 = getelementptr inbounds half, ptr addrspace(1) %out, i64 2
+  %o3 = getelementptr inbounds half, ptr addrspace(1) %out, i64 3
+  %o4 = getelementptr inbounds half, ptr addrspace(1) %out, i64 4
+  %o5 = getelementptr inbounds half, ptr addrspace(1) %out, i64 5
+  %o6 = getelementptr inbounds half, ptr addrspace(1) %out, i64 6
+  %o7 = getelementptr inbounds half, ptr addrspace(1) %out, i64 7
+  %x0 = load half, ptr addrspace(1) %in, align 16
+  %x1 = load half, ptr addrspace(1) %i1, align 2
+  %x2 = load half, ptr addrspace(1) %i2, align 4
+  %x3 = load half, ptr addrspace(1) %i3, align 2
+  %x4 = load half, ptr addrspace(1) %i4, align 8
+  %x5 = load half, ptr addrspace(1) %i5, align 2
+  %x6 = load half, ptr addrspace(1) %i6, align 4
+  %x7 = load half, ptr addrspace(1) %i7, align 2
+  store half %x0, ptr addrspace(1) %out, align 16
+  store half %x1, ptr addrspace(1) %o1, align 2
+  store half %x2, ptr addrspace(1) %o2, align 4
+  store half %x3, ptr addrspace(1) %o3, align 2
+  store half %x4, ptr addrspace(1) %o4, align 8
+  store half %x5, ptr addrspace(1) %o5, align 2
+  store half %x6, ptr addrspace(1) %o6, align 4
+  store half %x7, ptr addrspace(1) %o7, align 2
+  ret void
+}
+)",
+                  R"(
+CHECK-LABEL: define spir_kernel void @copy8
+CHECK: load <8 x half>, ptr addrspace(1) %in, align 16
+CHECK: store <8 x half> {{.*}}, ptr addrspace(1) %out, align 16
+CHECK: ret void
+)");
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
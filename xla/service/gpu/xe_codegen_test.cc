@@ -0,0 +1,213 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks the unoptimized LLVM IR that the SPIR compiler emits for fusions
+// whose launch configuration is picked by xe_tiling.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "llvm/IR/Module.h"
+#include "xla/service/compiler.h"
+#include "xla/service/gpu/spir_compiler.h"
+#include "xla/service/hlo_parser.h"
+#include "xla/service/llvm_ir/llvm_util.h"
+#include "xla/stream_executor/multi_platform_manager.h"
+#include "xla/tests/filecheck.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class XeCodegenTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto platform = se::MultiPlatformManager::PlatformWithName("SYCL");
+    if (!platform.ok() || (*platform)->VisibleDeviceCount() == 0) {
+      GTEST_SKIP() << "No GPU found";
+    }
+    auto executor = (*platform)->ExecutorForDevice(0);
+    ASSERT_TRUE(executor.ok()) << executor.status();
+    executor_ = *executor;
+  }
+
+  // Compiles `hlo` and matches its IR before LLVM optimization against the
+  // FileCheck `pattern`.
+  void CompileAndFileCheck(absl::string_view hlo, absl::string_view pattern) {
+    auto module = ParseAndReturnUnverifiedModule(hlo);
+    ASSERT_TRUE(module.ok()) << module.status();
+
+    std::string ir;
+    SPIRCompiler compiler;
+    compiler.SetPreOptimizationHook([&](const llvm::Module& llvm_module) {
+      ir = llvm_ir::DumpToString(&llvm_module);
+    });
+    auto optimized = compiler.RunHloPasses(std::move(module).value(),
+                                           executor_,
+                                           Compiler::CompileOptions());
+    ASSERT_TRUE(optimized.ok()) << optimized.status();
+    auto executable = compiler.RunBackend(std::move(optimized).value(),
+                                          executor_,
+                                          Compiler::CompileOptions());
+    ASSERT_TRUE(executable.ok()) << executable.status();
+
+    auto matched = RunFileCheck(ir, pattern);
+    ASSERT_TRUE(matched.ok()) << matched.status();
+    EXPECT_TRUE(*matched) << ir;
+  }
+
+  se::StreamExecutor* executor_ = nullptr;
+};
+
+TEST_F(XeCodegenTest, UnrollsHalfLoopToOneVectorAccess) {
+  // 2^28 elements leave every work-item of any Xe device eight of them, and
+  // eight halves fill one 16-byte access, where upstream stops at four.
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f16[268435456] parameter(0)
+  p1 = f16[268435456] parameter(1)
+  ROOT add = f16[268435456] add(p0, p1)
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK-COUNT-8: fadd half
+CHECK-NOT: fadd half
+CHECK: ret void
+)");
+}
+
+TEST_F(XeCodegenTest, UnrollsFloatLoopToOneVectorAccess) {
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[268435456] parameter(0)
+  p1 = f32[268435456] parameter(1)
+  ROOT add = f32[268435456] add(p0, p1)
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK-COUNT-4: fadd float
+CHECK-NOT: fadd float
+CHECK: ret void
+)");
+}
+
+TEST_F(XeCodegenTest, NarrowsUnrollToDivideTheElements) {
+  // 2^28 + 4 halves do not divide by 8, and the loop has no scalar tail.
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f16[268435460] parameter(0)
+  p1 = f16[268435460] parameter(1)
+  ROOT add = f16[268435460] add(p0, p1)
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK-COUNT-4: fadd half
+CHECK-NOT: fadd half
+CHECK: ret void
+)");
+}
+
+TEST_F(XeCodegenTest, KeepsSmallLoopsScalar) {
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f16[1024] parameter(0)
+  p1 = f16[1024] parameter(1)
+  ROOT add = f16[1024] add(p0, p1)
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK-COUNT-1: fadd half
+CHECK-NOT: fadd half
+CHECK: ret void
+)");
+}
+
+TEST_F(XeCodegenTest, SplitsRowReductionOverPowerOfTwoSubGroups) {
+  // Rows of 6000 floats need 375 work-items at 16 elements each. They are
+  // reduced by 8 sub-groups of 32 work-items, where upstream rounds up to 384
+  // work-items.
+  CompileAndFileCheck(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY e {
+  p0 = f32[64,6000] parameter(0)
+  zero = f32[] constant(0)
+  ROOT reduce = f32[64] reduce(p0, zero), dimensions={1}, to_apply=add
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK: !"maxntidx", i32 256}
+)");
+}
+
+TEST_F(XeCodegenTest, TransposesFloatsThroughA32x32Tile) {
+  // Each of the 32 x 8 work-items covers 4 rows of the tile, where upstream
+  // covers 8 rows with 32 x 4 threads.
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024,2048] parameter(0)
+  ROOT transpose = f32[2048,1024] transpose(p0), dimensions={1,0}
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK: !"maxntidx", i32 256}
+)");
+}
+
+TEST_F(XeCodegenTest, WidensByteTransposeTileToACacheLine) {
+  // A 64-byte cache line holds 64 bytes, so the tile is 64 x 64. Its 64 x 16
+  // work-items cover 4 rows each, or 8 rows on devices limited to 512.
+  CompileAndFileCheck(R"(
+HloModule m
+
+ENTRY e {
+  p0 = s8[1024,2048] parameter(0)
+  ROOT transpose = s8[2048,1024] transpose(p0), dimensions={1,0}
+}
+)",
+                      R"(
+CHECK: define spir_kernel void
+CHECK: !"maxntidx", i32 {{1024|512}}}
+)");
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,152 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/xe_tiling.h"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "tsl/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+int64_t PowerOfTwoFloor(int64_t x) {
+  int64_t result = 1;
+  while (result * 2 <= x) result *= 2;
+  return result;
+}
+
+int SelectSubGroupSize(int64_t row_length,
+                       absl::Span<const int> sub_group_sizes) {
+  CHECK(!sub_group_sizes.empty());
+  auto supports = [&](int size) {
+    return absl::c_linear_search(sub_group_sizes, size);
+  };
+  if (row_length >= 32 && supports(32)) return 32;
+  if (supports(16)) return 16;
+  if (supports(32)) return 32;
+  return *absl::c_max_element(sub_group_sizes);
+}
+
+}  // namespace
+
+XeLoopUnrollConfig SelectXeLoopUnroll(int64_t num_elements,
+                                      int64_t element_bytes,
+                                      int64_t alignment_bytes,
+                                      int64_t min_work_items) {
+  CHECK_GE(num_elements, 0);
+  CHECK_GT(element_bytes, 0);
+  CHECK_GT(alignment_bytes, 0);
+
+  XeLoopUnrollConfig config;
+  config.vector_elements = num_elements;
+  for (int factor : {8, 4, 2}) {
+    int64_t access_bytes = factor * element_bytes;
+    if (access_bytes > kXeMaxAccessBytes) continue;
+    if (alignment_bytes % access_bytes != 0) continue;
+    if (num_elements / factor < min_work_items) continue;
+    config.unroll_factor = factor;
+    config.vector_elements = num_elements / factor * factor;
+    break;
+  }
+  config.tail_elements = num_elements - config.vector_elements;
+  return config;
+}
+
+XeRowReductionConfig SelectXeRowReduction(int64_t row_length,
+                                          int64_t element_bytes,
+                                          absl::Span<const int> sub_group_sizes,
+                                          int max_work_group_size,
+                                          int64_t slm_bytes_limit) {
+  CHECK_GT(row_length, 0);
+  CHECK_GT(element_bytes, 0);
+
+  XeRowReductionConfig config;
+  config.sub_group_size = SelectSubGroupSize(row_length, sub_group_sizes);
+  const int sg = config.sub_group_size;
+  CHECK_GE(max_work_group_size, sg);
+
+  // Segmented shuffles only stay within a row if the rows tile the sub-group.
+  if (row_length < sg && sg % row_length == 0) {
+    config.rows_per_sub_group = sg / row_length;
+    return config;
+  }
+  if (row_length <= sg) return config;
+
+  // The SLM tree halves the number of partials each step, so the sub-groups
+  // of a row are a power of two.
+  int64_t sub_groups = std::min<int64_t>(max_work_group_size / sg,
+                                         (row_length + sg - 1) / sg);
+  sub_groups = PowerOfTwoFloor(sub_groups);
+  while (sub_groups > 1 && sub_groups * element_bytes > slm_bytes_limit) {
+    sub_groups /= 2;
+  }
+  config.sub_groups_per_row = sub_groups;
+  config.slm_bytes = sub_groups > 1 ? sub_groups * element_bytes : 0;
+  return config;
+}
+
+XeTransposeTiling SelectXeTransposeTiling(int64_t element_bytes,
+                                          int sub_group_size,
+                                          int max_work_group_size,
+                                          int64_t slm_bytes_limit,
+                                          bool block_2d_supported,
+                                          int64_t row_pitch_bytes) {
+  constexpr int64_t kCacheLineBytes = 64;
+  constexpr int64_t kMinRowsPerWorkItem = 4;
+  // 2D block loads need a pitch of at least 64 bytes, aligned to 16 bytes.
+  constexpr int64_t kMinBlock2dPitchBytes = 64;
+  constexpr int64_t kBlock2dPitchAlignment = 16;
+  CHECK_GT(element_bytes, 0);
+  CHECK_GT(sub_group_size, 0);
+
+  XeTransposeTiling tiling;
+  tiling.tile_cols = std::max<int64_t>(
+      sub_group_size, std::max<int64_t>(1, kCacheLineBytes / element_bytes));
+  tiling.tile_rows = tiling.tile_cols;
+
+  // A column read by a sub-group steps through SLM by one padded row per
+  // lane. Padding by one bank-sized access makes that step odd in accesses,
+  // so consecutive lanes land in different banks.
+  const int64_t access_bytes = std::max(kXeSlmBankBytes, element_bytes);
+  if ((tiling.tile_cols * element_bytes / access_bytes) % 2 == 0) {
+    tiling.padding_elements =
+        std::max<int64_t>(1, access_bytes / element_bytes);
+  }
+
+  while (tiling.tile_rows > sub_group_size &&
+         tiling.slm_bytes(element_bytes) > slm_bytes_limit) {
+    tiling.tile_rows /= 2;
+  }
+  CHECK_LE(tiling.slm_bytes(element_bytes), slm_bytes_limit)
+      << "SLM too small for a transpose tile";
+
+  tiling.rows_per_work_item = std::min(kMinRowsPerWorkItem, tiling.tile_rows);
+  while (tiling.rows_per_work_item < tiling.tile_rows &&
+         tiling.work_group_size() > max_work_group_size) {
+    tiling.rows_per_work_item *= 2;
+  }
+
+  tiling.use_block_2d_loads =
+      block_2d_supported && row_pitch_bytes >= kMinBlock2dPitchBytes &&
+      row_pitch_bytes % kBlock2dPitchAlignment == 0 &&
+      (tiling.tile_cols * element_bytes) % kXeSlmBankBytes == 0;
+  return tiling;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,108 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_XE_TILING_H_
+#define XLA_SERVICE_GPU_XE_TILING_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xla {
+namespace gpu {
+
+// Widest access a single Xe load/store message makes per work-item.
+inline constexpr int64_t kXeMaxAccessBytes = 16;
+
+// SLM is split into 16 banks of 4 bytes each; the lanes of a sub-group that
+// hit the same bank in one access are serialized.
+inline constexpr int64_t kXeSlmBanks = 16;
+inline constexpr int64_t kXeSlmBankBytes = 4;
+
+// How an elementwise loop fusion spreads its elements over work-items. Each
+// work-item handles `unroll_factor` contiguous elements with one vector access;
+// the last `tail_elements` elements, which do not fill a vector, are handled
+// with scalar accesses.
+struct XeLoopUnrollConfig {
+  int unroll_factor = 1;
+  int64_t vector_elements = 0;
+  int64_t tail_elements = 0;
+};
+
+// Picks the widest unroll factor of 8, 4 or 2 whose vector access fits into
+// kXeMaxAccessBytes, is aligned to `alignment_bytes` (the alignment of every
+// operand and result buffer) and still leaves at least `min_work_items`
+// work-items to keep the device busy. Falls back to one element per work-item.
+XeLoopUnrollConfig SelectXeLoopUnroll(int64_t num_elements,
+                                      int64_t element_bytes,
+                                      int64_t alignment_bytes,
+                                      int64_t min_work_items);
+
+// How a row reduction maps onto sub-groups. Rows shorter than the sub-group
+// are packed `rows_per_sub_group` to a sub-group and reduced with segmented
+// shuffles. Longer rows are split over `sub_groups_per_row` sub-groups whose
+// partial results are combined by a tree in `slm_bytes` of SLM.
+struct XeRowReductionConfig {
+  int sub_group_size = 0;
+  int rows_per_sub_group = 1;
+  int sub_groups_per_row = 1;
+  int64_t slm_bytes = 0;
+};
+
+// Picks the reduction layout for rows of `row_length` elements. The sub-group
+// size is 32 for rows that fill it and 16 otherwise, whichever of the two
+// `sub_group_sizes` supports. The number of sub-groups per row is bounded by
+// `max_work_group_size` and by `slm_bytes_limit`.
+XeRowReductionConfig SelectXeRowReduction(int64_t row_length,
+                                          int64_t element_bytes,
+                                          absl::Span<const int> sub_group_sizes,
+                                          int max_work_group_size,
+                                          int64_t slm_bytes_limit);
+
+// Tiling of a transpose through SLM. A work-group reads a `tile_rows` x
+// `tile_cols` tile with contiguous row accesses, each work-item covering
+// `rows_per_work_item` rows, and writes it back transposed. Every SLM row is
+// padded by `padding_elements` so that a sub-group reading a tile column hits
+// distinct banks.
+struct XeTransposeTiling {
+  int64_t tile_rows = 0;
+  int64_t tile_cols = 0;
+  int64_t padding_elements = 0;
+  int64_t rows_per_work_item = 1;
+  bool use_block_2d_loads = false;
+
+  int64_t work_group_size() const {
+    return tile_cols * tile_rows / rows_per_work_item;
+  }
+  int64_t slm_bytes(int64_t element_bytes) const {
+    return tile_rows * (tile_cols + padding_elements) * element_bytes;
+  }
+};
+
+// Picks a square tile at least one sub-group and one 64-byte cache line wide
+// that fits `max_work_group_size` and `slm_bytes_limit`. 2D block loads are
+// used when the device has them (Xe-HPC) and the source rows of
+// `row_pitch_bytes` meet their pitch constraints.
+XeTransposeTiling SelectXeTransposeTiling(int64_t element_bytes,
+                                          int sub_group_size,
+                                          int max_work_group_size,
+                                          int64_t slm_bytes_limit,
+                                          bool block_2d_supported,
+                                          int64_t row_pitch_bytes);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_GPU_XE_TILING_H_
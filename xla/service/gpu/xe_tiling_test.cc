@@ -0,0 +1,207 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/xe_tiling.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+struct LoopUnrollCase {
+  int64_t num_elements;
+  int64_t element_bytes;
+  int64_t alignment_bytes;
+  int expected_unroll_factor;
+};
+
+class XeLoopUnrollTest : public ::testing::TestWithParam<LoopUnrollCase> {};
+
+TEST_P(XeLoopUnrollTest, SelectsUnrollFactor) {
+  const LoopUnrollCase& c = GetParam();
+  XeLoopUnrollConfig config =
+      SelectXeLoopUnroll(c.num_elements, c.element_bytes, c.alignment_bytes,
+                         /*min_work_items=*/1024);
+  EXPECT_EQ(config.unroll_factor, c.expected_unroll_factor);
+  EXPECT_LE(config.unroll_factor * c.element_bytes, kXeMaxAccessBytes);
+  EXPECT_EQ(config.vector_elements % config.unroll_factor, 0);
+  EXPECT_LT(config.tail_elements, config.unroll_factor);
+  EXPECT_EQ(config.vector_elements + config.tail_elements, c.num_elements);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    XeLoopUnroll, XeLoopUnrollTest,
+    ::testing::Values(
+        // Byte and half types fill 8 lanes, floats 4 and doubles 2.
+        LoopUnrollCase{1 << 20, 1, 64, 8}, LoopUnrollCase{1 << 20, 2, 64, 8},
+        LoopUnrollCase{1 << 20, 4, 64, 4}, LoopUnrollCase{1 << 20, 8, 64, 2},
+        // 16-byte elements such as c128 never vectorize further.
+        LoopUnrollCase{1 << 20, 16, 64, 1},
+        // Misaligned slices narrow the access to the buffer alignment.
+        LoopUnrollCase{1 << 20, 2, 8, 4}, LoopUnrollCase{1 << 20, 4, 4, 1},
+        // Element counts that do not divide keep a scalar tail.
+        LoopUnrollCase{(1 << 20) + 3, 4, 64, 4},
+        // Small loops keep one element per work-item to fill the device.
+        LoopUnrollCase{2048, 4, 64, 2}, LoopUnrollCase{1000, 4, 64, 1},
+        LoopUnrollCase{0, 4, 64, 1}));
+
+TEST(XeLoopUnrollConfigTest, ScalarTailCoversTheRemainder) {
+  XeLoopUnrollConfig config =
+      SelectXeLoopUnroll(/*num_elements=*/4099, /*element_bytes=*/2,
+                         /*alignment_bytes=*/16, /*min_work_items=*/1);
+  EXPECT_EQ(config.unroll_factor, 8);
+  EXPECT_EQ(config.vector_elements, 4096);
+  EXPECT_EQ(config.tail_elements, 3);
+}
+
+struct RowReductionCase {
+  int64_t row_length;
+  std::vector<int> sub_group_sizes;
+  int expected_sub_group_size;
+  int expected_rows_per_sub_group;
+  int expected_sub_groups_per_row;
+};
+
+class XeRowReductionTest : public ::testing::TestWithParam<RowReductionCase> {
+};
+
+TEST_P(XeRowReductionTest, SelectsSubGroupLayout) {
+  const RowReductionCase& c = GetParam();
+  XeRowReductionConfig config =
+      SelectXeRowReduction(c.row_length, /*element_bytes=*/4,
+                           c.sub_group_sizes, /*max_work_group_size=*/1024,
+                           /*slm_bytes_limit=*/128 * 1024);
+  EXPECT_EQ(config.sub_group_size, c.expected_sub_group_size);
+  EXPECT_EQ(config.rows_per_sub_group, c.expected_rows_per_sub_group);
+  EXPECT_EQ(config.sub_groups_per_row, c.expected_sub_groups_per_row);
+  EXPECT_EQ(config.slm_bytes, config.sub_groups_per_row > 1
+                                  ? config.sub_groups_per_row * 4
+                                  : 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    XeRowReduction, XeRowReductionTest,
+    ::testing::Values(
+        // Narrow rows are packed into 16-wide sub-groups.
+        RowReductionCase{1, {16, 32}, 16, 16, 1},
+        RowReductionCase{4, {16, 32}, 16, 4, 1},
+        RowReductionCase{8, {8, 16, 32}, 16, 2, 1},
+        RowReductionCase{16, {16, 32}, 16, 1, 1},
+        // Rows that do not tile the sub-group get one sub-group each.
+        RowReductionCase{12, {16, 32}, 16, 1, 1},
+        // Wide rows use 32-wide sub-groups and an SLM tree.
+        RowReductionCase{32, {16, 32}, 32, 1, 1},
+        RowReductionCase{100, {16, 32}, 32, 1, 4},
+        RowReductionCase{4096, {16, 32}, 32, 1, 32},
+        // Devices without 32-wide sub-groups stay at 16.
+        RowReductionCase{4096, {8, 16}, 16, 1, 64},
+        RowReductionCase{4, {8}, 8, 2, 1}));
+
+TEST(XeRowReductionConfigTest, SlmLimitShrinksTheTree) {
+  XeRowReductionConfig config =
+      SelectXeRowReduction(/*row_length=*/1 << 20, /*element_bytes=*/8,
+                           /*sub_group_sizes=*/{16, 32},
+                           /*max_work_group_size=*/1024,
+                           /*slm_bytes_limit=*/64);
+  EXPECT_EQ(config.sub_group_size, 32);
+  EXPECT_EQ(config.sub_groups_per_row, 8);
+  EXPECT_EQ(config.slm_bytes, 64);
+}
+
+struct TransposeCase {
+  int64_t element_bytes;
+  int sub_group_size;
+  int64_t expected_tile;
+  int64_t expected_padding_elements;
+};
+
+class XeTransposeTilingTest : public ::testing::TestWithParam<TransposeCase> {
+};
+
+TEST_P(XeTransposeTilingTest, SelectsTileAndPadding) {
+  const TransposeCase& c = GetParam();
+  XeTransposeTiling tiling = SelectXeTransposeTiling(
+      c.element_bytes, c.sub_group_size, /*max_work_group_size=*/1024,
+      /*slm_bytes_limit=*/64 * 1024, /*block_2d_supported=*/false,
+      /*row_pitch_bytes=*/4096);
+  EXPECT_EQ(tiling.tile_rows, c.expected_tile);
+  EXPECT_EQ(tiling.tile_cols, c.expected_tile);
+  EXPECT_EQ(tiling.padding_elements, c.expected_padding_elements);
+  EXPECT_LE(tiling.work_group_size(), 1024);
+
+  // The lanes of a sub-group reading one tile column hit distinct banks, up to
+  // the number of banks an access spans.
+  const int64_t row_bytes =
+      (tiling.tile_cols + tiling.padding_elements) * c.element_bytes;
+  const int64_t banks_per_access =
+      std::max<int64_t>(1, c.element_bytes / kXeSlmBankBytes);
+  std::vector<int> hits(kXeSlmBanks, 0);
+  for (int lane = 0; lane < c.sub_group_size; ++lane) {
+    hits[(lane * row_bytes / kXeSlmBankBytes) % kXeSlmBanks]++;
+  }
+  const int64_t max_lanes_per_bank =
+      std::max<int64_t>(1, c.sub_group_size * banks_per_access / kXeSlmBanks);
+  for (int h : hits) EXPECT_LE(h, max_lanes_per_bank);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    XeTransposeTiling, XeTransposeTilingTest,
+    ::testing::Values(
+        // Narrow types widen the tile to a full cache line and pad one bank.
+        TransposeCase{1, 16, 64, 4}, TransposeCase{2, 16, 32, 2},
+        TransposeCase{4, 16, 16, 1}, TransposeCase{4, 32, 32, 1},
+        // Wide types pad one whole element.
+        TransposeCase{8, 16, 16, 1}, TransposeCase{16, 16, 16, 1}));
+
+TEST(XeTransposeTilingConfigTest, SlmLimitShrinksTileRows) {
+  XeTransposeTiling tiling = SelectXeTransposeTiling(
+      /*element_bytes=*/1, /*sub_group_size=*/16,
+      /*max_work_group_size=*/1024, /*slm_bytes_limit=*/2048,
+      /*block_2d_supported=*/false, /*row_pitch_bytes=*/4096);
+  EXPECT_EQ(tiling.tile_cols, 64);
+  EXPECT_EQ(tiling.tile_rows, 16);
+  EXPECT_LE(tiling.slm_bytes(1), 2048);
+}
+
+TEST(XeTransposeTilingConfigTest, WorkGroupLimitRaisesRowsPerWorkItem) {
+  XeTransposeTiling tiling = SelectXeTransposeTiling(
+      /*element_bytes=*/1, /*sub_group_size=*/16,
+      /*max_work_group_size=*/256, /*slm_bytes_limit=*/64 * 1024,
+      /*block_2d_supported=*/false, /*row_pitch_bytes=*/4096);
+  EXPECT_EQ(tiling.rows_per_work_item, 16);
+  EXPECT_EQ(tiling.work_group_size(), 256);
+}
+
+TEST(XeTransposeTilingConfigTest, Block2dLoadsNeedSupportAndPitch) {
+  auto uses_block_2d = [](bool supported, int64_t pitch) {
+    return SelectXeTransposeTiling(/*element_bytes=*/2, /*sub_group_size=*/16,
+                                   /*max_work_group_size=*/1024,
+                                   /*slm_bytes_limit=*/64 * 1024, supported,
+                                   pitch)
+        .use_block_2d_loads;
+  };
+  EXPECT_TRUE(uses_block_2d(true, 4096));
+  EXPECT_FALSE(uses_block_2d(false, 4096));
+  EXPECT_FALSE(uses_block_2d(true, 32));
+  EXPECT_FALSE(uses_block_2d(true, 4104));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
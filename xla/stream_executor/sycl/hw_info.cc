@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "xla/stream_executor/sycl/hw_info.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 
 const int32_t XeHPC_id = 0xbd0;
 const char* const XeHPC_name = "0x0bd";
@@ -65,3 +70,94 @@ bool IsXetlaHardwareSupport() {
   static bool flag = IsXeHPC(nullptr);
   return flag;
 }
+
+namespace {
+
+struct XeArchDefaults {
+  int eus_per_subslice;
+  int threads_per_eu;
+  int simd_width;
+  int64_t slm_bytes_per_subslice;
+  bool large_grf_supported;
+};
+
+XeArchDefaults GetXeArchDefaults(XeArch arch) {
+  switch (arch) {
+    case XeArch::kXeHPC:
+      return {8, 8, 16, 128 * 1024, true};
+    case XeArch::kXeHPG:
+      return {16, 8, 8, 64 * 1024, false};
+    default:
+      return {8, 7, 8, 64 * 1024, false};
+  }
+}
+
+}  // namespace
+
+bool XeDeviceInfo::SupportsSubGroupSize(int sub_group_size) const {
+  return std::find(sub_group_sizes.begin(), sub_group_sizes.end(),
+                   sub_group_size) != sub_group_sizes.end();
+}
+
+std::string XeDeviceInfo::ToString() const {
+  return absl::StrFormat(
+      "eus=%d eus_per_subslice=%d threads_per_eu=%d simd=%d "
+      "sub_groups=[%s] slm_per_subslice=%dB large_grf=%d",
+      eu_count, eus_per_subslice, threads_per_eu, simd_width,
+      absl::StrJoin(sub_group_sizes, ","), slm_bytes_per_subslice,
+      large_grf_supported);
+}
+
+XeArch XeArchFromDeviceId(uint32_t device_id) {
+  if ((device_id & 0xff0) == static_cast<uint32_t>(XeHPC_id)) {
+    return XeArch::kXeHPC;
+  }
+  if ((device_id & 0xff00) == 0x5600) return XeArch::kXeHPG;
+  return XeArch::kUnknown;
+}
+
+XeDeviceInfo MakeXeDeviceInfo(XeArch arch, int eu_count, int eus_per_subslice,
+                              int threads_per_eu, int64_t slm_bytes,
+                              std::vector<int> sub_group_sizes) {
+  XeArchDefaults defaults = GetXeArchDefaults(arch);
+  XeDeviceInfo info;
+  info.arch = arch;
+  info.eu_count = eu_count;
+  info.eus_per_subslice =
+      eus_per_subslice > 0 ? eus_per_subslice : defaults.eus_per_subslice;
+  info.threads_per_eu =
+      threads_per_eu > 0 ? threads_per_eu : defaults.threads_per_eu;
+  info.simd_width = defaults.simd_width;
+  info.slm_bytes_per_subslice =
+      slm_bytes > 0 ? slm_bytes : defaults.slm_bytes_per_subslice;
+  info.large_grf_supported = defaults.large_grf_supported;
+  info.sub_group_sizes = std::move(sub_group_sizes);
+  std::sort(info.sub_group_sizes.begin(), info.sub_group_sizes.end());
+  return info;
+}
+
+XeDeviceInfo GetXeDeviceInfo(sycl::device* device) {
+  XeArch arch = XeArch::kUnknown;
+#if defined(SYCL_EXT_INTEL_DEVICE_INFO) && (SYCL_EXT_INTEL_DEVICE_INFO >= 5)
+  arch = XeArchFromDeviceId(
+      device->get_info<sycl::ext::intel::info::device::device_id>());
+#else
+  std::string name = device->get_info<sycl::info::device::name>();
+  if (name.find(XeHPC_name) != std::string::npos ||
+      name.find(XeHPC_name_new) != std::string::npos) {
+    arch = XeArch::kXeHPC;
+  } else if (name.find("Arc") != std::string::npos ||
+             name.find("Flex") != std::string::npos) {
+    arch = XeArch::kXeHPG;
+  }
+#endif
+  auto sub_group_sizes =
+      device->get_info<sycl::info::device::sub_group_sizes>();
+  return MakeXeDeviceInfo(
+      arch, device->get_info<sycl::ext::intel::info::device::gpu_eu_count>(),
+      device->get_info<
+          sycl::ext::intel::info::device::gpu_eu_count_per_subslice>(),
+      device->get_info<sycl::ext::intel::info::device::gpu_hw_threads_per_eu>(),
+      device->get_info<sycl::info::device::local_mem_size>(),
+      std::vector<int>(sub_group_sizes.begin(), sub_group_sizes.end()));
+}
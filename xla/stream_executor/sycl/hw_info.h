@@ -16,10 +16,58 @@ limitations under the License.
 #ifndef XLA_STREAM_EXECUTOR_SYCL_HW_INFO_H_
 #define XLA_STREAM_EXECUTOR_SYCL_HW_INFO_H_
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
 
 bool IsXeHPC(sycl::device* device_ptr = nullptr);
 
 bool IsXetlaHardwareSupport();
 
+enum class XeArch {
+  kUnknown,
+  kXeHPG,  // Arc and Data Center GPU Flex
+  kXeHPC,  // Data Center GPU Max
+};
+
+// Execution resources of an Xe GPU, in the terms launch dimensions are
+// chosen by. A subslice (Xe-core) plays the role of a CUDA multiprocessor.
+struct XeDeviceInfo {
+  XeArch arch = XeArch::kUnknown;
+  int eu_count = 0;
+  int eus_per_subslice = 0;
+  int threads_per_eu = 0;
+  // FP32 lanes per EU.
+  int simd_width = 0;
+  std::vector<int> sub_group_sizes;
+  int64_t slm_bytes_per_subslice = 0;
+  bool large_grf_supported = false;
+
+  int subslice_count() const {
+    return eus_per_subslice > 0 ? eu_count / eus_per_subslice : 0;
+  }
+  // Work-items resident on one subslice when every hardware thread runs a
+  // sub-group of `sub_group_size`.
+  int64_t max_work_items_per_subslice(int sub_group_size) const {
+    return static_cast<int64_t>(eus_per_subslice) * threads_per_eu *
+           sub_group_size;
+  }
+  int fp32_lanes_per_subslice() const { return eus_per_subslice * simd_width; }
+  bool SupportsSubGroupSize(int sub_group_size) const;
+
+  std::string ToString() const;
+};
+
+XeArch XeArchFromDeviceId(uint32_t device_id);
+
+// Builds the description from raw device queries; fields the device leaves
+// at zero are filled from the defaults of `arch`.
+XeDeviceInfo MakeXeDeviceInfo(XeArch arch, int eu_count, int eus_per_subslice,
+                              int threads_per_eu, int64_t slm_bytes,
+                              std::vector<int> sub_group_sizes);
+
+XeDeviceInfo GetXeDeviceInfo(sycl::device* device);
+
 #endif  // XLA_STREAM_EXECUTOR_SYCL_HW_INFO_H_
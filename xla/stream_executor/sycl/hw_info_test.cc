@@ -0,0 +1,134 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/hw_info.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace {
+
+struct DeviceInfoCase {
+  std::string name;
+  // Raw device queries.
+  XeArch arch;
+  int eu_count;
+  int eus_per_subslice;
+  int threads_per_eu;
+  int64_t slm_bytes;
+  std::vector<int> sub_group_sizes;
+  // Expected description.
+  int subslice_count;
+  int expected_eus_per_subslice;
+  int expected_threads_per_eu;
+  int simd_width;
+  int64_t slm_bytes_per_subslice;
+  bool large_grf_supported;
+  std::vector<int> expected_sub_group_sizes;
+};
+
+class MakeXeDeviceInfoTest : public ::testing::TestWithParam<DeviceInfoCase> {
+};
+
+TEST_P(MakeXeDeviceInfoTest, DescribesTheDevice) {
+  const DeviceInfoCase& c = GetParam();
+  XeDeviceInfo info =
+      MakeXeDeviceInfo(c.arch, c.eu_count, c.eus_per_subslice,
+                       c.threads_per_eu, c.slm_bytes, c.sub_group_sizes);
+  EXPECT_EQ(info.arch, c.arch);
+  EXPECT_EQ(info.eu_count, c.eu_count);
+  EXPECT_EQ(info.subslice_count(), c.subslice_count);
+  EXPECT_EQ(info.eus_per_subslice, c.expected_eus_per_subslice);
+  EXPECT_EQ(info.threads_per_eu, c.expected_threads_per_eu);
+  EXPECT_EQ(info.simd_width, c.simd_width);
+  EXPECT_EQ(info.slm_bytes_per_subslice, c.slm_bytes_per_subslice);
+  EXPECT_EQ(info.large_grf_supported, c.large_grf_supported);
+  EXPECT_EQ(info.sub_group_sizes, c.expected_sub_group_sizes);
+  EXPECT_EQ(info.fp32_lanes_per_subslice(),
+            c.expected_eus_per_subslice * c.simd_width);
+  for (int size : c.expected_sub_group_sizes) {
+    EXPECT_TRUE(info.SupportsSubGroupSize(size)) << size;
+    EXPECT_EQ(info.max_work_items_per_subslice(size),
+              int64_t{c.expected_eus_per_subslice} *
+                  c.expected_threads_per_eu * size);
+  }
+  EXPECT_FALSE(info.SupportsSubGroupSize(64));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Devices, MakeXeDeviceInfoTest,
+    ::testing::Values(
+        // Data Center GPU Max 1550, one stack.
+        DeviceInfoCase{"Max1550", XeArch::kXeHPC, 512, 8, 8, 128 * 1024,
+                       {16, 32}, 64, 8, 8, 16, 128 * 1024, true, {16, 32}},
+        // Data Center GPU Max 1100.
+        DeviceInfoCase{"Max1100", XeArch::kXeHPC, 448, 8, 8, 128 * 1024,
+                       {32, 16}, 56, 8, 8, 16, 128 * 1024, true, {16, 32}},
+        // Arc A770.
+        DeviceInfoCase{"ArcA770", XeArch::kXeHPG, 512, 16, 8, 64 * 1024,
+                       {8, 16, 32}, 32, 16, 8, 8, 64 * 1024, false,
+                       {8, 16, 32}},
+        // Data Center GPU Flex 170.
+        DeviceInfoCase{"Flex170", XeArch::kXeHPG, 512, 16, 8, 64 * 1024,
+                       {32, 8, 16}, 32, 16, 8, 8, 64 * 1024, false,
+                       {8, 16, 32}},
+        // A driver that leaves the per-subslice queries at zero gets the
+        // defaults of the architecture.
+        DeviceInfoCase{"MaxWithoutQueries", XeArch::kXeHPC, 512, 0, 0, 0,
+                       {16}, 64, 8, 8, 16, 128 * 1024, true, {16}},
+        DeviceInfoCase{"ArcWithoutQueries", XeArch::kXeHPG, 512, 0, 0, 0,
+                       {8}, 32, 16, 8, 8, 64 * 1024, false, {8}},
+        // Device queries win over the defaults.
+        DeviceInfoCase{"OverriddenDefaults", XeArch::kXeHPC, 128, 16, 10,
+                       256 * 1024, {16}, 8, 16, 10, 16, 256 * 1024, true,
+                       {16}},
+        // An unknown architecture still gets a usable description.
+        DeviceInfoCase{"Unknown", XeArch::kUnknown, 96, 0, 0, 0, {8, 16}, 12,
+                       8, 7, 8, 64 * 1024, false, {8, 16}}),
+    [](const ::testing::TestParamInfo<DeviceInfoCase>& info) {
+      return info.param.name;
+    });
+
+TEST(XeDeviceInfoTest, NoSubslicesWithoutEusPerSubslice) {
+  XeDeviceInfo info;
+  info.eu_count = 512;
+  EXPECT_EQ(info.subslice_count(), 0);
+}
+
+struct DeviceIdCase {
+  uint32_t device_id;
+  XeArch arch;
+};
+
+class XeArchFromDeviceIdTest : public ::testing::TestWithParam<DeviceIdCase> {
+};
+
+TEST_P(XeArchFromDeviceIdTest, MapsDeviceIds) {
+  EXPECT_EQ(XeArchFromDeviceId(GetParam().device_id), GetParam().arch);
+}
+
+INSTANTIATE_TEST_SUITE_P(DeviceIds, XeArchFromDeviceIdTest,
+                         ::testing::Values(DeviceIdCase{0x0bd5, XeArch::kXeHPC},
+                                           DeviceIdCase{0x0bda, XeArch::kXeHPC},
+                                           DeviceIdCase{0x56a0, XeArch::kXeHPG},
+                                           DeviceIdCase{0x56c0, XeArch::kXeHPG},
+                                           DeviceIdCase{0x9a49,
+                                                        XeArch::kUnknown},
+                                           DeviceIdCase{0, XeArch::kUnknown}));
+
+}  // namespace
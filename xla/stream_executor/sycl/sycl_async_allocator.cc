@@ -0,0 +1,190 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_async_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/platform/logging.h"
+
+namespace stream_executor {
+
+namespace {
+
+// Small blocks are cached in power-of-two size classes, large ones in 2MiB
+// granules, which bounds the per-allocation waste without preallocating.
+constexpr size_t kMinBlockBytes = 512;
+constexpr size_t kSmallBlockLimit = 1 << 20;
+constexpr size_t kLargeBlockGranule = 2 << 20;
+
+}  // namespace
+
+SyclAsyncAllocator::SyclAsyncAllocator(StreamExecutor* executor,
+                                       Stream* stream, size_t memory_limit)
+    : executor_(executor),
+      stream_(stream),
+      memory_limit_(memory_limit),
+      name_(absl::StrCat("sycl_async_", executor->device_ordinal())),
+      backend_(executor),
+      cache_(&backend_, stream) {
+  stats_.bytes_limit = static_cast<int64_t>(memory_limit);
+}
+
+SyclAsyncAllocator::~SyclAsyncAllocator() {
+  absl::MutexLock lock(&mu_);
+  cache_.ProcessPendingFrees(/*wait=*/true);
+  ReleaseFreeBlocks();
+  if (!allocations_.empty()) {
+    LOG(ERROR) << name_ << " destroyed with " << allocations_.size()
+               << " live allocations";
+  }
+}
+
+/* static */ size_t SyclAsyncAllocator::RoundedBytes(size_t num_bytes) {
+  if (num_bytes <= kSmallBlockLimit) {
+    size_t rounded = kMinBlockBytes;
+    while (rounded < num_bytes) rounded <<= 1;
+    return rounded;
+  }
+  return (num_bytes + kLargeBlockGranule - 1) / kLargeBlockGranule *
+         kLargeBlockGranule;
+}
+
+void* SyclAsyncAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0) return nullptr;
+  // Device allocations are 64-byte aligned, which covers
+  // tsl::Allocator::kAllocatorAlignment.
+  DCHECK_LE(alignment, tsl::Allocator::kAllocatorAlignment);
+  size_t rounded_bytes = RoundedBytes(num_bytes);
+
+  absl::MutexLock lock(&mu_);
+  void* ptr = cache_.Take(rounded_bytes);
+
+  if (ptr == nullptr) {
+    auto fits = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return stats_.bytes_reserved + rounded_bytes <= memory_limit_;
+    };
+    if (!fits()) ReleaseFreeBlocks();
+    if (fits()) ptr = executor_->Allocate(rounded_bytes).opaque();
+    if (ptr == nullptr) {
+      // Last resort: wait for every in-flight free and give the whole cache
+      // back to the device before retrying.
+      cache_.ProcessPendingFrees(/*wait=*/true);
+      ReleaseFreeBlocks();
+      if (fits()) ptr = executor_->Allocate(rounded_bytes).opaque();
+    }
+    if (ptr == nullptr) {
+      LOG(WARNING) << name_ << " ran out of memory trying to allocate "
+                   << num_bytes << " bytes; reserved " << stats_.bytes_reserved
+                   << " of " << memory_limit_ << " bytes";
+      return nullptr;
+    }
+    stats_.bytes_reserved += rounded_bytes;
+    stats_.peak_bytes_reserved =
+        std::max(stats_.peak_bytes_reserved, stats_.bytes_reserved);
+  }
+
+  allocations_[ptr] = {num_bytes, rounded_bytes};
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += rounded_bytes;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64_t>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+void SyclAsyncAllocator::DeallocateRaw(void* ptr) {
+  DeallocateRawOnStream(ptr, stream_);
+}
+
+void SyclAsyncAllocator::DeallocateRawOnStream(void* ptr, Stream* stream) {
+  if (ptr == nullptr) return;
+  absl::MutexLock lock(&mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end())
+      << name_ << " asked to free unknown pointer " << ptr;
+  size_t size = it->second.allocated_size;
+  allocations_.erase(it);
+  stats_.bytes_in_use -= size;
+
+  cache_.Free(ptr, size, stream);
+}
+
+size_t SyclAsyncAllocator::RequestedSize(const void* ptr) const {
+  absl::MutexLock lock(&mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end());
+  return it->second.requested_size;
+}
+
+size_t SyclAsyncAllocator::AllocatedSize(const void* ptr) const {
+  absl::MutexLock lock(&mu_);
+  auto it = allocations_.find(ptr);
+  CHECK(it != allocations_.end());
+  return it->second.allocated_size;
+}
+
+std::optional<tsl::AllocatorStats> SyclAsyncAllocator::GetStats() {
+  absl::MutexLock lock(&mu_);
+  tsl::AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = cache_.largest_free_block_bytes();
+  stats.pool_bytes = stats_.bytes_reserved;
+  stats.peak_pool_bytes = stats_.peak_bytes_reserved;
+  return stats;
+}
+
+bool SyclAsyncAllocator::ClearStats() {
+  absl::MutexLock lock(&mu_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+  stats_.peak_bytes_reserved = stats_.bytes_reserved;
+  return true;
+}
+
+void SyclAsyncAllocator::ReleaseFreeBlocks() {
+  stats_.bytes_reserved -= cache_.ReleaseFreeBlocks();
+}
+
+SyclAsyncAllocator::CacheBackend::Event
+SyclAsyncAllocator::CacheBackend::CreateEvent() {
+  auto event = std::make_unique<::stream_executor::Event>(executor_);
+  CHECK(event->Init()) << "Failed to create an event for the async allocator";
+  return event;
+}
+
+bool SyclAsyncAllocator::CacheBackend::IsComplete(Event& event) {
+  return event->PollForStatus() ==
+         ::stream_executor::Event::Status::kComplete;
+}
+
+bool SyclAsyncAllocator::CacheBackend::Synchronize(Stream* stream) {
+  tsl::Status status = stream->BlockHostUntilDone();
+  if (!status.ok()) {
+    LOG(ERROR) << "Async allocator failed to wait for pending frees: "
+               << status;
+  }
+  return status.ok();
+}
+
+void SyclAsyncAllocator::CacheBackend::Free(void* ptr, size_t bytes) {
+  DeviceMemoryBase mem(ptr, bytes);
+  executor_->Deallocate(&mem);
+}
+
+}  // namespace stream_executor
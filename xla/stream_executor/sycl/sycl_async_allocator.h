@@ -0,0 +1,117 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_ASYNC_ALLOCATOR_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_ASYNC_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/framework/allocator.h"
+#include "xla/stream_executor/event.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "xla/stream_executor/sycl/sycl_block_cache.h"
+
+namespace stream_executor {
+
+// A stream-ordered device memory allocator, the SYCL counterpart of
+// GpuCudaMallocAsyncAllocator.
+//
+// Memory is carved from the device on demand and cached in size classes
+// instead of being preallocated. Freed blocks are kept in a
+// sycl::StreamOrderedBlockCache, which orders their reuse after the free.
+class SyclAsyncAllocator : public tsl::Allocator {
+ public:
+  // `stream` is the stream all allocations are ordered on. `memory_limit` caps
+  // the bytes reserved from the device.
+  SyclAsyncAllocator(StreamExecutor* executor, Stream* stream,
+                     size_t memory_limit);
+  ~SyclAsyncAllocator() override;
+
+  std::string Name() override { return name_; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Frees `ptr` once the work currently enqueued on `stream` has completed.
+  void DeallocateRawOnStream(void* ptr, Stream* stream);
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+
+  std::optional<tsl::AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  tsl::AllocatorMemoryType GetMemoryType() const override {
+    return tsl::AllocatorMemoryType::kDevice;
+  }
+
+ private:
+  struct Allocation {
+    size_t requested_size;
+    size_t allocated_size;
+  };
+
+  // Adapts the executor and its streams to StreamOrderedBlockCache.
+  class CacheBackend {
+   public:
+    using Stream = ::stream_executor::Stream;
+    using Event = std::unique_ptr<::stream_executor::Event>;
+
+    explicit CacheBackend(StreamExecutor* executor) : executor_(executor) {}
+
+    Event CreateEvent();
+    void RecordEvent(Stream* stream, Event& event) {
+      stream->ThenRecordEvent(event.get());
+    }
+    void WaitFor(Stream* stream, Event& event) {
+      stream->ThenWaitFor(event.get());
+    }
+    bool IsComplete(Event& event);
+    bool Synchronize(Stream* stream);
+    void Free(void* ptr, size_t bytes);
+
+   private:
+    StreamExecutor* executor_;
+  };
+
+  // Rounds `num_bytes` up to its size class.
+  static size_t RoundedBytes(size_t num_bytes);
+
+  // Returns the cached free blocks to the device.
+  void ReleaseFreeBlocks() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  StreamExecutor* executor_;
+  Stream* stream_;
+  const size_t memory_limit_;
+  std::string name_;
+  CacheBackend backend_;
+
+  mutable absl::Mutex mu_;
+  sycl::StreamOrderedBlockCache<CacheBackend> cache_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<const void*, Allocation> allocations_
+      ABSL_GUARDED_BY(mu_);
+  tsl::AllocatorStats stats_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_ASYNC_ALLOCATOR_H_
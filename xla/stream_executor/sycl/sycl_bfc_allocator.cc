@@ -0,0 +1,256 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_bfc_allocator.h"
+
+#include <iterator>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tsl/platform/logging.h"
+
+namespace stream_executor {
+
+namespace {
+
+tsl::BFCAllocator::Options MakeOptions(bool allow_growth, bool compaction) {
+  tsl::BFCAllocator::Options opts;
+  opts.allow_growth = allow_growth;
+  // Deallocating free regions only helps when new ones can be grown.
+  opts.garbage_collection = compaction && allow_growth;
+  return opts;
+}
+
+int64_t BucketLowerBound(int64_t bytes) {
+  int64_t bucket = 1;
+  while (bucket <= bytes / 2) bucket <<= 1;
+  return bucket;
+}
+
+uintptr_t Address(const void* ptr) { return reinterpret_cast<uintptr_t>(ptr); }
+
+// Forwards to the device sub-allocator and reports the regions it hands out
+// to the tracker.
+class TrackingSubAllocator : public tsl::SubAllocator {
+ public:
+  TrackingSubAllocator(std::unique_ptr<tsl::SubAllocator> wrapped,
+                       std::shared_ptr<FreeChunkTracker> tracker)
+      : tsl::SubAllocator(/*alloc_visitors=*/{}, /*free_visitors=*/{}),
+        wrapped_(std::move(wrapped)),
+        tracker_(std::move(tracker)) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    void* ptr = wrapped_->Alloc(alignment, num_bytes, bytes_received);
+    if (ptr != nullptr) tracker_->AddRegion(ptr, *bytes_received);
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    if (ptr != nullptr) tracker_->RemoveRegion(ptr, num_bytes);
+    wrapped_->Free(ptr, num_bytes);
+  }
+
+  bool SupportsCoalescing() const override {
+    return wrapped_->SupportsCoalescing();
+  }
+
+  tsl::AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+ private:
+  std::unique_ptr<tsl::SubAllocator> wrapped_;
+  std::shared_ptr<FreeChunkTracker> tracker_;
+};
+
+}  // namespace
+
+std::string FragmentationReport::ToString() const {
+  std::string result = absl::StrFormat(
+      "free_bytes=%d free_chunks=%d largest_free_chunk=%d fragmentation=%.3f",
+      free_bytes, free_chunks, largest_free_chunk_bytes, fragmentation());
+  for (const auto& [bucket, count] : free_chunk_histogram) {
+    absl::StrAppend(&result, "\n  [", bucket, ", ", bucket * 2, "): ", count);
+  }
+  return result;
+}
+
+void FreeChunkTracker::InsertFree(Map::const_iterator region, uintptr_t begin,
+                                  uintptr_t end) {
+  auto next = free_chunks_.lower_bound(begin);
+  if (next != free_chunks_.end() && next->first == end &&
+      next->second <= region->second) {
+    end = next->second;
+    EraseFree(next++);
+  }
+  if (next != free_chunks_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->second == begin && prev->first >= region->first) {
+      begin = prev->first;
+      EraseFree(prev);
+    }
+  }
+  AddFree(begin, end);
+}
+
+void FreeChunkTracker::AddFree(uintptr_t begin, uintptr_t end) {
+  free_chunks_.emplace(begin, end);
+  free_sizes_.insert(end - begin);
+  free_bytes_ += end - begin;
+}
+
+void FreeChunkTracker::EraseFree(Map::iterator chunk) {
+  const int64_t size = chunk->second - chunk->first;
+  free_sizes_.erase(free_sizes_.find(size));
+  free_bytes_ -= size;
+  free_chunks_.erase(chunk);
+}
+
+void FreeChunkTracker::AddRegion(void* ptr, size_t bytes) {
+  if (bytes == 0) return;
+  const uintptr_t begin = Address(ptr);
+  absl::MutexLock lock(&mu_);
+  auto region = regions_.end();
+  if (coalesce_regions_) {
+    auto next = regions_.lower_bound(begin);
+    if (next != regions_.begin() && std::prev(next)->second == begin)
+      region = std::prev(next);
+  }
+  if (region == regions_.end()) {
+    region = regions_.emplace(begin, begin + bytes).first;
+  } else {
+    region->second = begin + bytes;
+  }
+  InsertFree(region, begin, begin + bytes);
+}
+
+void FreeChunkTracker::RemoveRegion(void* ptr, size_t bytes) {
+  const uintptr_t begin = Address(ptr);
+  absl::MutexLock lock(&mu_);
+  // The BFC allocator only returns regions without allocations.
+  auto chunk = free_chunks_.find(begin);
+  DCHECK(chunk != free_chunks_.end() && chunk->second == begin + bytes);
+  if (chunk != free_chunks_.end()) EraseFree(chunk);
+  regions_.erase(begin);
+}
+
+void FreeChunkTracker::Allocate(void* ptr, size_t bytes) {
+  if (bytes == 0) return;
+  const uintptr_t begin = Address(ptr);
+  const uintptr_t end = begin + bytes;
+  absl::MutexLock lock(&mu_);
+  auto chunk = free_chunks_.upper_bound(begin);
+  if (chunk == free_chunks_.begin()) return;
+  --chunk;
+  DCHECK_LE(end, chunk->second) << "Allocation is not in a free chunk";
+  if (end > chunk->second) return;
+  const uintptr_t chunk_begin = chunk->first;
+  const uintptr_t chunk_end = chunk->second;
+  EraseFree(chunk);
+  // Free chunks are maximal, so the remainders have no free neighbours.
+  if (chunk_begin < begin) AddFree(chunk_begin, begin);
+  if (end < chunk_end) AddFree(end, chunk_end);
+}
+
+void FreeChunkTracker::Deallocate(void* ptr, size_t bytes) {
+  if (bytes == 0) return;
+  const uintptr_t begin = Address(ptr);
+  absl::MutexLock lock(&mu_);
+  auto region = regions_.upper_bound(begin);
+  if (region == regions_.begin()) return;
+  --region;
+  DCHECK_LE(begin + bytes, region->second) << "Chunk is not in a region";
+  InsertFree(region, begin, begin + bytes);
+}
+
+int64_t FreeChunkTracker::largest_free_chunk_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return free_sizes_.empty() ? 0 : *free_sizes_.rbegin();
+}
+
+FragmentationReport FreeChunkTracker::Report() const {
+  FragmentationReport report;
+  absl::MutexLock lock(&mu_);
+  report.free_bytes = free_bytes_;
+  report.free_chunks = free_sizes_.size();
+  if (!free_sizes_.empty())
+    report.largest_free_chunk_bytes = *free_sizes_.rbegin();
+  for (int64_t size : free_sizes_)
+    ++report.free_chunk_histogram[BucketLowerBound(size)];
+  return report;
+}
+
+SyclBFCAllocator::TrackedSubAllocator SyclBFCAllocator::Track(
+    std::unique_ptr<tsl::SubAllocator> sub_allocator) {
+  auto tracker =
+      std::make_shared<FreeChunkTracker>(sub_allocator->SupportsCoalescing());
+  return {std::make_unique<TrackingSubAllocator>(std::move(sub_allocator),
+                                                 tracker),
+          tracker};
+}
+
+SyclBFCAllocator::SyclBFCAllocator(
+    std::unique_ptr<tsl::SubAllocator> sub_allocator, size_t total_memory,
+    const std::string& name, bool allow_growth, bool compaction)
+    : SyclBFCAllocator(Track(std::move(sub_allocator)), total_memory, name,
+                       allow_growth, compaction) {}
+
+SyclBFCAllocator::SyclBFCAllocator(TrackedSubAllocator tracked,
+                                   size_t total_memory,
+                                   const std::string& name, bool allow_growth,
+                                   bool compaction)
+    : tsl::BFCAllocator(std::move(tracked.sub_allocator), total_memory, name,
+                        MakeOptions(allow_growth, compaction)),
+      tracker_(std::move(tracked.tracker)) {
+  if (compaction && !allow_growth) {
+    LOG(WARNING) << name
+                 << ": compaction has no effect on a preallocated allocator";
+  }
+}
+
+void* SyclBFCAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const tsl::AllocationAttributes& allocation_attr) {
+  void* ptr =
+      tsl::BFCAllocator::AllocateRaw(alignment, num_bytes, allocation_attr);
+  // The chunk stays allocated until it is deallocated through this class, so
+  // the tracker cannot see it freed before it is allocated.
+  if (ptr != nullptr) tracker_->Allocate(ptr, AllocatedSize(ptr));
+  return ptr;
+}
+
+void SyclBFCAllocator::DeallocateRaw(void* ptr) {
+  // Marked free before the BFC allocator can hand the chunk out again.
+  if (ptr != nullptr) tracker_->Deallocate(ptr, AllocatedSize(ptr));
+  tsl::BFCAllocator::DeallocateRaw(ptr);
+}
+
+std::optional<tsl::AllocatorStats> SyclBFCAllocator::GetStats() {
+  std::optional<tsl::AllocatorStats> stats = tsl::BFCAllocator::GetStats();
+  if (!stats) return stats;
+  stats->largest_free_block_bytes = tracker_->largest_free_chunk_bytes();
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << Name() << " fragmentation: " << tracker_->Report().ToString();
+  }
+  return stats;
+}
+
+FragmentationReport SyclBFCAllocator::GetFragmentationReport() {
+  return tracker_->Report();
+}
+
+}  // namespace stream_executor
@@ -0,0 +1,132 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_BFC_ALLOCATOR_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_BFC_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+
+#include "absl/synchronization/mutex.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/framework/bfc_allocator.h"
+
+namespace stream_executor {
+
+// Summary of the free chunks of a BFC allocator.
+struct FragmentationReport {
+  int64_t free_bytes = 0;
+  int64_t free_chunks = 0;
+  int64_t largest_free_chunk_bytes = 0;
+  // Number of free chunks per power-of-two size bucket, keyed by the bucket's
+  // lower bound in bytes.
+  std::map<int64_t, int64_t> free_chunk_histogram;
+
+  // 0 when all free memory is one chunk, approaching 1 as it gets scattered.
+  double fragmentation() const {
+    return free_bytes == 0
+               ? 0.0
+               : 1.0 - static_cast<double>(largest_free_chunk_bytes) /
+                           free_bytes;
+  }
+
+  std::string ToString() const;
+};
+
+// Free chunks of a BFC allocator, kept up to date from its region and chunk
+// events so that reports never walk the allocator's chunk list. A chunk is
+// free if it lies in a region and no allocation covers it; adjacent free
+// chunks of one region are merged, as in the BFC allocator. Regions returned
+// by a coalescing sub-allocator extend the region they directly follow.
+class FreeChunkTracker {
+ public:
+  explicit FreeChunkTracker(bool coalesce_regions)
+      : coalesce_regions_(coalesce_regions) {}
+
+  void AddRegion(void* ptr, size_t bytes);
+  void RemoveRegion(void* ptr, size_t bytes);
+  void Allocate(void* ptr, size_t bytes);
+  void Deallocate(void* ptr, size_t bytes);
+
+  int64_t largest_free_chunk_bytes() const;
+  FragmentationReport Report() const;
+
+ private:
+  using Map = std::map<uintptr_t, uintptr_t>;
+
+  // Frees [begin, end) of `region`, merging it with free neighbours.
+  void InsertFree(Map::const_iterator region, uintptr_t begin, uintptr_t end)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void AddFree(uintptr_t begin, uintptr_t end)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void EraseFree(Map::iterator chunk) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const bool coalesce_regions_;
+  mutable absl::Mutex mu_;
+  // Start to end address of each region and of each free chunk.
+  Map regions_ ABSL_GUARDED_BY(mu_);
+  Map free_chunks_ ABSL_GUARDED_BY(mu_);
+  std::multiset<int64_t> free_sizes_ ABSL_GUARDED_BY(mu_);
+  int64_t free_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// BFC allocator for XPU devices that reports its fragmentation.
+//
+// GetStats() fills `largest_free_block_bytes` from a FreeChunkTracker, which
+// PJRT_Device_MemoryStats exposes. With `compaction` enabled, regions that
+// become completely free are returned to the device when an allocation would
+// otherwise fail, so a fragmented allocator can grow a fresh contiguous region
+// instead of running out of memory.
+class SyclBFCAllocator : public tsl::BFCAllocator {
+ public:
+  SyclBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
+                   size_t total_memory, const std::string& name,
+                   bool allow_growth, bool compaction);
+
+  using tsl::BFCAllocator::AllocateRaw;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const tsl::AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  std::optional<tsl::AllocatorStats> GetStats() override;
+
+  FragmentationReport GetFragmentationReport();
+
+ private:
+  // A sub-allocator wrapped to report its regions to `tracker`.
+  struct TrackedSubAllocator {
+    std::unique_ptr<tsl::SubAllocator> sub_allocator;
+    std::shared_ptr<FreeChunkTracker> tracker;
+  };
+  static TrackedSubAllocator Track(
+      std::unique_ptr<tsl::SubAllocator> sub_allocator);
+
+  SyclBFCAllocator(TrackedSubAllocator tracked, size_t total_memory,
+                   const std::string& name, bool allow_growth,
+                   bool compaction);
+
+  // Shared with the sub-allocator wrapper, which the base class destroys
+  // after this class's members.
+  std::shared_ptr<FreeChunkTracker> tracker_;
+};
+
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_BFC_ALLOCATOR_H_
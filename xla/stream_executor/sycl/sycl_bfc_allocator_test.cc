@@ -0,0 +1,245 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_bfc_allocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/platform/test.h"
+#include "tsl/protobuf/bfc_memory_map.pb.h"
+
+namespace stream_executor {
+namespace {
+
+constexpr size_t kMiB = 1 << 20;
+
+// Hands out host memory, so the allocator runs without a device.
+class HostSubAllocator : public tsl::SubAllocator {
+ public:
+  explicit HostSubAllocator(bool coalescing, int* live_regions)
+      : tsl::SubAllocator({}, {}),
+        coalescing_(coalescing),
+        live_regions_(live_regions) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    alignment = std::max<size_t>(alignment, 256);
+    void* ptr = std::aligned_alloc(
+        alignment, (num_bytes + alignment - 1) / alignment * alignment);
+    *bytes_received = ptr == nullptr ? 0 : num_bytes;
+    if (ptr != nullptr) ++*live_regions_;
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    if (ptr != nullptr) --*live_regions_;
+    std::free(ptr);
+  }
+
+  bool SupportsCoalescing() const override { return coalescing_; }
+
+ private:
+  bool coalescing_;
+  int* live_regions_;
+};
+
+// The report the allocator computed before it tracked free chunks itself.
+FragmentationReport ReportFromMemoryMap(SyclBFCAllocator& allocator) {
+  FragmentationReport report;
+  tensorflow::MemoryDump dump = allocator.RecordMemoryMap();
+  for (const auto& chunk : dump.chunk()) {
+    if (chunk.in_use()) continue;
+    const int64_t size = chunk.size();
+    report.free_bytes += size;
+    ++report.free_chunks;
+    report.largest_free_chunk_bytes =
+        std::max(report.largest_free_chunk_bytes, size);
+    int64_t bucket = 1;
+    while (bucket <= size / 2) bucket <<= 1;
+    ++report.free_chunk_histogram[bucket];
+  }
+  return report;
+}
+
+void ExpectSameReport(const FragmentationReport& actual,
+                      const FragmentationReport& expected) {
+  EXPECT_EQ(actual.free_bytes, expected.free_bytes);
+  EXPECT_EQ(actual.free_chunks, expected.free_chunks);
+  EXPECT_EQ(actual.largest_free_chunk_bytes,
+            expected.largest_free_chunk_bytes);
+  EXPECT_EQ(actual.free_chunk_histogram, expected.free_chunk_histogram);
+}
+
+struct AllocatorParams {
+  bool allow_growth;
+  bool compaction;
+  bool coalescing;
+};
+
+class SyclBFCAllocatorTest : public ::testing::TestWithParam<AllocatorParams> {
+ protected:
+  std::unique_ptr<SyclBFCAllocator> MakeAllocator(size_t total_memory) {
+    const AllocatorParams& params = GetParam();
+    return std::make_unique<SyclBFCAllocator>(
+        std::make_unique<HostSubAllocator>(params.coalescing, &live_regions_),
+        total_memory, "host_bfc", params.allow_growth, params.compaction);
+  }
+
+  int live_regions_ = 0;
+};
+
+TEST_P(SyclBFCAllocatorTest, TracksFreeChunksLikeTheMemoryMap) {
+  auto allocator = MakeAllocator(16 * kMiB);
+  tsl::AllocationAttributes no_retry;
+  no_retry.retry_on_failure = false;
+
+  std::mt19937 rng(42);
+  std::vector<void*> live;
+  for (int step = 0; step < 2000; ++step) {
+    if (live.empty() || rng() % 3 != 0) {
+      // Mostly small buffers with an occasional large one, so that regions
+      // grow and fill up.
+      size_t bytes = rng() % 8 == 0 ? (rng() % (2 * kMiB)) + 1
+                                    : (rng() % (64 << 10)) + 1;
+      void* ptr = allocator->AllocateRaw(256, bytes, no_retry);
+      if (ptr != nullptr) live.push_back(ptr);
+    } else {
+      std::swap(live[rng() % live.size()], live.back());
+      allocator->DeallocateRaw(live.back());
+      live.pop_back();
+    }
+    SCOPED_TRACE(absl::StrCat("step ", step));
+    ExpectSameReport(allocator->GetFragmentationReport(),
+                     ReportFromMemoryMap(*allocator));
+    if (HasFailure()) return;
+  }
+  for (void* ptr : live) allocator->DeallocateRaw(ptr);
+  ExpectSameReport(allocator->GetFragmentationReport(),
+                   ReportFromMemoryMap(*allocator));
+}
+
+TEST_P(SyclBFCAllocatorTest, StatsReportLargestFreeChunk) {
+  auto allocator = MakeAllocator(4 * kMiB);
+  std::optional<tsl::AllocatorStats> stats = allocator->GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->largest_free_block_bytes, 0);
+
+  // Free every other buffer, leaving holes between the remaining ones.
+  std::vector<void*> buffers;
+  for (int i = 0; i < 16; ++i)
+    buffers.push_back(allocator->AllocateRaw(256, 64 << 10));
+  for (int i = 0; i < 16; i += 2) allocator->DeallocateRaw(buffers[i]);
+
+  stats = allocator->GetStats();
+  ASSERT_TRUE(stats.has_value());
+  FragmentationReport expected = ReportFromMemoryMap(*allocator);
+  EXPECT_EQ(stats->largest_free_block_bytes,
+            expected.largest_free_chunk_bytes);
+  FragmentationReport report = allocator->GetFragmentationReport();
+  EXPECT_GT(report.free_chunks, 1);
+  EXPECT_GT(report.fragmentation(), 0.0);
+
+  for (int i = 1; i < 16; i += 2) allocator->DeallocateRaw(buffers[i]);
+  report = allocator->GetFragmentationReport();
+  ExpectSameReport(report, ReportFromMemoryMap(*allocator));
+}
+
+TEST_P(SyclBFCAllocatorTest, RegionsAreReturnedToTheSubAllocator) {
+  {
+    auto allocator = MakeAllocator(4 * kMiB);
+    void* ptr = allocator->AllocateRaw(256, kMiB);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_GT(live_regions_, 0);
+    allocator->DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(live_regions_, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Options, SyclBFCAllocatorTest,
+    ::testing::Values(AllocatorParams{false, false, false},
+                      AllocatorParams{true, false, false},
+                      AllocatorParams{true, true, false},
+                      AllocatorParams{true, false, true},
+                      AllocatorParams{true, true, true}),
+    [](const ::testing::TestParamInfo<AllocatorParams>& info) {
+      return absl::StrCat(info.param.allow_growth ? "Growth" : "Preallocated",
+                          info.param.compaction ? "Compaction" : "",
+                          info.param.coalescing ? "Coalescing" : "");
+    });
+
+TEST(FreeChunkTrackerTest, MergesOnlyWithinRegions) {
+  alignas(256) static char memory[4096];
+  FreeChunkTracker tracker(/*coalesce_regions=*/false);
+  // Two regions that happen to be adjacent in memory.
+  tracker.AddRegion(memory, 2048);
+  tracker.AddRegion(memory + 2048, 2048);
+  EXPECT_EQ(tracker.Report().free_chunks, 2);
+  EXPECT_EQ(tracker.largest_free_chunk_bytes(), 2048);
+
+  tracker.Allocate(memory, 1024);
+  tracker.Allocate(memory + 3072, 1024);
+  FragmentationReport report = tracker.Report();
+  EXPECT_EQ(report.free_bytes, 2048);
+  EXPECT_EQ(report.free_chunks, 2);
+
+  tracker.Deallocate(memory, 1024);
+  tracker.Deallocate(memory + 3072, 1024);
+  report = tracker.Report();
+  EXPECT_EQ(report.free_chunks, 2);
+  EXPECT_EQ(report.largest_free_chunk_bytes, 2048);
+
+  tracker.RemoveRegion(memory + 2048, 2048);
+  EXPECT_EQ(tracker.Report().free_bytes, 2048);
+}
+
+TEST(FreeChunkTrackerTest, CoalescedRegionsMergeFreeChunks) {
+  alignas(256) static char memory[4096];
+  FreeChunkTracker tracker(/*coalesce_regions=*/true);
+  tracker.AddRegion(memory, 2048);
+  tracker.Allocate(memory, 1024);
+  tracker.AddRegion(memory + 2048, 2048);
+  FragmentationReport report = tracker.Report();
+  EXPECT_EQ(report.free_chunks, 1);
+  EXPECT_EQ(report.largest_free_chunk_bytes, 3072);
+
+  tracker.Deallocate(memory, 1024);
+  EXPECT_EQ(tracker.largest_free_chunk_bytes(), 4096);
+}
+
+TEST(FreeChunkTrackerTest, HistogramUsesPowerOfTwoBuckets) {
+  alignas(256) static char memory[4096];
+  FreeChunkTracker tracker(/*coalesce_regions=*/false);
+  tracker.AddRegion(memory, 4096);
+  tracker.Allocate(memory + 256, 256);
+  tracker.Allocate(memory + 1024, 256);
+  // Free chunks of 256, 512 and 2816 bytes.
+  FragmentationReport report = tracker.Report();
+  EXPECT_EQ(report.free_chunk_histogram,
+            (std::map<int64_t, int64_t>{{256, 1}, {512, 1}, {2048, 1}}));
+  EXPECT_EQ(report.largest_free_chunk_bytes, 2816);
+}
+
+}  // namespace
+}  // namespace stream_executor
@@ -0,0 +1,156 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_BLOCK_CACHE_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_BLOCK_CACHE_H_
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+
+namespace stream_executor {
+namespace sycl {
+
+// The cache of freed device blocks behind SyclAsyncAllocator. Every block is
+// freed on a stream and tagged with an event recorded there:
+//  - the owner stream, which all allocations are ordered on, reuses a block
+//    freed on itself right away, since it is in-order;
+//  - it reuses a block freed on another stream only after waiting on the
+//    event of the free;
+//  - a block goes back to the device only once its event has completed.
+//
+// `Backend` provides the stream and event types and
+//   Event CreateEvent();
+//   void RecordEvent(Stream* stream, Event& event);
+//   void WaitFor(Stream* stream, Event& event);
+//   bool IsComplete(Event& event);
+//   bool Synchronize(Stream* stream);
+//   void Free(void* ptr, size_t bytes);
+// Templated so that the stream ordering can be tested on the host. Not
+// thread-safe; the allocator serializes all calls.
+template <typename Backend>
+class StreamOrderedBlockCache {
+ public:
+  using Stream = typename Backend::Stream;
+  using Event = typename Backend::Event;
+
+  StreamOrderedBlockCache(Backend* backend, Stream* owner)
+      : backend_(backend), owner_(owner) {}
+
+  // Takes a block of exactly `bytes` that the owner stream may use from now
+  // on, or returns nullptr if none is cached.
+  void* Take(size_t bytes) {
+    ProcessPendingFrees(/*wait=*/false);
+    auto block = free_blocks_.find(bytes);
+    if (block != free_blocks_.end()) {
+      void* ptr = block->second;
+      free_blocks_.erase(block);
+      return ptr;
+    }
+    // Reuse a block whose free is still in flight. Blocks freed on the owner
+    // are already ordered before any work enqueued from now on; blocks freed
+    // on another stream are ordered through their event.
+    for (auto it = pending_frees_.begin(); it != pending_frees_.end(); ++it) {
+      if (it->bytes != bytes) continue;
+      if (it->stream != owner_) backend_->WaitFor(owner_, it->event);
+      void* ptr = it->ptr;
+      event_pool_.push_back(std::move(it->event));
+      pending_frees_.erase(it);
+      return ptr;
+    }
+    return nullptr;
+  }
+
+  // Caches `ptr` once the work currently enqueued on `stream` has completed.
+  void Free(void* ptr, size_t bytes, Stream* stream) {
+    Event event = GetEvent();
+    backend_->RecordEvent(stream, event);
+    pending_frees_.push_back({ptr, bytes, stream, std::move(event)});
+  }
+
+  // Moves pending frees whose event has completed to the free list. If `wait`
+  // is true, first blocks until every pending free has completed. Returns
+  // false if waiting for a stream failed.
+  bool ProcessPendingFrees(bool wait) {
+    if (wait) {
+      absl::flat_hash_set<Stream*> streams;
+      for (const PendingFree& pending : pending_frees_) {
+        streams.insert(pending.stream);
+      }
+      for (Stream* stream : streams) {
+        if (!backend_->Synchronize(stream)) return false;
+      }
+    }
+    for (auto it = pending_frees_.begin(); it != pending_frees_.end();) {
+      if (!wait && !backend_->IsComplete(it->event)) {
+        ++it;
+        continue;
+      }
+      free_blocks_.emplace(it->bytes, it->ptr);
+      event_pool_.push_back(std::move(it->event));
+      it = pending_frees_.erase(it);
+    }
+    return true;
+  }
+
+  // Returns the blocks whose free has completed to the device, and the number
+  // of bytes released.
+  size_t ReleaseFreeBlocks() {
+    size_t released = 0;
+    for (auto& [bytes, ptr] : free_blocks_) {
+      backend_->Free(ptr, bytes);
+      released += bytes;
+    }
+    free_blocks_.clear();
+    return released;
+  }
+
+  size_t largest_free_block_bytes() const {
+    return free_blocks_.empty() ? 0 : free_blocks_.rbegin()->first;
+  }
+
+  size_t num_pending_frees() const { return pending_frees_.size(); }
+
+ private:
+  struct PendingFree {
+    void* ptr;
+    size_t bytes;
+    Stream* stream;
+    Event event;
+  };
+
+  Event GetEvent() {
+    if (event_pool_.empty()) return backend_->CreateEvent();
+    Event event = std::move(event_pool_.back());
+    event_pool_.pop_back();
+    return event;
+  }
+
+  Backend* backend_;
+  Stream* owner_;
+  // Size to block.
+  std::multimap<size_t, void*> free_blocks_;
+  std::deque<PendingFree> pending_frees_;
+  std::vector<Event> event_pool_;
+};
+
+}  // namespace sycl
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_BLOCK_CACHE_H_
@@ -0,0 +1,177 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_block_cache.h"
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace stream_executor {
+namespace sycl {
+namespace {
+
+// A stream completes its work only when the test says so.
+struct FakeStream {
+  // Events recorded on the stream that have not completed yet.
+  std::vector<std::shared_ptr<bool>> recorded;
+  // Events the stream was made to wait on.
+  std::vector<std::shared_ptr<bool>> waited_for;
+
+  void Complete() {
+    for (auto& done : recorded) *done = true;
+    recorded.clear();
+  }
+};
+
+struct FakeEvent {
+  int id;
+  std::shared_ptr<bool> done;
+};
+
+class FakeBackend {
+ public:
+  using Stream = FakeStream;
+  using Event = FakeEvent;
+
+  FakeEvent CreateEvent() {
+    return {events_created++, std::make_shared<bool>(false)};
+  }
+  void RecordEvent(FakeStream* stream, FakeEvent& event) {
+    *event.done = false;
+    stream->recorded.push_back(event.done);
+  }
+  void WaitFor(FakeStream* stream, FakeEvent& event) {
+    stream->waited_for.push_back(event.done);
+  }
+  bool IsComplete(FakeEvent& event) { return *event.done; }
+  bool Synchronize(FakeStream* stream) {
+    ++synchronized;
+    if (fail_synchronize) return false;
+    stream->Complete();
+    return true;
+  }
+  void Free(void* ptr, size_t bytes) { freed.insert(ptr); }
+
+  int events_created = 0;
+  int synchronized = 0;
+  bool fail_synchronize = false;
+  std::set<void*> freed;
+};
+
+using TestCache = StreamOrderedBlockCache<FakeBackend>;
+
+class StreamOrderedBlockCacheTest : public ::testing::Test {
+ protected:
+  void* Block(int i) { return &blocks_[i]; }
+
+  FakeBackend backend_;
+  FakeStream owner_, other_;
+  TestCache cache_{&backend_, &owner_};
+  char blocks_[8];
+};
+
+TEST_F(StreamOrderedBlockCacheTest, OwnerReusesItsOwnFreeRightAway) {
+  cache_.Free(Block(0), 1024, &owner_);
+  // The free is still in flight, but the owner stream is in-order.
+  EXPECT_EQ(cache_.Take(1024), Block(0));
+  EXPECT_TRUE(owner_.waited_for.empty());
+  EXPECT_EQ(cache_.num_pending_frees(), 0);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, CrossStreamReuseWaitsOnTheFree) {
+  cache_.Free(Block(0), 1024, &other_);
+  ASSERT_EQ(other_.recorded.size(), 1);
+  std::shared_ptr<bool> free_event = other_.recorded.front();
+
+  EXPECT_EQ(cache_.Take(1024), Block(0));
+  // The owner must not touch the block before the other stream is done.
+  ASSERT_EQ(owner_.waited_for.size(), 1);
+  EXPECT_EQ(owner_.waited_for.front(), free_event);
+  EXPECT_FALSE(*free_event);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, CompletedCrossStreamFreeNeedsNoWait) {
+  cache_.Free(Block(0), 1024, &other_);
+  other_.Complete();
+  EXPECT_EQ(cache_.Take(1024), Block(0));
+  EXPECT_TRUE(owner_.waited_for.empty());
+}
+
+TEST_F(StreamOrderedBlockCacheTest, ReusesOnlyTheSameSizeClass) {
+  cache_.Free(Block(0), 1024, &other_);
+  EXPECT_EQ(cache_.Take(2048), nullptr);
+  EXPECT_EQ(cache_.Take(512), nullptr);
+  EXPECT_TRUE(owner_.waited_for.empty());
+  EXPECT_EQ(cache_.num_pending_frees(), 1);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, PrefersCompletedFreesOverPendingOnes) {
+  cache_.Free(Block(0), 1024, &other_);
+  cache_.Free(Block(1), 1024, &owner_);
+  owner_.Complete();
+  // Block 1 is free on every stream, so taking it needs no wait.
+  EXPECT_EQ(cache_.Take(1024), Block(1));
+  EXPECT_TRUE(owner_.waited_for.empty());
+  EXPECT_EQ(cache_.Take(1024), Block(0));
+  EXPECT_EQ(owner_.waited_for.size(), 1);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, ReleasesOnlyCompletedFrees) {
+  cache_.Free(Block(0), 1024, &owner_);
+  cache_.Free(Block(1), 4096, &other_);
+  EXPECT_EQ(cache_.ReleaseFreeBlocks(), 0);
+
+  other_.Complete();
+  cache_.ProcessPendingFrees(/*wait=*/false);
+  EXPECT_EQ(cache_.largest_free_block_bytes(), 4096);
+  EXPECT_EQ(cache_.ReleaseFreeBlocks(), 4096);
+  EXPECT_EQ(backend_.freed, std::set<void*>{Block(1)});
+  EXPECT_EQ(cache_.largest_free_block_bytes(), 0);
+  EXPECT_EQ(cache_.num_pending_frees(), 1);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, WaitSynchronizesEveryFreeingStreamOnce) {
+  cache_.Free(Block(0), 1024, &owner_);
+  cache_.Free(Block(1), 1024, &other_);
+  cache_.Free(Block(2), 2048, &other_);
+  EXPECT_TRUE(cache_.ProcessPendingFrees(/*wait=*/true));
+  EXPECT_EQ(backend_.synchronized, 2);
+  EXPECT_EQ(cache_.num_pending_frees(), 0);
+  EXPECT_EQ(cache_.ReleaseFreeBlocks(), 4096);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, FailedWaitKeepsFreesPending) {
+  cache_.Free(Block(0), 1024, &other_);
+  backend_.fail_synchronize = true;
+  EXPECT_FALSE(cache_.ProcessPendingFrees(/*wait=*/true));
+  EXPECT_EQ(cache_.num_pending_frees(), 1);
+  EXPECT_EQ(cache_.ReleaseFreeBlocks(), 0);
+}
+
+TEST_F(StreamOrderedBlockCacheTest, RecyclesEvents) {
+  for (int i = 0; i < 10; ++i) {
+    cache_.Free(Block(0), 1024, i % 2 == 0 ? &owner_ : &other_);
+    EXPECT_EQ(cache_.Take(1024), Block(0));
+  }
+  EXPECT_EQ(backend_.events_created, 1);
+}
+
+}  // namespace
+}  // namespace sycl
+}  // namespace stream_executor
@@ -0,0 +1,101 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_constant_batcher.h"
+
+#include <cstring>
+
+#include "absl/strings/str_format.h"
+#include "xla/stream_executor/gpu/gpu_stream.h"
+#include "xla/stream_executor/stream_executor_pimpl.h"
+#include "xla/stream_executor/sycl/sycl_constant_cache.h"
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+
+namespace stream_executor {
+namespace gpu {
+
+namespace {
+
+using ::stream_executor::sycl::ConstantSlot;
+
+struct SyclConstantBackend {
+  using Stream = ::stream_executor::Stream;
+  using Device = StreamExecutor;
+
+  static StreamExecutor* GetDevice(Stream* stream) { return stream->parent(); }
+  static DeviceMemoryBase Allocate(StreamExecutor* executor, uint64_t bytes) {
+    return executor->AllocateArray<uint8_t>(bytes);
+  }
+  static void Deallocate(StreamExecutor* executor, DeviceMemoryBase* memory) {
+    executor->Deallocate(memory);
+  }
+
+  static tsl::Status Upload(Stream* stream, DeviceMemoryBase* arena,
+                            absl::Span<const ConstantSlot> slots) {
+    const ConstantSlot& last = slots.back();
+    uint64_t bytes = last.offset + last.content->size();
+    // Stage several constants in pinned host memory so that they are uploaded
+    // by one direct transfer. A single constant is copied straight from its
+    // host buffer, as GpuExecutor::CreateOrShareConstant did, since staging
+    // would only add a host copy. Without pinned memory every constant is
+    // copied from its pageable host buffer instead.
+    ::sycl::queue* queue = AsGpuStreamValue(stream);
+    void* staging = nullptr;
+    if (slots.size() > 1) {
+      staging = ::sycl::malloc_host(bytes, queue->get_context());
+    }
+    if (staging != nullptr) {
+      for (const ConstantSlot& slot : slots) {
+        std::memcpy(static_cast<char*>(staging) + slot.offset,
+                    slot.content->data(), slot.content->size());
+      }
+      stream->ThenMemcpy(arena, staging, bytes);
+    } else {
+      for (const ConstantSlot& slot : slots) {
+        void* opaque = static_cast<char*>(arena->opaque()) + slot.offset;
+        DeviceMemoryBase dst(opaque, slot.content->size());
+        stream->ThenMemcpy(&dst, slot.content->data(), slot.content->size());
+      }
+    }
+    // Constants shared through the cache may be consumed from other streams,
+    // and the staging buffer may only be freed once the copy is done.
+    // Constants are uploaded once per executable load, so waiting here is
+    // cheap.
+    tsl::Status status = stream->BlockHostUntilDone();
+    if (staging != nullptr) ::sycl::free(staging, queue->get_context());
+    if (!status.ok() || !stream->ok()) {
+      return tsl::Status(
+          absl::StatusCode::kInternal,
+          absl::StrFormat("Memcpy of %d bytes to constant arena %p failed",
+                          bytes, arena->opaque()));
+    }
+    VLOG(2) << "Uploaded " << slots.size() << " constants of " << bytes
+            << " bytes to arena " << arena->opaque();
+    return tsl::OkStatus();
+  }
+};
+
+}  // namespace
+
+tsl::StatusOr<std::vector<std::shared_ptr<DeviceMemoryBase>>>
+CreateOrShareConstants(Stream* stream,
+                       absl::Span<const std::vector<uint8_t>* const> contents) {
+  static auto* cache =
+      new ::stream_executor::sycl::ConstantCache<SyclConstantBackend>();
+  return cache->CreateOrShare(stream, contents);
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
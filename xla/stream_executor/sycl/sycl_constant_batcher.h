@@ -0,0 +1,48 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_BATCHER_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_BATCHER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tsl/platform/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/stream.h"
+
+namespace stream_executor {
+namespace gpu {
+
+// Uploads the constants of an executable in one batch: contents that are not
+// already resident on the device of `stream` are coalesced into a single
+// pinned host staging buffer, sub-allocated from one device arena and copied
+// with a single transfer. The call waits for the transfer to complete, holding
+// a lock of that device only. Constants are deduplicated by fingerprint, both
+// within `contents` and across executables sharing the same executor.
+//
+// Returns one device buffer per entry of `contents`, in order. The arena is
+// released once the last constant carved from it is destroyed, so the executor
+// must outlive all returned buffers.
+tsl::StatusOr<std::vector<std::shared_ptr<DeviceMemoryBase>>>
+CreateOrShareConstants(Stream* stream,
+                       absl::Span<const std::vector<uint8_t>* const> contents);
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_BATCHER_H_
@@ -0,0 +1,142 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_constant_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "xla/stream_executor/multi_platform_manager.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor_pimpl.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace stream_executor {
+namespace gpu {
+namespace {
+
+// Returns a stream on the first SYCL device, or nullptr without one.
+Stream* GetStream() {
+  static Stream* stream = []() -> Stream* {
+    auto platform = MultiPlatformManager::PlatformWithName("SYCL");
+    if (!platform.ok() || (*platform)->VisibleDeviceCount() == 0) {
+      return nullptr;
+    }
+    auto executor = (*platform)->ExecutorForDevice(0);
+    if (!executor.ok()) return nullptr;
+    auto* stream = new Stream(*executor);
+    stream->Init();
+    return stream;
+  }();
+  return stream;
+}
+
+// `count` distinct constants of `bytes` each; `seed` makes them distinct
+// from those of other calls.
+std::vector<std::vector<uint8_t>> MakeContents(int count, size_t bytes,
+                                               int seed) {
+  std::vector<std::vector<uint8_t>> contents(count);
+  for (int i = 0; i < count; ++i) {
+    contents[i].resize(bytes);
+    for (size_t j = 0; j < bytes; ++j) contents[i][j] = (i * 31 + j) % 251;
+    std::memcpy(contents[i].data(), &seed, std::min(bytes, sizeof(seed)));
+    if (bytes > sizeof(seed)) {
+      std::memcpy(contents[i].data() + sizeof(seed), &i,
+                  std::min(bytes - sizeof(seed), sizeof(i)));
+    }
+  }
+  return contents;
+}
+
+std::vector<const std::vector<uint8_t>*> Pointers(
+    const std::vector<std::vector<uint8_t>>& contents) {
+  std::vector<const std::vector<uint8_t>*> pointers;
+  for (const auto& content : contents) pointers.push_back(&content);
+  return pointers;
+}
+
+TEST(SyclConstantBatcherTest, UploadsAndSharesConstants) {
+  Stream* stream = GetStream();
+  if (stream == nullptr) GTEST_SKIP() << "No GPU found";
+
+  // Sizes around the arena alignment, with one duplicate.
+  std::vector<std::vector<uint8_t>> contents;
+  for (size_t bytes : {1, 63, 64, 65, 4096}) {
+    contents.push_back(MakeContents(1, bytes, bytes)[0]);
+  }
+  contents.push_back(contents[2]);
+  auto constants = CreateOrShareConstants(stream, Pointers(contents));
+  ASSERT_TRUE(constants.ok()) << constants.status();
+  ASSERT_EQ(constants->size(), contents.size());
+  EXPECT_EQ((*constants)[2], (*constants)[5]);
+
+  for (size_t i = 0; i < contents.size(); ++i) {
+    std::vector<uint8_t> host(contents[i].size());
+    ASSERT_TRUE(stream
+                    ->ThenMemcpy(host.data(), *(*constants)[i],
+                                 contents[i].size())
+                    .BlockHostUntilDone()
+                    .ok());
+    EXPECT_EQ(host, contents[i]) << "constant " << i;
+  }
+
+  // A single constant takes the direct path and is shared with the batch.
+  auto single = CreateOrShareConstants(stream, {&contents[4]});
+  ASSERT_TRUE(single.ok()) << single.status();
+  EXPECT_EQ((*single)[0], (*constants)[4]);
+}
+
+// Uploads the constants of one executable load, either batched or one call
+// per constant as GpuExecutor::CreateOrShareConstant does.
+void BM_LoadConstants(::testing::benchmark::State& state) {
+  Stream* stream = GetStream();
+  if (stream == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const int count = state.range(0);
+  const size_t bytes = state.range(1);
+  const bool batched = state.range(2);
+  int seed = 0;
+  for (auto s : state) {
+    state.PauseTiming();
+    auto contents = MakeContents(count, bytes, ++seed);
+    auto pointers = Pointers(contents);
+    state.ResumeTiming();
+    if (batched) {
+      auto constants = CreateOrShareConstants(stream, pointers);
+      CHECK(constants.ok()) << constants.status();
+    } else {
+      std::vector<std::shared_ptr<DeviceMemoryBase>> constants;
+      for (const auto* content : pointers) {
+        auto constant = CreateOrShareConstants(stream, {content});
+        CHECK(constant.ok()) << constant.status();
+        constants.push_back((*constant)[0]);
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * count * bytes);
+}
+BENCHMARK(BM_LoadConstants)
+    ->ArgsProduct({{1, 16, 256}, {64, 4 << 10, 1 << 20}, {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace gpu
+}  // namespace stream_executor
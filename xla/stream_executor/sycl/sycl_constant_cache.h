@@ -0,0 +1,165 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_CACHE_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+
+namespace stream_executor {
+namespace sycl {
+
+// Matches the alignment of SYCLMalloc so that every constant carved from an
+// arena is as aligned as an individually allocated one.
+inline constexpr uint64_t kConstantAlignment = 64;
+
+// A distinct constant of one upload and its place in the arena.
+struct ConstantSlot {
+  const std::vector<uint8_t>* content;
+  absl::uint128 fingerprint;
+  uint64_t offset;
+  // Indices of the contents passed to CreateOrShare that hold this constant.
+  std::vector<size_t> users;
+};
+
+// Constants of executables, deduplicated by fingerprint per device. The
+// constants of one call that are not resident yet are sub-allocated from one
+// device arena and uploaded together; the arena is released once the last
+// constant carved from it is destroyed.
+//
+// Each device has its own lock, held across the upload so that concurrent
+// loads of the same constants share one copy. Loads on other devices do not
+// wait for it.
+//
+// `Backend` provides the stream and device types and
+//   static Device* GetDevice(Stream* stream);
+//   static DeviceMemoryBase Allocate(Device* device, uint64_t bytes);
+//   static void Deallocate(Device* device, DeviceMemoryBase* memory);
+//   static tsl::Status Upload(Stream* stream, DeviceMemoryBase* arena,
+//                             absl::Span<const ConstantSlot> slots);
+// Upload returns once the constants have reached the device. Templated so
+// that the cache can be tested on the host.
+template <typename Backend>
+class ConstantCache {
+ public:
+  using Stream = typename Backend::Stream;
+  using Device = typename Backend::Device;
+
+  // Returns one device buffer per entry of `contents`, in order. The device
+  // must outlive all returned buffers.
+  tsl::StatusOr<std::vector<std::shared_ptr<DeviceMemoryBase>>> CreateOrShare(
+      Stream* stream, absl::Span<const std::vector<uint8_t>* const> contents) {
+    Device* device = Backend::GetDevice(stream);
+    std::vector<std::shared_ptr<DeviceMemoryBase>> result(contents.size());
+    DeviceConstants& constants = GetDeviceConstants(device);
+    absl::MutexLock lock(&constants.mu);
+
+    std::vector<ConstantSlot> slots;
+    absl::flat_hash_map<absl::uint128, size_t> slot_index;
+    uint64_t arena_bytes = 0;
+    for (size_t i = 0; i < contents.size(); ++i) {
+      const std::vector<uint8_t>& content = *contents[i];
+      auto fp = tsl::Fingerprint128(absl::string_view(
+          reinterpret_cast<const char*>(content.data()), content.size()));
+      absl::uint128 fingerprint = absl::MakeUint128(fp.high64, fp.low64);
+      auto cached = constants.shared.find(fingerprint);
+      if (cached != constants.shared.end()) {
+        if (auto shared = cached->second.lock()) {
+          result[i] = std::move(shared);
+          continue;
+        }
+      }
+      auto [it, inserted] = slot_index.insert({fingerprint, slots.size()});
+      if (inserted) {
+        slots.push_back({&content, fingerprint, arena_bytes, {}});
+        arena_bytes += (content.size() + kConstantAlignment - 1) /
+                       kConstantAlignment * kConstantAlignment;
+      }
+      slots[it->second].users.push_back(i);
+    }
+    if (slots.empty()) return result;
+
+    auto* arena = new DeviceMemoryBase(Backend::Allocate(device, arena_bytes));
+    if (arena->opaque() == nullptr) {
+      delete arena;
+      return tsl::Status(
+          absl::StatusCode::kInternal,
+          absl::StrFormat("Failed to allocate %d bytes for %d new constants",
+                          arena_bytes, slots.size()));
+    }
+    std::shared_ptr<DeviceMemoryBase> shared_arena(
+        arena, [device](DeviceMemoryBase* p) {
+          Backend::Deallocate(device, p);
+          delete p;
+        });
+    tsl::Status status = Backend::Upload(stream, arena, slots);
+    if (!status.ok()) return status;
+
+    for (const ConstantSlot& slot : slots) {
+      void* opaque = static_cast<char*>(arena->opaque()) + slot.offset;
+      // Every constant holds a reference to the arena through its deleter.
+      // The deleter outlives the constant while the cache still has a weak
+      // reference to it, so it drops the arena explicitly.
+      std::shared_ptr<DeviceMemoryBase> shared_constant(
+          new DeviceMemoryBase(opaque, slot.content->size()),
+          [shared_arena](DeviceMemoryBase* p) mutable {
+            delete p;
+            shared_arena.reset();
+          });
+      constants.shared[slot.fingerprint] = shared_constant;
+      for (size_t user : slot.users) result[user] = shared_constant;
+    }
+    return result;
+  }
+
+ private:
+  // We assume all constants are uniquely identified by their hash, as
+  // GpuExecutor::CreateOrShareConstant does.
+  struct DeviceConstants {
+    absl::Mutex mu;
+    absl::flat_hash_map<absl::uint128, std::weak_ptr<DeviceMemoryBase>> shared
+        ABSL_GUARDED_BY(mu);
+  };
+
+  DeviceConstants& GetDeviceConstants(Device* device) {
+    absl::MutexLock lock(&mu_);
+    std::unique_ptr<DeviceConstants>& constants = devices_[device];
+    if (constants == nullptr) constants = std::make_unique<DeviceConstants>();
+    return *constants;
+  }
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<Device*, std::unique_ptr<DeviceConstants>> devices_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace sycl
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_CONSTANT_CACHE_H_
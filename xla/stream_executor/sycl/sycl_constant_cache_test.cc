@@ -0,0 +1,257 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_constant_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "tsl/platform/test.h"
+
+namespace stream_executor {
+namespace sycl {
+namespace {
+
+struct FakeDevice {
+  int id = 0;
+};
+
+struct FakeStream {
+  FakeDevice* device;
+};
+
+// Host memory standing in for device memory. Uploads copy the constants into
+// the arena, and can be made to fail or to block until released.
+struct FakeBackend {
+  using Stream = FakeStream;
+  using Device = FakeDevice;
+
+  static FakeDevice* GetDevice(FakeStream* stream) { return stream->device; }
+  static DeviceMemoryBase Allocate(FakeDevice*, uint64_t bytes) {
+    if (fail_allocations) return DeviceMemoryBase();
+    ++allocations;
+    ++live_arenas;
+    last_arena_bytes = bytes;
+    return DeviceMemoryBase(std::malloc(bytes), bytes);
+  }
+  static void Deallocate(FakeDevice*, DeviceMemoryBase* memory) {
+    --live_arenas;
+    std::free(memory->opaque());
+  }
+  static tsl::Status Upload(FakeStream* stream, DeviceMemoryBase* arena,
+                            absl::Span<const ConstantSlot> slots) {
+    ++uploads;
+    if (stream->device == blocked_device) {
+      upload_started->Notify();
+      release_upload->WaitForNotification();
+    }
+    if (fail_uploads) {
+      return tsl::Status(absl::StatusCode::kInternal, "upload failed");
+    }
+    last_offsets.clear();
+    for (const ConstantSlot& slot : slots) {
+      last_offsets.push_back(slot.offset);
+      std::memcpy(static_cast<char*>(arena->opaque()) + slot.offset,
+                  slot.content->data(), slot.content->size());
+    }
+    return tsl::OkStatus();
+  }
+
+  static inline int allocations = 0;
+  static inline int live_arenas = 0;
+  static inline int uploads = 0;
+  static inline uint64_t last_arena_bytes = 0;
+  static inline std::vector<uint64_t> last_offsets;
+  static inline bool fail_allocations = false;
+  static inline bool fail_uploads = false;
+  static inline FakeDevice* blocked_device = nullptr;
+  static inline absl::Notification* upload_started = nullptr;
+  static inline absl::Notification* release_upload = nullptr;
+};
+
+using TestCache = ConstantCache<FakeBackend>;
+using Constants = std::vector<std::shared_ptr<DeviceMemoryBase>>;
+
+std::vector<uint8_t> Content(size_t size, uint8_t value) {
+  return std::vector<uint8_t>(size, value);
+}
+
+bool Holds(const std::shared_ptr<DeviceMemoryBase>& constant,
+           const std::vector<uint8_t>& content) {
+  return constant != nullptr && constant->size() == content.size() &&
+         std::memcmp(constant->opaque(), content.data(), content.size()) == 0;
+}
+
+class ConstantCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FakeBackend::allocations = 0;
+    FakeBackend::live_arenas = 0;
+    FakeBackend::uploads = 0;
+    FakeBackend::last_arena_bytes = 0;
+    FakeBackend::last_offsets.clear();
+    FakeBackend::fail_allocations = false;
+    FakeBackend::fail_uploads = false;
+    FakeBackend::blocked_device = nullptr;
+  }
+
+  tsl::StatusOr<Constants> Upload(
+      FakeStream* stream, const std::vector<const std::vector<uint8_t>*>& in) {
+    return cache_.CreateOrShare(stream, in);
+  }
+
+  TestCache cache_;
+  FakeDevice device_a_{0}, device_b_{1};
+  FakeStream stream_a_{&device_a_}, stream_b_{&device_b_};
+};
+
+TEST_F(ConstantCacheTest, LaysOutConstantsInOneAlignedArena) {
+  auto c1 = Content(1, 1), c64 = Content(64, 2), c65 = Content(65, 3);
+  auto result = Upload(&stream_a_, {&c1, &c64, &c65});
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(FakeBackend::allocations, 1);
+  EXPECT_EQ(FakeBackend::uploads, 1);
+  EXPECT_EQ(FakeBackend::last_arena_bytes, 256);
+  EXPECT_EQ(FakeBackend::last_offsets, (std::vector<uint64_t>{0, 64, 128}));
+  const Constants& constants = *result;
+  ASSERT_EQ(constants.size(), 3);
+  EXPECT_TRUE(Holds(constants[0], c1));
+  EXPECT_TRUE(Holds(constants[1], c64));
+  EXPECT_TRUE(Holds(constants[2], c65));
+  for (const auto& constant : constants) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(constant->opaque()) %
+                  kConstantAlignment,
+              0);
+  }
+}
+
+TEST_F(ConstantCacheTest, DeduplicatesWithinOneCall) {
+  auto a = Content(100, 7), b = Content(100, 7), c = Content(100, 8);
+  auto result = Upload(&stream_a_, {&a, &b, &c, &a});
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(FakeBackend::last_offsets, (std::vector<uint64_t>{0, 128}));
+  const Constants& constants = *result;
+  EXPECT_EQ(constants[0], constants[1]);
+  EXPECT_EQ(constants[0], constants[3]);
+  EXPECT_NE(constants[0], constants[2]);
+  EXPECT_TRUE(Holds(constants[2], c));
+}
+
+TEST_F(ConstantCacheTest, SharesResidentConstantsAcrossCalls) {
+  auto a = Content(32, 1), b = Content(32, 2);
+  auto first = Upload(&stream_a_, {&a});
+  ASSERT_TRUE(first.ok());
+  auto second = Upload(&stream_a_, {&b, &a});
+  ASSERT_TRUE(second.ok());
+  EXPECT_EQ((*second)[1], (*first)[0]);
+  EXPECT_TRUE(Holds((*second)[0], b));
+  // Only `b` is new, so the second arena holds just one constant.
+  EXPECT_EQ(FakeBackend::allocations, 2);
+  EXPECT_EQ(FakeBackend::last_arena_bytes, kConstantAlignment);
+
+  auto third = Upload(&stream_a_, {&a, &b});
+  ASSERT_TRUE(third.ok());
+  EXPECT_EQ(FakeBackend::allocations, 2);
+  EXPECT_EQ(FakeBackend::uploads, 2);
+}
+
+TEST_F(ConstantCacheTest, KeepsDevicesApart) {
+  auto a = Content(16, 1);
+  auto on_a = Upload(&stream_a_, {&a});
+  auto on_b = Upload(&stream_b_, {&a});
+  ASSERT_TRUE(on_a.ok());
+  ASSERT_TRUE(on_b.ok());
+  EXPECT_NE((*on_a)[0]->opaque(), (*on_b)[0]->opaque());
+  EXPECT_EQ(FakeBackend::allocations, 2);
+}
+
+TEST_F(ConstantCacheTest, FreesArenaWithLastConstant) {
+  auto a = Content(16, 1), b = Content(16, 2);
+  auto result = Upload(&stream_a_, {&a, &b});
+  ASSERT_TRUE(result.ok());
+  Constants constants = std::move(result).value();
+  EXPECT_EQ(FakeBackend::live_arenas, 1);
+  constants[0].reset();
+  EXPECT_EQ(FakeBackend::live_arenas, 1);
+  constants[1].reset();
+  EXPECT_EQ(FakeBackend::live_arenas, 0);
+
+  // Expired entries are uploaded again.
+  auto again = Upload(&stream_a_, {&a});
+  ASSERT_TRUE(again.ok());
+  EXPECT_TRUE(Holds((*again)[0], a));
+  EXPECT_EQ(FakeBackend::uploads, 2);
+}
+
+TEST_F(ConstantCacheTest, ReportsAllocationFailure) {
+  auto a = Content(16, 1);
+  FakeBackend::fail_allocations = true;
+  auto result = Upload(&stream_a_, {&a});
+  ASSERT_FALSE(result.ok());
+  EXPECT_EQ(result.status().code(), absl::StatusCode::kInternal);
+  EXPECT_EQ(FakeBackend::uploads, 0);
+
+  FakeBackend::fail_allocations = false;
+  auto retry = Upload(&stream_a_, {&a});
+  ASSERT_TRUE(retry.ok());
+  EXPECT_TRUE(Holds((*retry)[0], a));
+}
+
+TEST_F(ConstantCacheTest, CachesNothingWhenUploadFails) {
+  auto a = Content(16, 1);
+  FakeBackend::fail_uploads = true;
+  auto result = Upload(&stream_a_, {&a});
+  ASSERT_FALSE(result.ok());
+  EXPECT_EQ(result.status().code(), absl::StatusCode::kInternal);
+  EXPECT_EQ(FakeBackend::live_arenas, 0);
+
+  FakeBackend::fail_uploads = false;
+  auto retry = Upload(&stream_a_, {&a});
+  ASSERT_TRUE(retry.ok());
+  EXPECT_TRUE(Holds((*retry)[0], a));
+  EXPECT_EQ(FakeBackend::uploads, 2);
+}
+
+TEST_F(ConstantCacheTest, ReturnsEmptyForNoContents) {
+  auto result = Upload(&stream_a_, {});
+  ASSERT_TRUE(result.ok());
+  EXPECT_TRUE(result->empty());
+  EXPECT_EQ(FakeBackend::allocations, 0);
+}
+
+TEST_F(ConstantCacheTest, UploadDoesNotBlockOtherDevices) {
+  absl::Notification started, release;
+  FakeBackend::blocked_device = &device_a_;
+  FakeBackend::upload_started = &started;
+  FakeBackend::release_upload = &release;
+
+  auto a = Content(16, 1), b = Content(16, 2);
+  std::thread loader([&] { ASSERT_TRUE(Upload(&stream_a_, {&a}).ok()); });
+  started.WaitForNotification();
+  // Device a is still uploading; device b must not wait for it.
+  auto on_b = Upload(&stream_b_, {&b});
+  ASSERT_TRUE(on_b.ok());
+  EXPECT_TRUE(Holds((*on_b)[0], b));
+  release.Notify();
+  loader.join();
+}
+
+}  // namespace
+}  // namespace sycl
+}  // namespace stream_executor
@@ -22,17 +22,22 @@ limitations under the License.
 #include <set>
 #include <utility>
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/base/const_init.h"
 #include "absl/base/optimization.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/debugging/leak_check.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
@@ -43,11 +48,19 @@ limitations under the License.
 #include "xla/stream_executor/platform/port.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/stacktrace.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
+#include "tsl/util/env_var.h"
+#include "xla/stream_executor/sycl/hw_info.h"
+#include "xla/stream_executor/sycl/sycl_driver.h"
+#include "xla/stream_executor/sycl/sycl_grf_mode.h"
+#include "xla/stream_executor/sycl/sycl_kernel_args.h"
 #include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+#include "xla/stream_executor/sycl/sycl_spirv_bundle.h"
 
 #define RETURN_IF_SYCL_RES_ERROR(expr, ...)                            \
   do {                                                                 \
@@ -60,6 +73,8 @@ limitations under the License.
 namespace stream_executor {
 namespace gpu {
 
+namespace sycl = ::sycl;
+
 class GpuContext {
  public:
   GpuContext(sycl::device* d, sycl::context* c) : device_(d), context_(c) {}
@@ -84,7 +99,149 @@ static tsl::Status InternalInit() {
   return ::tsl::OkStatus();
 }
 
+// XLA_ENABLE_LEVEL_ZERO_LAUNCH
+//   True: Launch kernels with zeKernelSetArgumentValue and
+//         zeCommandListAppendLaunchKernel directly on the immediate command
+//         list backing the SYCL queue, bypassing the SYCL command group
+//         machinery. Only used for in-order queues on immediate command lists.
+//   False (default behaviour): Launch kernels through sycl::queue::submit.
+std::atomic<bool>& LevelZeroLaunchSetting() {
+  static std::atomic<bool>* setting = [] {
+    bool enabled;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("XLA_ENABLE_LEVEL_ZERO_LAUNCH", false,
+                                        &enabled));
+    return new std::atomic<bool>(enabled);
+  }();
+  return *setting;
+}
+
+std::atomic<int64_t> level_zero_launch_count{0};
+
+// Level Zero launch state of a kernel, registered when the kernel is created.
+// Argument values and group size are state of the Level Zero kernel handle, so
+// setting them and appending the launch must be atomic.
+struct LevelZeroKernel {
+  LevelZeroKernel(ze_module_handle_t module, ze_kernel_handle_t handle)
+      : module(module), handle(handle) {}
+
+  const ze_module_handle_t module;
+  const ze_kernel_handle_t handle;
+  absl::Mutex mu;
+  uint32_t group_size[3] ABSL_GUARDED_BY(mu) = {0, 0, 0};
+  stream_executor::sycl::KernelArgumentCache args ABSL_GUARDED_BY(mu);
+};
+
+// Kernels are registered for as long as the module that owns their handles is
+// loaded.
+class LevelZeroKernelRegistry {
+ public:
+  static LevelZeroKernelRegistry& Get() {
+    static auto* registry = new LevelZeroKernelRegistry();
+    return *registry;
+  }
+
+  void Register(const sycl::kernel* kernel, ze_module_handle_t module,
+                ze_kernel_handle_t handle) {
+    auto entry = std::make_shared<LevelZeroKernel>(module, handle);
+    absl::MutexLock lock(&mu_);
+    // The address of a destroyed kernel may be reused, so replace whatever
+    // was registered for it before.
+    kernels_[kernel] = std::move(entry);
+  }
+
+  // Drops the kernels of `module`, whose handles are destroyed with it.
+  void UnregisterModule(ze_module_handle_t module) {
+    absl::MutexLock lock(&mu_);
+    for (auto it = kernels_.begin(); it != kernels_.end();) {
+      if (it->second->module == module) {
+        kernels_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // The returned state stays valid while a launch uses it, even if its module
+  // is unloaded concurrently.
+  std::shared_ptr<LevelZeroKernel> Find(const sycl::kernel* kernel) {
+    absl::ReaderMutexLock lock(&mu_);
+    auto it = kernels_.find(kernel);
+    return it == kernels_.end() ? nullptr : it->second;
+  }
+
+ private:
+  absl::Mutex mu_;
+  absl::flat_hash_map<const sycl::kernel*, std::shared_ptr<LevelZeroKernel>>
+      kernels_ ABSL_GUARDED_BY(mu_);
+};
+
+// Launches `function` directly through Level Zero. Returns false without
+// launching anything if `stream` is not backed by an immediate command list.
+bool LaunchKernelLevelZero(sycl::kernel* function, unsigned int grid_dim_x,
+                           unsigned int grid_dim_y, unsigned int grid_dim_z,
+                           unsigned int block_dim_x, unsigned int block_dim_y,
+                           unsigned int block_dim_z, sycl::queue* stream,
+                           void** args, size_t num_args) {
+  std::shared_ptr<LevelZeroKernel> kernel =
+      LevelZeroKernelRegistry::Get().Find(function);
+  if (kernel == nullptr || !stream->is_in_order()) return false;
+  auto native_queue =
+      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(*stream);
+  auto* command_list = std::get_if<ze_command_list_handle_t>(&native_queue);
+  if (command_list == nullptr) return false;
+
+  absl::MutexLock lock(&kernel->mu);
+  if (kernel->group_size[0] != block_dim_x ||
+      kernel->group_size[1] != block_dim_y ||
+      kernel->group_size[2] != block_dim_z) {
+    if (zeKernelSetGroupSize(kernel->handle, block_dim_x, block_dim_y,
+                             block_dim_z) != ZE_RESULT_SUCCESS) {
+      return false;
+    }
+    kernel->group_size[0] = block_dim_x;
+    kernel->group_size[1] = block_dim_y;
+    kernel->group_size[2] = block_dim_z;
+  }
+  bool bound = kernel->args.Bind(
+      absl::MakeConstSpan(args, num_args), [&](size_t index, void* value) {
+        return zeKernelSetArgumentValue(kernel->handle, index, sizeof(void*),
+                                        &value) == ZE_RESULT_SUCCESS;
+      });
+  if (!bound) return false;
+  ze_group_count_t group_count = {grid_dim_x, grid_dim_y, grid_dim_z};
+  if (zeCommandListAppendLaunchKernel(*command_list, kernel->handle,
+                                      &group_count, /*hSignalEvent=*/nullptr,
+                                      /*numWaitEvents=*/0,
+                                      /*phWaitEvents=*/nullptr) !=
+      ZE_RESULT_SUCCESS) {
+    return false;
+  }
+  level_zero_launch_count.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+// The SYCL runtime sets the group size and arguments of `function` on the
+// same Level Zero handle, so the next direct launch must set them all again.
+void ForgetLevelZeroLaunchState(sycl::kernel* function) {
+  if (level_zero_launch_count.load(std::memory_order_relaxed) == 0) return;
+  std::shared_ptr<LevelZeroKernel> kernel =
+      LevelZeroKernelRegistry::Get().Find(function);
+  if (kernel == nullptr) return;
+  absl::MutexLock lock(&kernel->mu);
+  kernel->group_size[0] = kernel->group_size[1] = kernel->group_size[2] = 0;
+  kernel->args.Clear();
+}
+
 }  // namespace
+
+void SetLevelZeroLaunch(bool enabled) {
+  LevelZeroLaunchSetting().store(enabled, std::memory_order_relaxed);
+}
+
+int64_t LevelZeroLaunchCount() {
+  return level_zero_launch_count.load(std::memory_order_relaxed);
+}
+
 /* static */ tsl::Status GpuDriver::Init() {
   // Cached return value from calling InternalInit()
   static tsl::Status* init_retval = [] {
@@ -137,6 +294,16 @@ static tsl::Status InternalInit() {
           << " gdy: " << grid_dim_y << " gdz: " << grid_dim_z
           << " bdx: " << block_dim_x << " bdy: " << block_dim_y
           << " bdz: " << block_dim_z;
+  void** args = static_cast<void**>(extra[0]);
+  size_t num_args = static_cast<size_t*>(extra[1])[0];
+  if (LevelZeroLaunchSetting().load(std::memory_order_relaxed) &&
+      LaunchKernelLevelZero(function, grid_dim_x, grid_dim_y, grid_dim_z,
+                            block_dim_x, block_dim_y, block_dim_z, stream,
+                            args, num_args)) {
+    return ::tsl::OkStatus();
+  }
+  ForgetLevelZeroLaunchState(function);
+
   auto sycl_global_range =
       sycl::range<3>(block_dim_z * grid_dim_z, block_dim_y * grid_dim_y,
                      block_dim_x * grid_dim_x);
@@ -145,8 +312,8 @@ static tsl::Status InternalInit() {
       sycl::nd_range<3>(sycl_global_range, sycl_local_range));
 
   stream->submit([&](auto& cgh) {
-    for (uint32_t i = 0; i < static_cast<size_t*>(extra[1])[0]; i++) {
-      cgh.set_arg(i, static_cast<void**>(extra[0])[i]);
+    for (uint32_t i = 0; i < num_args; i++) {
+      cgh.set_arg(i, args[i]);
     }
     cgh.parallel_for(sycl_nd_range, *function);
   });
@@ -183,24 +350,43 @@ static tsl::Status InternalInit() {
       exit(1);                             \
     }                                      \
   }
-/* static */ tsl::Status GpuDriver::LoadLevelzero(
-    GpuContext* context, const char* spir_contents, const size_t size,
-    ze_module_handle_t* ze_module) {
-  const sycl::context* sycl_context = context->context();
-  const sycl::device* sycl_device = context->device();
-  auto ze_device =
-      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(*sycl_device);
-  auto ze_context =
-      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(*sycl_context);
+namespace {
 
+tsl::Status BuildLevelZeroModule(ze_context_handle_t ze_context,
+                                 ze_device_handle_t ze_device,
+                                 const char* spir_contents, const size_t size,
+                                 GrfMode grf_mode,
+                                 ze_module_handle_t* ze_module) {
   ze_module_desc_t moduleDesc = {ZE_STRUCTURE_TYPE_MODULE_DESC,
                                  nullptr,
                                  ZE_MODULE_FORMAT_IL_SPIRV,
                                  size,
                                  (const uint8_t*)spir_contents,
-                                 nullptr,
+                                 GrfModeBuildFlags(grf_mode),
                                  nullptr};
 
+  // SPIR-V translated from split LLVM modules is linked into one module.
+  ze_module_program_exp_desc_t programDesc = {
+      ZE_STRUCTURE_TYPE_MODULE_PROGRAM_EXP_DESC};
+  std::vector<size_t> input_sizes;
+  std::vector<const uint8_t*> inputs;
+  std::vector<const char*> build_flags;
+  if (IsSpirvBundle(spir_contents, size)) {
+    TF_ASSIGN_OR_RETURN(auto modules,
+                        UnpackSpirvModules(spir_contents, size));
+    for (const auto& module : modules) {
+      input_sizes.push_back(module.size());
+      inputs.push_back(module.data());
+      build_flags.push_back(GrfModeBuildFlags(grf_mode));
+    }
+    programDesc.count = modules.size();
+    programDesc.inputSizes = input_sizes.data();
+    programDesc.pInputModules = inputs.data();
+    programDesc.pBuildFlags = build_flags.data();
+    moduleDesc.pNext = &programDesc;
+    VLOG(2) << "Linking " << modules.size() << " SPIR-V modules";
+  }
+
   ze_module_build_log_handle_t buildlog;
   ze_result_t status =
       zeModuleCreate(ze_context, ze_device, &moduleDesc, ze_module, &buildlog);
@@ -213,6 +399,80 @@ static tsl::Status InternalInit() {
     std::string PLog(PLogs.get());
     LOG(FATAL) << "L0 error " << status << ": " << PLog;
   }
+  zeModuleBuildLogDestroy(buildlog);
+  return ::tsl::OkStatus();
+}
+
+// Returns true if any kernel of `ze_module` spills registers to memory.
+bool ModuleSpills(ze_module_handle_t ze_module) {
+  uint32_t count = 0;
+  L0_SAFE_CALL(zeModuleGetKernelNames(ze_module, &count, nullptr));
+  std::vector<const char*> names(count);
+  L0_SAFE_CALL(zeModuleGetKernelNames(ze_module, &count, names.data()));
+  for (const char* name : names) {
+    ze_kernel_desc_t kernel_desc = {ZE_STRUCTURE_TYPE_KERNEL_DESC, nullptr, 0,
+                                    name};
+    ze_kernel_handle_t ze_kernel;
+    L0_SAFE_CALL(zeKernelCreate(ze_module, &kernel_desc, &ze_kernel));
+    ze_kernel_properties_t props = {};
+    props.stype = ZE_STRUCTURE_TYPE_KERNEL_PROPERTIES;
+    L0_SAFE_CALL(zeKernelGetProperties(ze_kernel, &props));
+    L0_SAFE_CALL(zeKernelDestroy(ze_kernel));
+    if (props.spillMemSize > 0) {
+      VLOG(2) << "Kernel " << name << " spills " << props.spillMemSize
+              << " bytes in the default GRF mode";
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+/* static */ tsl::Status GpuDriver::LoadLevelzero(
+    GpuContext* context, const char* spir_contents, const size_t size,
+    ze_module_handle_t* ze_module) {
+  const sycl::context* sycl_context = context->context();
+  const sycl::device* sycl_device = context->device();
+  auto ze_device =
+      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(*sycl_device);
+  auto ze_context =
+      sycl::get_native<sycl::backend::ext_oneapi_level_zero>(*sycl_context);
+
+  GrfMode grf_mode = GetGrfModePolicy();
+  if (grf_mode != GrfMode::kDefault &&
+      !IsXeHPC(const_cast<sycl::device*>(sycl_device))) {
+    grf_mode = GrfMode::kDefault;
+  }
+
+  uint64_t fingerprint = 0;
+  if (grf_mode == GrfMode::kAuto) {
+    fingerprint = tsl::Fingerprint64(absl::string_view(spir_contents, size));
+    grf_mode = LookupAutoGrfMode(fingerprint);
+  }
+
+  if (grf_mode != GrfMode::kAuto) {
+    TF_RETURN_IF_ERROR(BuildLevelZeroModule(ze_context, ze_device,
+                                            spir_contents, size, grf_mode,
+                                            ze_module));
+  } else {
+    // Large GRF halves the hardware threads per EU, so it only pays off when
+    // the default mode spills.
+    TF_RETURN_IF_ERROR(BuildLevelZeroModule(ze_context, ze_device,
+                                            spir_contents, size,
+                                            GrfMode::kDefault, ze_module));
+    grf_mode = GrfMode::kDefault;
+    if (ModuleSpills(*ze_module)) {
+      VLOG(1) << "Rebuilding module in large GRF mode to avoid spills";
+      L0_SAFE_CALL(zeModuleDestroy(*ze_module));
+      TF_RETURN_IF_ERROR(BuildLevelZeroModule(ze_context, ze_device,
+                                              spir_contents, size,
+                                              GrfMode::kLarge, ze_module));
+      grf_mode = GrfMode::kLarge;
+    }
+    RecordAutoGrfMode(fingerprint, grf_mode);
+  }
+  RecordModuleGrfMode(*ze_module, grf_mode);
 
   return ::tsl::OkStatus();
 }
@@ -251,6 +511,7 @@ static tsl::Status InternalInit() {
   auto kernel = sycl::make_kernel<sycl::backend::ext_oneapi_level_zero>(
       {kernel_bundle, ze_kernel}, *sycl_context);
   *sycl_kernel = new sycl::kernel(kernel);
+  LevelZeroKernelRegistry::Get().Register(*sycl_kernel, module, ze_kernel);
   return tsl::OkStatus();
 }
 
@@ -274,7 +535,11 @@ static tsl::Status InternalInit() {
 
 /* static */ void GpuDriver::UnloadModule(GpuContext* context,
                                           ze_module_handle_t module) {
-  if (module) L0_SAFE_CALL(zeModuleDestroy(module));
+  if (module) {
+    LevelZeroKernelRegistry::Get().UnregisterModule(module);
+    ForgetModuleGrfMode(module);
+    L0_SAFE_CALL(zeModuleDestroy(module));
+  }
 }
 
 #undef L0_SAFE_CALL
@@ -317,13 +582,7 @@ static tsl::Status InternalInit() {
 
 /* static */ bool GpuDriver::CreateStream(GpuContext* context,
                                           sycl::queue** stream, int priority) {
-  SYCLError_t res;
-  if (priority == 0) {
-    res = SYCLCreateStream(context->device(), stream);
-  } else {
-    LOG(ERROR)
-        << "CreateStream with priority is not supported on SYCL platform";
-  }
+  SYCLError_t res = SYCLCreateStream(context->device(), stream, priority);
 
   if (res != SYCL_SUCCESS) {
     LOG(ERROR) << "could not allocate SYCL stream for context "
@@ -412,10 +671,14 @@ static tsl::Status InternalInit() {
 
 /* static */ int GpuDriver::GetGpuStreamPriority(
     GpuContext* context, stream_executor::StreamPriority stream_priority) {
-  if (stream_priority == stream_executor::StreamPriority::Default) {
-    return 0;
+  switch (stream_priority) {
+    case stream_executor::StreamPriority::Highest:
+      return 1;
+    case stream_executor::StreamPriority::Lowest:
+      return -1;
+    default:
+      return 0;
   }
-  LOG(FATAL) << "GetGpuStreamPriority not implemented on SYCL platform";
 }
 
 /* static */ tsl::Status GpuDriver::InitEvent(GpuContext* context,
@@ -471,7 +734,8 @@ static tsl::Status InternalInit() {
 /* static */ tsl::Status GpuDriver::SynchronizeStream(GpuContext* context,
                                                       sycl::queue* stream) {
   CHECK(stream != nullptr);
-  stream->wait();
+  RETURN_IF_SYCL_RES_ERROR(SYCLStreamSynchronize(stream),
+                           "Failed to synchronize stream");
   return ::tsl::OkStatus();
 }
 
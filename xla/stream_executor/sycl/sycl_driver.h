@@ -0,0 +1,34 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_DRIVER_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_DRIVER_H_
+
+#include <cstdint>
+
+namespace stream_executor {
+namespace gpu {
+
+// Overrides XLA_ENABLE_LEVEL_ZERO_LAUNCH for subsequent kernel launches.
+void SetLevelZeroLaunch(bool enabled);
+
+// Number of kernels launched directly through Level Zero so far. Launches
+// that fall back to sycl::queue::submit are not counted.
+int64_t LevelZeroLaunchCount();
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_DRIVER_H_
@@ -19,11 +19,13 @@ limitations under the License.
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
@@ -45,10 +47,15 @@ limitations under the License.
 #include "xla/stream_executor/stream.h"
 #include "xla/stream_executor/stream_executor_internal.h"
 #include "xla/stream_executor/stream_executor_pimpl.h"
+#include "xla/stream_executor/sycl/hw_info.h"
+#include "xla/stream_executor/sycl/sycl_constant_batcher.h"
 #include "xla/stream_executor/sycl/sycl_event.h"
 #include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+#include "xla/stream_executor/sycl/sycl_grf_mode.h"
+#include "xla/stream_executor/sycl/sycl_kernel.h"
 #include "xla/stream_executor/sycl/sycl_platform_id.h"
 #include "xla/stream_executor/sycl/sycl_stream.h"
+#include "xla/stream_executor/sycl/sycl_stream_workspace.h"
 
 namespace stream_executor {
 namespace gpu {
@@ -65,6 +72,12 @@ namespace sycl = ::sycl;
 // variable with extern linkage and populate it from another translation unit.
 std::function<std::string(const std::string&)> g_cubinate;
 
+// Number of kernel arguments packed without a heap allocation per launch.
+constexpr int kInlineKernelArgs = 16;
+
+// Sub-group size XLA kernels are compiled with (intel_reqd_sub_group_size).
+constexpr int kSubGroupSize = 32;
+
 static GpuEvent* AsGpuEvent(Event* event) {
   DCHECK(event != nullptr);
   return static_cast<GpuEvent*>(event->implementation());
@@ -165,6 +178,9 @@ tsl::Status GpuExecutor::GetKernel(const MultiKernelLoaderSpec& spec,
 
   KernelMetadata kernel_metadata;
   TF_RETURN_IF_ERROR(GetKernelMetadata(l0_kernel, &kernel_metadata));
+  // Level Zero does not report the GRF mode of a kernel; it is a property of
+  // the module build.
+  kernel_metadata.set_registers_per_thread(GrfCount(GetModuleGrfMode(module)));
   kernel->set_metadata(kernel_metadata);
   kernel->set_name(kernel_name);
   return ::tsl::OkStatus();
@@ -227,78 +243,58 @@ bool GpuExecutor::UnloadModule(ModuleHandle module_handle) {
   return UnloadGpuBinary(gpu_binary);
 }
 
-namespace {
-absl::uint128 Fingerprint128(const absl::string_view s) {
-  auto fp = tsl::Fingerprint128(s);
-  return absl::MakeUint128(fp.high64, fp.low64);
-}
-}  // namespace
-
 tsl::StatusOr<std::shared_ptr<DeviceMemoryBase>>
 GpuExecutor::CreateOrShareConstant(Stream* stream,
                                    const std::vector<uint8_t>& content) {
-  absl::MutexLock lock{&shared_constants_mu_};
-  // We assume all constants are uniquely identified by this hash. In the
-  // (highly unlikely) event of a hash collision, the program will likely crash
-  // (because the cached constant that will be returned by mistake is unlikely
-  // to have the correct size).
-  absl::uint128 fingerprint = Fingerprint128(absl::string_view(
-      reinterpret_cast<const char*>(content.data()), content.size()));
-  // Must insert nullptr first to get an iterator to the insertion point.
-  auto insert_result = shared_constants_.insert(
-      {fingerprint, std::weak_ptr<DeviceMemoryBase>()});
-  auto it = insert_result.first;
-  bool was_already_in_cache = !insert_result.second;
-  std::shared_ptr<DeviceMemoryBase> shared_constant;
-
-  if (was_already_in_cache) {
-    shared_constant = it->second.lock();
-  }
-
-  if (shared_constant == nullptr) {
-    // Either the constant wasn't found in the cache, or it was but its
-    // weak_ptr had expired.
-    DeviceMemoryBase* new_constant =
-        new DeviceMemoryBase(Allocate(content.size(), /*memory_space=*/0));
-    if (new_constant->opaque() == nullptr) {
-      return tsl::Status(
-          absl::StatusCode::kInternal,
-          absl::StrFormat("Failed to allocate %d bytes for new constant",
-                          content.size()));
-    }
-
-    tsl::Status status =
-        stream->ThenMemcpy(new_constant, content.data(), content.size())
-            .BlockHostUntilDone();
-    if (!status.ok()) {
-      Deallocate(new_constant);
-      return tsl::Status(absl::StatusCode::kInternal,
-                         absl::StrFormat("Memcpy to device address %p failed",
-                                         new_constant->opaque()));
-    }
-
-    // Capturing 'this' in the custom deleter means this executor must
-    // outlive all shared uses of this constant.
-    shared_constant = std::shared_ptr<DeviceMemoryBase>(
-        new_constant, [this](DeviceMemoryBase* p) {
-          Deallocate(p);
-          delete p;
-        });
-    it->second = std::weak_ptr<DeviceMemoryBase>(shared_constant);
-  }
-
-  return shared_constant;
+  // Share the cache of the batched constant upload path used when loading
+  // executables, so constants are deduplicated across both entry points.
+  const std::vector<uint8_t>* contents[] = {&content};
+  TF_ASSIGN_OR_RETURN(auto shared_constants,
+                      CreateOrShareConstants(stream, contents));
+  return std::move(shared_constants.front());
 }
 
 tsl::Status GpuExecutor::GetKernelMetadata(GpuKernel* l0_kernel,
                                            KernelMetadata* kernel_metadata) {
-  int value = 0;
-  // TODO: implement this feature in SPIR
-  kernel_metadata->set_registers_per_thread(value);
-  kernel_metadata->set_shared_memory_bytes(value);
+  TF_ASSIGN_OR_RETURN(auto properties,
+                      stream_executor::sycl::GetKernelProperties(
+                          *l0_kernel->AsGpuFunctionHandle()));
+  VLOG(2) << "Kernel properties: " << properties.ToString();
+  if (properties.spill_memory_bytes > 0) {
+    VLOG(1) << "Kernel spills " << properties.spill_memory_bytes
+            << " bytes of registers to private memory";
+  }
+  kernel_metadata->set_registers_per_thread(properties.grf_count);
+  kernel_metadata->set_shared_memory_bytes(properties.slm_bytes);
   return ::tsl::OkStatus();
 }
 
+// Logs how a launch configuration fits the resources of `kernel`. Work-groups
+// larger than the kernel supports (e.g. because of its register footprint)
+// fail to launch, so this is the first thing to check on launch errors.
+void GpuExecutor::VlogOccupancyInfo(const KernelBase& kernel,
+                                    const ThreadDim& thread_dims,
+                                    const BlockDim& block_dims) {
+  VLOG(2) << "Computing kernel occupancy for kernel "
+          << kernel.demangled_name();
+  const GpuKernel* l0_kernel = AsGpuKernel(&kernel);
+  auto properties = stream_executor::sycl::GetKernelProperties(
+      *l0_kernel->AsGpuFunctionHandle());
+  if (!properties.ok()) {
+    VLOG(2) << properties.status();
+    return;
+  }
+  int64_t work_group_size = thread_dims.x * thread_dims.y * thread_dims.z;
+  int64_t max_work_group_size = properties->max_work_group_size();
+  VLOG(2) << "Work-group size " << work_group_size << ", kernel supports up to "
+          << max_work_group_size << " (" << properties->ToString() << ")";
+  if (max_work_group_size > 0 && work_group_size > max_work_group_size) {
+    LOG(WARNING) << "Kernel " << kernel.demangled_name()
+                 << " is launched with work-group size " << work_group_size
+                 << " but supports at most " << max_work_group_size;
+  }
+}
+
 tsl::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
                                 const BlockDim& block_dims,
                                 const KernelBase& kernel,
@@ -314,11 +310,15 @@ tsl::Status GpuExecutor::Launch(Stream* stream, const ThreadDim& thread_dims,
   if (VLOG_IS_ON(2)) {
     absl::MutexLock lock(&launched_kernels_mu_);
     if (launched_kernels_.count(sycl_kernel) == 0) {
+      VlogOccupancyInfo(kernel, thread_dims, block_dims);
       launched_kernels_.insert(sycl_kernel);
     }
   }
 
-  std::vector<void*> kernargs;
+  // Kernel arguments are device pointers; typical XLA kernels take few enough
+  // of them that the pack stays on the stack.
+  absl::InlinedVector<void*, kInlineKernelArgs> kernargs;
+  kernargs.reserve(args.number_of_arguments());
   KernelArgIterator iter = args.arg_iterator();
   while (iter.has_next()) {
     KernelArg arg = iter.next();
@@ -539,6 +539,7 @@ bool GpuExecutor::AllocateStream(Stream* stream) {
 }
 
 void GpuExecutor::DeallocateStream(Stream* stream) {
+  ReleaseStreamWorkspace(stream);
   GpuStream* gpu_stream = AsGpuStream(stream);
   absl::MutexLock l(&alive_gpu_streams_mu_);
   alive_gpu_streams_.erase(gpu_stream->platform_specific_stream());
@@ -561,9 +562,7 @@ bool GpuExecutor::CreateStreamDependency(Stream* dependent, Stream* other) {
 }
 
 tsl::Status GpuExecutor::BlockHostUntilDone(Stream* stream) {
-  sycl::queue* stream_handle = AsGpuStreamValue(stream);
-  stream_handle->wait();
-  return ::tsl::OkStatus();
+  return GpuDriver::SynchronizeStream(context_, AsGpuStreamValue(stream));
 }
 
 blas::BlasSupport* GpuExecutor::CreateBlas() {
@@ -696,17 +695,22 @@ GpuExecutor::CreateDeviceDescription(int device_ordinal) {
   builder.set_device_vendor("INTEL Corporation");
   // This means AMPERE.
   builder.set_cuda_compute_capability(8, 0);
-  builder.set_shared_memory_per_core(
-      GpuDriver::GetMaxSharedMemoryPerCore(device).value());
+
+  // A subslice (Xe-core) is reported as a core. Its thread limit is the number
+  // of work-items it keeps resident at the sub-group size kernels are compiled
+  // for, which the CUDA-style launch dimension logic uses to size waves.
+  XeDeviceInfo xe_info = GetXeDeviceInfo(device);
+  VLOG(1) << "Xe device info: " << xe_info.ToString();
+  builder.set_shared_memory_per_core(xe_info.slm_bytes_per_subslice);
   builder.set_shared_memory_per_block(
       GpuDriver::GetMaxSharedMemoryPerBlock(device).value());
   int core_count = GpuDriver::GetMultiprocessorCount(device).value();
   builder.set_core_count(core_count);
-  int eu_count =
-      device->template get_info<sycl::ext::intel::info::device::gpu_eu_count>();
-  builder.set_fpus_per_core(eu_count);
-  builder.set_threads_per_core_limit(max_workgroup_size);
-  builder.set_threads_per_warp(32);
+  builder.set_fpus_per_core(xe_info.fp32_lanes_per_subslice());
+  builder.set_threads_per_core_limit(std::max<int64_t>(
+      max_workgroup_size,
+      xe_info.max_work_items_per_subslice(kSubGroupSize)));
+  builder.set_threads_per_warp(kSubGroupSize);
 
   return builder.Build();
 }
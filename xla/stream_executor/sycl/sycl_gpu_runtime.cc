@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <unordered_map>
 #include <vector>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/util/env_var.h"
+#include "xla/stream_executor/sycl/sycl_staging_pool.h"
 
 namespace {
 
@@ -221,13 +223,33 @@ class StreamPool {
   }
 
   static SYCLError_t createStream(sycl::device* device_handle,
-                                  sycl::queue** stream_p) {
-    if (IsMultipleStreamEnabled()) {
+                                  sycl::queue** stream_p, int priority) {
+    if (priority != 0) {
+      // Prioritized streams carry collectives that must overlap with compute,
+      // so they always get their own queue.
+      sycl::property_list propList =
+          priority > 0
+              ? sycl::property_list{sycl::property::queue::in_order(),
+                                    sycl::ext::oneapi::property::queue::
+                                        priority_high()}
+              : sycl::property_list{
+                    sycl::property::queue::in_order(),
+                    sycl::ext::oneapi::property::queue::priority_low()};
+      StreamPool::GetStreamsPool(device_handle)
+          .push_back(std::make_shared<sycl::queue>(
+              DevicePool::getDeviceContext(), *device_handle, SYCLAsyncHandler,
+              propList));
+    } else if (IsMultipleStreamEnabled()) {
       sycl::property_list propList{sycl::property::queue::in_order()};
       StreamPool::GetStreamsPool(device_handle)
           .push_back(std::make_shared<sycl::queue>(
               DevicePool::getDeviceContext(), *device_handle, SYCLAsyncHandler,
               propList));
+    } else {
+      // Default-priority streams share the default queue. It is not
+      // necessarily the last one once prioritized queues have been added.
+      *stream_p = StreamPool::GetStreamsPool(device_handle)[0].get();
+      return SYCL_SUCCESS;
     }
     *stream_p = StreamPool::GetStreamsPool(device_handle).back().get();
     return SYCL_SUCCESS;
@@ -235,7 +257,7 @@ class StreamPool {
 
   static SYCLError_t syncContext(sycl::device* device_handle) {
     for (auto stream : StreamPool::GetStreamsPool(device_handle)) {
-      stream->wait();
+      SYCLStreamSynchronize(stream.get());
     }
     return SYCL_SUCCESS;
   }
@@ -243,6 +265,8 @@ class StreamPool {
   static SYCLError_t destroyStream(sycl::device* device_handle,
                                    sycl::queue* stream_handle) {
     if (stream_handle == nullptr) return SYCL_ERROR_INVALID_STREAM;
+    SYCLStreamSynchronize(stream_handle);
+    StagingPool::Get().RemoveStream(stream_handle);
     auto stream_pool = StreamPool::GetStreamsPool(device_handle);
     for (int i = 0; i < stream_pool.size(); i++) {
       if (stream_pool[i].get() == stream_handle) {
@@ -293,8 +317,8 @@ SYCLError_t SYCLGetDevice(sycl::device** device, int device_ordinal) {
 }
 
 SYCLError_t SYCLCreateStream(sycl::device* device_handle,
-                             sycl::queue** stream_p) {
-  return StreamPool::createStream(device_handle, stream_p);
+                             sycl::queue** stream_p, int priority) {
+  return StreamPool::createStream(device_handle, stream_p, priority);
 }
 
 SYCLError_t SYCLDestroyStream(sycl::device* device_handle,
@@ -309,60 +333,98 @@ SYCLError_t SYCLCtxSynchronize(sycl::device* device_handle) {
 /************************* SYCL memory management
  * ***************************/
 
-static void memcpyHostToDevice(void* dstDevice, const void* srcHost,
-                               size_t ByteCount, bool async,
-                               sycl::queue* stream) {
-  if (ByteCount == 0) return;
+// Host USM staging buffers backing in-flight host-to-device copies from
+// pageable memory.
+struct SyclStagingBackend {
+  using Stream = sycl::queue;
+  using Event = sycl::event;
+
+  static void* Allocate(sycl::queue* stream, size_t bytes) {
+    return sycl::malloc_host(bytes, stream->get_context());
+  }
+  static void Free(sycl::queue* stream, void* ptr) {
+    sycl::free(ptr, stream->get_context());
+  }
+  static bool IsComplete(const sycl::event& event) {
+    return event.get_info<sycl::info::event::command_execution_status>() ==
+           sycl::info::event_command_status::complete;
+  }
+};
+
+class StagingPool {
+ public:
+  // Copies larger than this still block the host instead of being staged.
+  static constexpr size_t kMaxStagedCopyBytes = 16 << 20;
+  // Bound on the pinned host memory held for staging across all streams.
+  static constexpr size_t kMaxPoolBytes = 64 << 20;
+
+  static stream_executor::sycl::StagingBufferPool<SyclStagingBackend>& Get() {
+    static auto* pool =
+        new stream_executor::sycl::StagingBufferPool<SyclStagingBackend>(
+            kMaxPoolBytes);
+    return *pool;
+  }
+};
+
+static sycl::event memcpyHostToDevice(void* dstDevice, const void* srcHost,
+                                      size_t ByteCount, bool async,
+                                      sycl::queue* stream) {
+  if (ByteCount == 0) return sycl::event();
 
   auto event = stream->memcpy(dstDevice, srcHost, ByteCount);
   if (!async) {
     event.wait();
   }
+  return event;
 }
 
-static void memcpyDeviceToHost(void* dstHost, const void* srcDevice,
-                               size_t ByteCount, bool async,
-                               sycl::queue* stream) {
-  if (ByteCount == 0) return;
+static sycl::event memcpyDeviceToHost(void* dstHost, const void* srcDevice,
+                                      size_t ByteCount, bool async,
+                                      sycl::queue* stream) {
+  if (ByteCount == 0) return sycl::event();
 
   auto event = stream->memcpy(dstHost, srcDevice, ByteCount);
 
   if (!async) {
     event.wait();
   }
+  return event;
 }
 
-static void memcpyDeviceToDevice(void* dstDevice, const void* srcDevice,
-                                 size_t ByteCount, bool async,
-                                 sycl::queue* stream) {
-  if (ByteCount == 0) return;
+static sycl::event memcpyDeviceToDevice(void* dstDevice, const void* srcDevice,
+                                        size_t ByteCount, bool async,
+                                        sycl::queue* stream) {
+  if (ByteCount == 0) return sycl::event();
 
   auto event = stream->memcpy(dstDevice, srcDevice, ByteCount);
 
   if (!async) {
     event.wait();
   }
+  return event;
 }
 
-static void memsetDeviceD8(void* dstDevice, unsigned char value, size_t n,
-                           bool async, sycl::queue* stream) {
-  if (n == 0) return;
+static sycl::event memsetDeviceD8(void* dstDevice, unsigned char value,
+                                  size_t n, bool async, sycl::queue* stream) {
+  if (n == 0) return sycl::event();
 
   auto event = stream->memset(dstDevice, value, n * sizeof(uint8_t));
   if (!async) {
     event.wait();
   }
+  return event;
 }
 
-static void memsetDeviceD32(void* dstDevice, int value, size_t n, bool async,
-                            sycl::queue* stream) {
-  if (n == 0) return;
+static sycl::event memsetDeviceD32(void* dstDevice, int value, size_t n,
+                                   bool async, sycl::queue* stream) {
+  if (n == 0) return sycl::event();
 
   auto event = stream->fill(dstDevice, value, n);
 
   if (!async) {
     event.wait();
   }
+  return event;
 }
 
 SYCLError_t SYCLMemcpyDtoH(void* dstHost, const void* srcDevice,
@@ -390,26 +452,51 @@ SYCLError_t SYCLMemcpyDtoD(void* dstDevice, const void* srcDevice,
 }
 
 SYCLError_t SYCLMemcpyDtoHAsync(void* dstHost, const void* srcDevice,
-                                size_t ByteCount, sycl::queue* stream) {
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event) {
   sycl::usm::alloc DstAllocType =
       get_pointer_type(dstHost, stream->get_context());
-  memcpyDeviceToHost(dstHost, srcDevice, ByteCount,
-                     DstAllocType == sycl::usm::alloc::host, stream);
+  auto copy_event =
+      memcpyDeviceToHost(dstHost, srcDevice, ByteCount,
+                         DstAllocType == sycl::usm::alloc::host, stream);
+  if (event != nullptr) *event = copy_event;
   return SYCL_SUCCESS;
 }
 
 SYCLError_t SYCLMemcpyHtoDAsync(void* dstDevice, const void* srcHost,
-                                size_t ByteCount, sycl::queue* stream) {
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event) {
   sycl::usm::alloc SrcAllocType =
       get_pointer_type(srcHost, stream->get_context());
-  memcpyHostToDevice(dstDevice, srcHost, ByteCount,
-                     SrcAllocType == sycl::usm::alloc::host, stream);
+  // Pageable source: stage it so the copy stays stream-ordered instead of
+  // blocking the host until the device has consumed `srcHost`. Without a
+  // staging buffer the copy below blocks.
+  void* staging = nullptr;
+  if (SrcAllocType == sycl::usm::alloc::unknown && ByteCount != 0 &&
+      ByteCount <= StagingPool::kMaxStagedCopyBytes) {
+    staging = StagingPool::Get().Acquire(stream, ByteCount);
+  }
+  sycl::event copy_event;
+  if (staging != nullptr) {
+    std::memcpy(staging, srcHost, ByteCount);
+    copy_event =
+        memcpyHostToDevice(dstDevice, staging, ByteCount, true, stream);
+    StagingPool::Get().Track(stream, staging, copy_event);
+  } else {
+    copy_event =
+        memcpyHostToDevice(dstDevice, srcHost, ByteCount,
+                           SrcAllocType == sycl::usm::alloc::host, stream);
+  }
+  if (event != nullptr) *event = copy_event;
   return SYCL_SUCCESS;
 }
 
 SYCLError_t SYCLMemcpyDtoDAsync(void* dstDevice, const void* srcDevice,
-                                size_t ByteCount, sycl::queue* stream) {
-  memcpyDeviceToDevice(dstDevice, srcDevice, ByteCount, true, stream);
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event) {
+  auto copy_event =
+      memcpyDeviceToDevice(dstDevice, srcDevice, ByteCount, true, stream);
+  if (event != nullptr) *event = copy_event;
   return SYCL_SUCCESS;
 }
 
@@ -422,8 +509,9 @@ SYCLError_t SYCLMemsetD8(void* dstDevice, unsigned char uc, size_t N,
 }
 
 SYCLError_t SYCLMemsetD8Async(void* dstDevice, unsigned char uc, size_t N,
-                              sycl::queue* stream) {
-  memsetDeviceD8(dstDevice, uc, N, true, stream);
+                              sycl::queue* stream, sycl::event* event) {
+  auto memset_event = memsetDeviceD8(dstDevice, uc, N, true, stream);
+  if (event != nullptr) *event = memset_event;
   return SYCL_SUCCESS;
 }
 
@@ -436,8 +524,16 @@ SYCLError_t SYCLMemsetD32(void* dstDevice, unsigned int ui, size_t N,
 }
 
 SYCLError_t SYCLMemsetD32Async(void* dstDevice, unsigned int ui, size_t N,
-                               sycl::queue* stream) {
-  memsetDeviceD32(dstDevice, ui, N, true, stream);
+                               sycl::queue* stream, sycl::event* event) {
+  auto memset_event = memsetDeviceD32(dstDevice, ui, N, true, stream);
+  if (event != nullptr) *event = memset_event;
+  return SYCL_SUCCESS;
+}
+
+SYCLError_t SYCLStreamSynchronize(sycl::queue* stream) {
+  if (stream == nullptr) return SYCL_ERROR_INVALID_STREAM;
+  stream->wait();
+  StagingPool::Get().ReleaseCompleted(stream, /*wait=*/true);
   return SYCL_SUCCESS;
 }
 
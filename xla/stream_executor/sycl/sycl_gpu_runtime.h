@@ -64,12 +64,20 @@ SYCLError_t SYCLGetDeviceCount(int* count);
 
 SYCLError_t SYCLGetDevice(sycl::device** device, int device_ordinal);
 
-SYCLError_t SYCLCreateStream(sycl::device* device_handle, sycl::queue** stream);
+// A non-zero `priority` (see GpuDriver::GetGpuStreamPriority) always creates a
+// dedicated queue, even when XLA_ENABLE_MULTIPLE_STREAM is off.
+SYCLError_t SYCLCreateStream(sycl::device* device_handle, sycl::queue** stream,
+                             int priority = 0);
 
 SYCLError_t SYCLDestroyStream(sycl::device* device_handle, sycl::queue* stream);
 
 SYCLError_t SYCLCtxSynchronize(sycl::device* device_handle);
 
+// Blocks the host until all work enqueued on `stream` has completed. This is a
+// true sync point: host staging buffers held by in-flight asynchronous copies
+// on `stream` are released here.
+SYCLError_t SYCLStreamSynchronize(sycl::queue* stream);
+
 SYCLError_t SYCLMemcpyDtoH(void* dstHost, const void* srcDevice,
                            size_t ByteCount, sycl::device* device);
 
@@ -79,26 +87,37 @@ SYCLError_t SYCLMemcpyHtoD(void* dstDevice, const void* srcHost,
 SYCLError_t SYCLMemcpyDtoD(void* dstDevice, const void* srcDevice,
                            size_t ByteCount, sycl::device* device);
 
+// The *Async variants below are stream-ordered: they enqueue the operation on
+// `stream` and, if `event` is not null, return the event of the enqueued
+// operation through it. Host-to-device copies from pageable memory are staged
+// through host USM so that `srcHost` may be reused as soon as the call returns
+// without waiting for the device. Device-to-host copies into pageable memory
+// still complete before returning.
 SYCLError_t SYCLMemcpyDtoHAsync(void* dstHost, const void* srcDevice,
-                                size_t ByteCount, sycl::queue* stream);
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event = nullptr);
 
 SYCLError_t SYCLMemcpyHtoDAsync(void* dstDevice, const void* srcHost,
-                                size_t ByteCount, sycl::queue* stream);
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event = nullptr);
 
 SYCLError_t SYCLMemcpyDtoDAsync(void* dstDevice, const void* srcDevice,
-                                size_t ByteCount, sycl::queue* stream);
+                                size_t ByteCount, sycl::queue* stream,
+                                sycl::event* event = nullptr);
 
 SYCLError_t SYCLMemsetD8(void* dstDevice, unsigned char uc, size_t N,
                          sycl::device* device);
 
 SYCLError_t SYCLMemsetD8Async(void* dstDevice, unsigned char uc, size_t N,
-                              sycl::queue* stream);
+                              sycl::queue* stream,
+                              sycl::event* event = nullptr);
 
 SYCLError_t SYCLMemsetD32(void* dstDevice, unsigned int ui, size_t N,
                           sycl::device* device);
 
 SYCLError_t SYCLMemsetD32Async(void* dstDevice, unsigned int ui, size_t N,
-                               sycl::queue* stream);
+                               sycl::queue* stream,
+                               sycl::event* event = nullptr);
 
 void* SYCLMalloc(sycl::device* device, size_t ByteCount);
 
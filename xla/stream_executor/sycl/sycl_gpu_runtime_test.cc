@@ -0,0 +1,132 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+
+namespace {
+
+// Returns a queue of the first device, or nullptr without one.
+sycl::queue* GetQueue(sycl::device** device) {
+  int count = 0;
+  if (SYCLGetDeviceCount(&count) != SYCL_SUCCESS || count == 0) return nullptr;
+  if (SYCLGetDevice(device, 0) != SYCL_SUCCESS) return nullptr;
+  sycl::queue* queue = nullptr;
+  if (SYCLCreateStream(*device, &queue) != SYCL_SUCCESS) return nullptr;
+  return queue;
+}
+
+std::vector<uint8_t> Pattern(size_t bytes, uint8_t seed) {
+  std::vector<uint8_t> data(bytes);
+  for (size_t i = 0; i < bytes; ++i) data[i] = (i * 7 + seed) % 251;
+  return data;
+}
+
+class SyclGpuRuntimeTest : public ::testing::TestWithParam<size_t> {
+ protected:
+  void SetUp() override {
+    queue_ = GetQueue(&device_);
+    if (queue_ == nullptr) GTEST_SKIP() << "No GPU found";
+  }
+  void TearDown() override {
+    if (queue_ != nullptr) SYCLDestroyStream(device_, queue_);
+  }
+
+  sycl::device* device_ = nullptr;
+  sycl::queue* queue_ = nullptr;
+};
+
+// A pageable source may be reused as soon as the asynchronous copy returns:
+// small copies go through a staging buffer, larger ones block.
+TEST_P(SyclGpuRuntimeTest, AsyncCopyFromPageableMemoryOwnsItsSource) {
+  const size_t bytes = GetParam();
+  std::vector<uint8_t> expected = Pattern(bytes, 1);
+  std::vector<uint8_t> source = expected;
+  void* device_buffer = SYCLMalloc(device_, bytes);
+  ASSERT_NE(device_buffer, nullptr);
+
+  ASSERT_EQ(SYCLMemcpyHtoDAsync(device_buffer, source.data(), bytes, queue_),
+            SYCL_SUCCESS);
+  std::memset(source.data(), 0, bytes);
+  ASSERT_EQ(SYCLStreamSynchronize(queue_), SYCL_SUCCESS);
+
+  std::vector<uint8_t> result(bytes);
+  ASSERT_EQ(SYCLMemcpyDtoH(result.data(), device_buffer, bytes, device_),
+            SYCL_SUCCESS);
+  EXPECT_EQ(result, expected);
+  SYCLFree(device_, device_buffer);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sizes, SyclGpuRuntimeTest,
+                         ::testing::Values(1, 4096, 1 << 20, 16 << 20,
+                                           (16 << 20) + 1));
+
+enum CopyMode { kStagedPageable, kPinnedSource, kBlockingPageable };
+
+// Host-to-device copies of range(0) bytes. Eight copies are kept in flight
+// between synchronizations, so asynchronous copies overlap with the host:
+//   kStagedPageable: SYCLMemcpyHtoDAsync from pageable memory, staged through
+//     the pinned pool up to StagingPool::kMaxStagedCopyBytes.
+//   kPinnedSource: SYCLMemcpyHtoDAsync from host USM, copied directly.
+//   kBlockingPageable: SYCLMemcpyHtoD from pageable memory, as before staging.
+void BM_MemcpyHtoD(::testing::benchmark::State& state) {
+  constexpr int kCopiesInFlight = 8;
+  sycl::device* device = nullptr;
+  sycl::queue* queue = GetQueue(&device);
+  if (queue == nullptr) {
+    state.SkipWithError("No GPU found");
+    return;
+  }
+  const size_t bytes = state.range(0);
+  const auto mode = static_cast<CopyMode>(state.range(1));
+
+  std::vector<uint8_t> pageable = Pattern(bytes, 0);
+  void* pinned = SYCLMallocHost(device, bytes);
+  std::memcpy(pinned, pageable.data(), bytes);
+  void* device_buffer = SYCLMalloc(device, bytes);
+
+  for (auto s : state) {
+    for (int i = 0; i < kCopiesInFlight; ++i) {
+      switch (mode) {
+        case kStagedPageable:
+          SYCLMemcpyHtoDAsync(device_buffer, pageable.data(), bytes, queue);
+          break;
+        case kPinnedSource:
+          SYCLMemcpyHtoDAsync(device_buffer, pinned, bytes, queue);
+          break;
+        case kBlockingPageable:
+          SYCLMemcpyHtoD(device_buffer, pageable.data(), bytes, device);
+          break;
+      }
+    }
+    SYCLStreamSynchronize(queue);
+  }
+  state.SetBytesProcessed(state.iterations() * kCopiesInFlight * bytes);
+
+  SYCLFree(device, device_buffer);
+  SYCLFree(device, pinned);
+  SYCLDestroyStream(device, queue);
+}
+BENCHMARK(BM_MemcpyHtoD)
+    ->ArgsProduct({{4 << 10, 256 << 10, 4 << 20, 16 << 20, 64 << 20},
+                   {kStagedPageable, kPinnedSource, kBlockingPageable}})
+    ->UseRealTime();
+
+}  // namespace
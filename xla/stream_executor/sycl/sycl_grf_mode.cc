@@ -0,0 +1,101 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_grf_mode.h"
+
+#include <string>
+
+#include "absl/base/const_init.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/platform/logging.h"
+#include "tsl/util/env_var.h"
+#include "xla/stream_executor/sycl/sycl_kernel.h"
+
+namespace stream_executor {
+namespace gpu {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex grf_mode_mu(absl::kConstInit);
+
+absl::flat_hash_map<uint64_t, GrfMode>& AutoGrfModes()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(grf_mode_mu) {
+  static auto* modes = new absl::flat_hash_map<uint64_t, GrfMode>();
+  return *modes;
+}
+
+absl::flat_hash_map<ze_module_handle_t, GrfMode>& ModuleGrfModes()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(grf_mode_mu) {
+  static auto* modes = new absl::flat_hash_map<ze_module_handle_t, GrfMode>();
+  return *modes;
+}
+
+}  // namespace
+
+GrfMode GetGrfModePolicy() {
+  static GrfMode policy = [] {
+    std::string mode;
+    TF_CHECK_OK(tsl::ReadStringFromEnvVar("XLA_GPU_GRF_MODE", "default", &mode));
+    mode = absl::AsciiStrToLower(mode);
+    if (mode == "large") return GrfMode::kLarge;
+    if (mode == "auto") return GrfMode::kAuto;
+    if (mode != "default") {
+      LOG(WARNING) << "Unknown XLA_GPU_GRF_MODE \"" << mode
+                   << "\", using the default GRF mode";
+    }
+    return GrfMode::kDefault;
+  }();
+  return policy;
+}
+
+const char* GrfModeBuildFlags(GrfMode mode) {
+  return mode == GrfMode::kLarge ? "-ze-opt-large-register-file" : "";
+}
+
+int GrfCount(GrfMode mode) {
+  return mode == GrfMode::kLarge ? sycl::kLargeGrfCount
+                                 : sycl::kDefaultGrfCount;
+}
+
+GrfMode LookupAutoGrfMode(uint64_t fingerprint) {
+  absl::MutexLock lock(&grf_mode_mu);
+  auto it = AutoGrfModes().find(fingerprint);
+  return it == AutoGrfModes().end() ? GrfMode::kAuto : it->second;
+}
+
+void RecordAutoGrfMode(uint64_t fingerprint, GrfMode mode) {
+  absl::MutexLock lock(&grf_mode_mu);
+  AutoGrfModes()[fingerprint] = mode;
+}
+
+void RecordModuleGrfMode(ze_module_handle_t module, GrfMode mode) {
+  absl::MutexLock lock(&grf_mode_mu);
+  ModuleGrfModes()[module] = mode;
+}
+
+void ForgetModuleGrfMode(ze_module_handle_t module) {
+  absl::MutexLock lock(&grf_mode_mu);
+  ModuleGrfModes().erase(module);
+}
+
+GrfMode GetModuleGrfMode(ze_module_handle_t module) {
+  absl::MutexLock lock(&grf_mode_mu);
+  auto it = ModuleGrfModes().find(module);
+  return it == ModuleGrfModes().end() ? GrfMode::kDefault : it->second;
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
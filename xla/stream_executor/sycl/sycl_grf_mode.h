@@ -0,0 +1,63 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_GRF_MODE_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_GRF_MODE_H_
+
+#include <cstdint>
+
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
+
+namespace stream_executor {
+namespace gpu {
+
+// Register file mode a Level Zero module is built in.
+enum class GrfMode {
+  kDefault,  // 128 GRF entries per hardware thread.
+  kLarge,    // 256 GRF entries, half the hardware threads per EU.
+  // Build in the default mode and rebuild in the large mode if any kernel of
+  // the module spills registers.
+  kAuto,
+};
+
+// XLA_GPU_GRF_MODE
+//   "default" (default behaviour): Build modules in the default GRF mode.
+//   "large": Build modules with -ze-opt-large-register-file.
+//   "auto": Use the large mode for modules whose kernels spill in the default
+//           mode. The decision is cached per SPIR-V binary.
+// Devices without large GRF support always use the default mode.
+GrfMode GetGrfModePolicy();
+
+// zeModuleCreate build flags selecting `mode`.
+const char* GrfModeBuildFlags(GrfMode mode);
+
+// Number of GRF entries per hardware thread in `mode`.
+int GrfCount(GrfMode mode);
+
+// Winner of the "auto" policy for the SPIR-V binary with `fingerprint`, if
+// it was decided before. Returns kAuto when it was not.
+GrfMode LookupAutoGrfMode(uint64_t fingerprint);
+void RecordAutoGrfMode(uint64_t fingerprint, GrfMode mode);
+
+// Records the mode `module` was built in, so that kernel metadata can report
+// the registers its kernels have.
+void RecordModuleGrfMode(ze_module_handle_t module, GrfMode mode);
+void ForgetModuleGrfMode(ze_module_handle_t module);
+GrfMode GetModuleGrfMode(ze_module_handle_t module);
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_GRF_MODE_H_
@@ -17,6 +17,51 @@ limitations under the License.
 
 #include "xla/stream_executor/sycl/sycl_kernel.h"
 
+#include "absl/strings/str_format.h"
+#include "tsl/platform/errors.h"
+
 namespace stream_executor {
 namespace gpu {}  // namespace gpu
+
+namespace sycl {
+
+std::string KernelProperties::ToString() const {
+  return absl::StrFormat(
+      "grf=%d slm=%dB private=%dB spill=%dB sub_group=%d(max %d) "
+      "max_sub_groups=%d",
+      grf_count, slm_bytes, private_memory_bytes, spill_memory_bytes,
+      required_sub_group_size, max_sub_group_size, max_num_sub_groups);
+}
+
+KernelProperties ParseKernelProperties(const ze_kernel_properties_t& props,
+                                       int grf_count) {
+  KernelProperties properties;
+  properties.grf_count = grf_count;
+  properties.slm_bytes = props.localMemSize;
+  properties.private_memory_bytes = props.privateMemSize;
+  properties.spill_memory_bytes = props.spillMemSize;
+  properties.required_sub_group_size = props.requiredSubgroupSize;
+  properties.max_sub_group_size = props.maxSubgroupSize;
+  properties.max_num_sub_groups = props.maxNumSubgroups;
+  return properties;
+}
+
+tsl::StatusOr<KernelProperties> GetKernelProperties(
+    const ::sycl::kernel& kernel, int grf_count) {
+  if (kernel.get_backend() != ::sycl::backend::ext_oneapi_level_zero) {
+    return tsl::errors::Unimplemented(
+        "Kernel properties are only available on the Level Zero backend");
+  }
+  auto ze_kernel =
+      ::sycl::get_native<::sycl::backend::ext_oneapi_level_zero>(kernel);
+  ze_kernel_properties_t props = {};
+  props.stype = ZE_STRUCTURE_TYPE_KERNEL_PROPERTIES;
+  ze_result_t status = zeKernelGetProperties(ze_kernel, &props);
+  if (status != ZE_RESULT_SUCCESS) {
+    return tsl::errors::Internal("zeKernelGetProperties failed: ", status);
+  }
+  return ParseKernelProperties(props, grf_count);
+}
+
+}  // namespace sycl
 }  // namespace stream_executor
@@ -24,13 +24,53 @@ limitations under the License.
 #ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_KERNEL_H_
 #define XLA_STREAM_EXECUTOR_SYCL_SYCL_KERNEL_H_
 
+#include <cstdint>
+#include <string>
+
+#include "tsl/platform/statusor.h"
 #include "xla/stream_executor/gpu/gpu_kernel.h"
+#include "xla/stream_executor/sycl/sycl_gpu_runtime.h"
 
 namespace stream_executor {
 namespace sycl {
 
 using SYCLKernel = gpu::GpuKernel;
 
+// Number of general register file entries per hardware thread in the default
+// GRF mode, and in the large GRF mode selected by -ze-opt-large-register-file.
+constexpr int kDefaultGrfCount = 128;
+constexpr int kLargeGrfCount = 256;
+
+// Resource usage of a compiled kernel as reported by the Level Zero driver.
+struct KernelProperties {
+  int grf_count = kDefaultGrfCount;
+  // Static shared local memory used by the kernel.
+  int64_t slm_bytes = 0;
+  // Private (scratch) memory per work item, including register spills.
+  int64_t private_memory_bytes = 0;
+  int64_t spill_memory_bytes = 0;
+  // Sub-group size the kernel was compiled for; 0 if the compiler chose it.
+  int required_sub_group_size = 0;
+  int max_sub_group_size = 0;
+  // Maximum number of sub-groups per work-group the kernel supports.
+  int max_num_sub_groups = 0;
+
+  int64_t max_work_group_size() const {
+    return static_cast<int64_t>(max_sub_group_size) * max_num_sub_groups;
+  }
+
+  std::string ToString() const;
+};
+
+// Converts driver-reported properties of a kernel compiled with `grf_count`
+// registers per thread.
+KernelProperties ParseKernelProperties(const ze_kernel_properties_t& props,
+                                       int grf_count = kDefaultGrfCount);
+
+// Queries the Level Zero driver for the properties of `kernel`.
+tsl::StatusOr<KernelProperties> GetKernelProperties(
+    const ::sycl::kernel& kernel, int grf_count = kDefaultGrfCount);
+
 }  // namespace sycl
 }  // namespace stream_executor
 
@@ -0,0 +1,65 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_KERNEL_ARGS_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_KERNEL_ARGS_H_
+
+#include <cstddef>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
+
+namespace stream_executor {
+namespace sycl {
+
+// Argument values bound to a Level Zero kernel handle. The handle keeps its
+// arguments across launches, so a launch only needs to set the arguments that
+// changed since the previous one. All arguments of XLA kernels are device
+// pointers, so the layout of a kernel is just its number of arguments.
+//
+// Not thread-safe; guard it together with the kernel handle.
+class KernelArgumentCache {
+ public:
+  // Calls `set_arg(index, value)`, which returns whether it succeeded, for
+  // every argument that differs from the bound one, or for all arguments if
+  // the arity changed. On failure the bound arguments are forgotten, since the
+  // state of the handle is unknown, and false is returned.
+  template <typename SetArg>
+  bool Bind(absl::Span<void* const> args, SetArg set_arg) {
+    bool all = bound_.size() != args.size();
+    if (all) bound_.assign(args.size(), nullptr);
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (!all && bound_[i] == args[i]) continue;
+      if (!set_arg(i, args[i])) {
+        bound_.clear();
+        return false;
+      }
+      bound_[i] = args[i];
+    }
+    return true;
+  }
+
+  // Forgets the bound arguments, e.g. after they were set by someone else.
+  void Clear() { bound_.clear(); }
+
+ private:
+  // Matches the inline argument pack of GpuExecutor::Launch.
+  absl::InlinedVector<void*, 16> bound_;
+};
+
+}  // namespace sycl
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_KERNEL_ARGS_H_
@@ -0,0 +1,109 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_kernel_args.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace stream_executor {
+namespace sycl {
+namespace {
+
+// Records the arguments set on a fake kernel handle.
+class FakeHandle {
+ public:
+  bool Bind(KernelArgumentCache& cache, std::vector<void*> args) {
+    set_.clear();
+    return cache.Bind(args, [this](size_t index, void* value) {
+      if (index == fail_index_) return false;
+      set_.push_back({index, value});
+      return true;
+    });
+  }
+
+  std::vector<std::pair<size_t, void*>> set_;
+  size_t fail_index_ = -1;
+};
+
+void* Ptr(uintptr_t value) { return reinterpret_cast<void*>(value); }
+
+TEST(KernelArgumentCacheTest, SetsAllArgumentsOnFirstLaunch) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), nullptr}));
+  EXPECT_EQ(handle.set_, (std::vector<std::pair<size_t, void*>>{
+                             {0, Ptr(1)}, {1, Ptr(2)}, {2, nullptr}}));
+}
+
+TEST(KernelArgumentCacheTest, SetsOnlyChangedArguments) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), Ptr(3)}));
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), Ptr(3)}));
+  EXPECT_TRUE(handle.set_.empty());
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(4), Ptr(3)}));
+  EXPECT_EQ(handle.set_,
+            (std::vector<std::pair<size_t, void*>>{{1, Ptr(4)}}));
+}
+
+TEST(KernelArgumentCacheTest, SetsAllArgumentsWhenArityChanges) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2)}));
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), Ptr(3)}));
+  EXPECT_EQ(handle.set_.size(), 3);
+}
+
+TEST(KernelArgumentCacheTest, ForgetsBoundArgumentsOnFailure) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), Ptr(3)}));
+  handle.fail_index_ = 1;
+  EXPECT_FALSE(handle.Bind(cache, {Ptr(5), Ptr(6), Ptr(3)}));
+  handle.fail_index_ = -1;
+  // Argument 0 was set before the failure, but all are set again.
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2), Ptr(3)}));
+  EXPECT_EQ(handle.set_.size(), 3);
+}
+
+TEST(KernelArgumentCacheTest, SetsAllArgumentsAfterClear) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2)}));
+  cache.Clear();
+  ASSERT_TRUE(handle.Bind(cache, {Ptr(1), Ptr(2)}));
+  EXPECT_EQ(handle.set_.size(), 2);
+}
+
+TEST(KernelArgumentCacheTest, ManyArguments) {
+  KernelArgumentCache cache;
+  FakeHandle handle;
+  std::vector<void*> args;
+  for (uintptr_t i = 1; i <= 40; ++i) args.push_back(Ptr(i));
+  ASSERT_TRUE(handle.Bind(cache, args));
+  EXPECT_EQ(handle.set_.size(), 40);
+  args[39] = Ptr(100);
+  ASSERT_TRUE(handle.Bind(cache, args));
+  EXPECT_EQ(handle.set_,
+            (std::vector<std::pair<size_t, void*>>{{39, Ptr(100)}}));
+}
+
+}  // namespace
+}  // namespace sycl
+}  // namespace stream_executor
@@ -0,0 +1,85 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_kernel.h"
+
+#include "tsl/platform/test.h"
+
+namespace stream_executor {
+namespace sycl {
+namespace {
+
+ze_kernel_properties_t DriverProperties() {
+  ze_kernel_properties_t props = {};
+  props.stype = ZE_STRUCTURE_TYPE_KERNEL_PROPERTIES;
+  props.localMemSize = 65536;
+  props.privateMemSize = 2048;
+  props.spillMemSize = 512;
+  props.requiredSubgroupSize = 16;
+  props.maxSubgroupSize = 32;
+  props.maxNumSubgroups = 64;
+  return props;
+}
+
+TEST(ParseKernelPropertiesTest, CopiesDriverProperties) {
+  KernelProperties properties = ParseKernelProperties(DriverProperties());
+  EXPECT_EQ(properties.grf_count, kDefaultGrfCount);
+  EXPECT_EQ(properties.slm_bytes, 65536);
+  EXPECT_EQ(properties.private_memory_bytes, 2048);
+  EXPECT_EQ(properties.spill_memory_bytes, 512);
+  EXPECT_EQ(properties.required_sub_group_size, 16);
+  EXPECT_EQ(properties.max_sub_group_size, 32);
+  EXPECT_EQ(properties.max_num_sub_groups, 64);
+  EXPECT_EQ(properties.max_work_group_size(), 32 * 64);
+}
+
+TEST(ParseKernelPropertiesTest, KeepsTheGrfCountOfTheBuild) {
+  KernelProperties properties =
+      ParseKernelProperties(DriverProperties(), kLargeGrfCount);
+  EXPECT_EQ(properties.grf_count, kLargeGrfCount);
+}
+
+TEST(ParseKernelPropertiesTest, EmptyPropertiesMeanNoResources) {
+  ze_kernel_properties_t props = {};
+  KernelProperties properties = ParseKernelProperties(props);
+  EXPECT_EQ(properties.slm_bytes, 0);
+  EXPECT_EQ(properties.private_memory_bytes, 0);
+  EXPECT_EQ(properties.spill_memory_bytes, 0);
+  // A sub-group size of zero means the compiler chose it.
+  EXPECT_EQ(properties.required_sub_group_size, 0);
+  EXPECT_EQ(properties.max_work_group_size(), 0);
+}
+
+TEST(ParseKernelPropertiesTest, KeepsLargeSizesIntact) {
+  ze_kernel_properties_t props = DriverProperties();
+  props.privateMemSize = 0xffffffffu;
+  props.maxSubgroupSize = 0xffffffffu / 2;
+  props.maxNumSubgroups = 64;
+  KernelProperties properties = ParseKernelProperties(props);
+  EXPECT_EQ(properties.private_memory_bytes, int64_t{0xffffffff});
+  // The product does not overflow int.
+  EXPECT_EQ(properties.max_work_group_size(), int64_t{0xffffffffu / 2} * 64);
+}
+
+TEST(ParseKernelPropertiesTest, ToStringNamesEveryField) {
+  EXPECT_EQ(ParseKernelProperties(DriverProperties(), kLargeGrfCount)
+                .ToString(),
+            "grf=256 slm=65536B private=2048B spill=512B sub_group=16(max 32) "
+            "max_sub_groups=64");
+}
+
+}  // namespace
+}  // namespace sycl
+}  // namespace stream_executor
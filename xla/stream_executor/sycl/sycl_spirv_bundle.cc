@@ -0,0 +1,100 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_spirv_bundle.h"
+
+#include <cstring>
+
+#include "tsl/platform/errors.h"
+
+namespace stream_executor {
+namespace gpu {
+namespace {
+
+// Distinct from the SPIR-V magic number 0x07230203 in either byte order.
+constexpr uint32_t kBundleMagic = 0x56505358;  // "XSPV"
+constexpr size_t kAlignment = 8;
+
+size_t AlignUp(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+void Append(std::vector<uint8_t>* out, T value) {
+  size_t offset = out->size();
+  out->resize(offset + sizeof(T));
+  std::memcpy(out->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T Read(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+}  // namespace
+
+std::vector<uint8_t> PackSpirvModules(
+    absl::Span<const std::vector<uint8_t>> modules) {
+  if (modules.size() == 1) return modules[0];
+
+  size_t total = 2 * sizeof(uint32_t);
+  for (const auto& module : modules) {
+    total += sizeof(uint64_t) + AlignUp(module.size());
+  }
+  std::vector<uint8_t> bundle;
+  bundle.reserve(total);
+  Append<uint32_t>(&bundle, kBundleMagic);
+  Append<uint32_t>(&bundle, modules.size());
+  for (const auto& module : modules) {
+    Append<uint64_t>(&bundle, module.size());
+    bundle.insert(bundle.end(), module.begin(), module.end());
+    bundle.resize(bundle.size() + AlignUp(module.size()) - module.size(), 0);
+  }
+  return bundle;
+}
+
+bool IsSpirvBundle(const char* data, size_t size) {
+  return size >= 2 * sizeof(uint32_t) && Read<uint32_t>(data) == kBundleMagic;
+}
+
+tsl::StatusOr<std::vector<absl::Span<const uint8_t>>> UnpackSpirvModules(
+    const char* data, size_t size) {
+  if (!IsSpirvBundle(data, size)) {
+    return tsl::errors::InvalidArgument("Not a SPIR-V bundle");
+  }
+  uint32_t count = Read<uint32_t>(data + sizeof(uint32_t));
+  size_t offset = 2 * sizeof(uint32_t);
+  std::vector<absl::Span<const uint8_t>> modules;
+  modules.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (offset + sizeof(uint64_t) > size) {
+      return tsl::errors::InvalidArgument("Truncated SPIR-V bundle");
+    }
+    uint64_t module_size = Read<uint64_t>(data + offset);
+    offset += sizeof(uint64_t);
+    if (module_size > size - offset) {
+      return tsl::errors::InvalidArgument("Truncated SPIR-V bundle");
+    }
+    modules.emplace_back(reinterpret_cast<const uint8_t*>(data + offset),
+                         module_size);
+    offset += AlignUp(module_size);
+  }
+  return modules;
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
@@ -0,0 +1,49 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_SPIRV_BUNDLE_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_SPIRV_BUNDLE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tsl/platform/statusor.h"
+
+namespace stream_executor {
+namespace gpu {
+
+// A SPIR-V bundle carries the SPIR-V modules translated in parallel from the
+// partitions of one LLVM module. The loader links them into a single Level
+// Zero module, so kernels are looked up by name as with a plain SPIR-V binary.
+//
+// Layout: magic, module count, then per module its size in bytes followed by
+// its words, padded to 8 bytes. All integers are little endian.
+
+// Packs `modules` into a bundle. A single module is returned unchanged.
+std::vector<uint8_t> PackSpirvModules(
+    absl::Span<const std::vector<uint8_t>> modules);
+
+// Returns true if `data` is a bundle rather than a plain SPIR-V binary.
+bool IsSpirvBundle(const char* data, size_t size);
+
+// Returns views of the modules in the bundle `data`.
+tsl::StatusOr<std::vector<absl::Span<const uint8_t>>> UnpackSpirvModules(
+    const char* data, size_t size);
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_SPIRV_BUNDLE_H_
@@ -0,0 +1,193 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_STAGING_POOL_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_STAGING_POOL_H_
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace stream_executor {
+namespace sycl {
+
+// Pinned host buffers backing in-flight host-to-device copies from pageable
+// memory. Buffers are rounded up to a power of two and reused once the copy
+// that used them has completed. Streams are in-order, so the pending copies
+// of a stream complete in submission order and are reclaimed from the front.
+//
+// The pinned memory held by the pool never exceeds `max_pool_bytes`. When a
+// buffer cannot be found within that bound, or the allocation fails, Acquire
+// returns nullptr and the caller copies synchronously instead.
+//
+// `Backend` provides the stream and event types and
+//   static void* Allocate(Stream* stream, size_t bytes);
+//   static void Free(Stream* stream, void* ptr);
+//   static bool IsComplete(const Event& event);
+// Templated so that the pool can be tested on the host.
+template <typename Backend>
+class StagingBufferPool {
+ public:
+  using Stream = typename Backend::Stream;
+  using Event = typename Backend::Event;
+
+  static constexpr size_t kMinBufferBytes = 4 << 10;
+
+  explicit StagingBufferPool(size_t max_pool_bytes)
+      : max_pool_bytes_(max_pool_bytes) {}
+
+  // All copies of the pool must have completed.
+  ~StagingBufferPool() {
+    for (auto& [stream, state] : streams_) {
+      for (PendingCopy& copy : state.pending) Backend::Free(stream, copy.ptr);
+      for (auto& [capacity, ptr] : state.idle) Backend::Free(stream, ptr);
+    }
+  }
+
+  // Returns a buffer of at least `bytes` that the caller owns until it passes
+  // it to Track or Return.
+  void* Acquire(Stream* stream, size_t bytes) {
+    absl::MutexLock lock(&mu_);
+    StreamState& state = streams_[stream];
+    Reclaim(stream, state, /*wait=*/false);
+    auto idle = state.idle.lower_bound(bytes);
+    if (idle != state.idle.end()) {
+      void* ptr = idle->second;
+      in_use_[ptr] = idle->first;
+      state.idle.erase(idle);
+      return ptr;
+    }
+
+    const size_t capacity = BufferBytes(bytes);
+    if (capacity > max_pool_bytes_) return nullptr;
+    if (pool_bytes_ + capacity > max_pool_bytes_) {
+      // Make room by releasing idle buffers, including those of copies on
+      // other streams that have completed since.
+      for (auto& [other, other_state] : streams_) {
+        Reclaim(other, other_state, /*wait=*/false);
+      }
+      for (auto& [other, other_state] : streams_) {
+        while (!other_state.idle.empty() &&
+               pool_bytes_ + capacity > max_pool_bytes_) {
+          auto largest = std::prev(other_state.idle.end());
+          Backend::Free(other, largest->second);
+          pool_bytes_ -= largest->first;
+          other_state.idle.erase(largest);
+        }
+      }
+      if (pool_bytes_ + capacity > max_pool_bytes_) return nullptr;
+    }
+    void* ptr = Backend::Allocate(stream, capacity);
+    if (ptr == nullptr) return nullptr;
+    pool_bytes_ += capacity;
+    in_use_[ptr] = capacity;
+    return ptr;
+  }
+
+  // Hands back a buffer from Acquire once the copy reading it is enqueued.
+  void Track(Stream* stream, void* ptr, Event event) {
+    absl::MutexLock lock(&mu_);
+    size_t capacity = TakeInUse(ptr);
+    streams_[stream].pending.push_back({std::move(event), ptr, capacity});
+  }
+
+  // Hands back a buffer from Acquire that no copy reads.
+  void Return(Stream* stream, void* ptr) {
+    absl::MutexLock lock(&mu_);
+    size_t capacity = TakeInUse(ptr);
+    streams_[stream].idle.emplace(capacity, ptr);
+  }
+
+  // Makes the buffers of completed copies on `stream` reusable. If `wait` is
+  // true the caller has already waited for `stream`, so every pending copy
+  // has completed.
+  void ReleaseCompleted(Stream* stream, bool wait) {
+    absl::MutexLock lock(&mu_);
+    auto iter = streams_.find(stream);
+    if (iter != streams_.end()) Reclaim(stream, iter->second, wait);
+  }
+
+  // Frees the buffers of a stream that the caller has waited for and is
+  // about to destroy.
+  void RemoveStream(Stream* stream) {
+    absl::MutexLock lock(&mu_);
+    auto iter = streams_.find(stream);
+    if (iter == streams_.end()) return;
+    Reclaim(stream, iter->second, /*wait=*/true);
+    for (auto& [capacity, ptr] : iter->second.idle) {
+      Backend::Free(stream, ptr);
+      pool_bytes_ -= capacity;
+    }
+    streams_.erase(iter);
+  }
+
+  size_t pool_bytes() const {
+    absl::MutexLock lock(&mu_);
+    return pool_bytes_;
+  }
+
+ private:
+  struct PendingCopy {
+    Event event;
+    void* ptr;
+    size_t capacity;
+  };
+
+  struct StreamState {
+    std::deque<PendingCopy> pending;
+    // Capacity to buffer.
+    std::multimap<size_t, void*> idle;
+  };
+
+  static size_t BufferBytes(size_t bytes) {
+    size_t capacity = kMinBufferBytes;
+    while (capacity < bytes) capacity <<= 1;
+    return capacity;
+  }
+
+  void Reclaim(Stream* stream, StreamState& state, bool wait)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (!state.pending.empty()) {
+      PendingCopy& front = state.pending.front();
+      if (!wait && !Backend::IsComplete(front.event)) break;
+      state.idle.emplace(front.capacity, front.ptr);
+      state.pending.pop_front();
+    }
+  }
+
+  size_t TakeInUse(void* ptr) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto iter = in_use_.find(ptr);
+    size_t capacity = iter->second;
+    in_use_.erase(iter);
+    return capacity;
+  }
+
+  const size_t max_pool_bytes_;
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<Stream*, StreamState> streams_ ABSL_GUARDED_BY(mu_);
+  // Acquired buffers not yet tracked or returned, with their capacity.
+  absl::flat_hash_map<void*, size_t> in_use_ ABSL_GUARDED_BY(mu_);
+  size_t pool_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace sycl
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_STAGING_POOL_H_
@@ -0,0 +1,180 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_staging_pool.h"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "tsl/platform/test.h"
+
+namespace stream_executor {
+namespace sycl {
+namespace {
+
+struct FakeStream {
+  int id = 0;
+};
+
+// An event completes once its copy has been marked done.
+struct FakeEvent {
+  std::shared_ptr<bool> done = std::make_shared<bool>(false);
+};
+
+// Host memory standing in for pinned memory, with counters and an optional
+// allocation failure.
+struct FakeBackend {
+  using Stream = FakeStream;
+  using Event = FakeEvent;
+
+  static void* Allocate(FakeStream*, size_t bytes) {
+    if (fail_allocations) return nullptr;
+    ++allocations;
+    ++live_buffers;
+    return std::malloc(bytes);
+  }
+  static void Free(FakeStream*, void* ptr) {
+    --live_buffers;
+    std::free(ptr);
+  }
+  static bool IsComplete(const FakeEvent& event) { return *event.done; }
+
+  static inline int allocations = 0;
+  static inline int live_buffers = 0;
+  static inline bool fail_allocations = false;
+};
+
+using TestPool = StagingBufferPool<FakeBackend>;
+
+class StagingBufferPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    FakeBackend::allocations = 0;
+    FakeBackend::live_buffers = 0;
+    FakeBackend::fail_allocations = false;
+  }
+
+  FakeStream stream_a_{0}, stream_b_{1};
+};
+
+TEST_F(StagingBufferPoolTest, ReusesBuffersOfCompletedCopies) {
+  TestPool pool(1 << 20);
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = pool.Acquire(&stream_a_, 1000);
+    ASSERT_NE(ptr, nullptr);
+    FakeEvent event;
+    pool.Track(&stream_a_, ptr, event);
+    *event.done = true;
+  }
+  EXPECT_EQ(FakeBackend::allocations, 1);
+  EXPECT_EQ(pool.pool_bytes(), TestPool::kMinBufferBytes);
+}
+
+TEST_F(StagingBufferPoolTest, PendingCopiesKeepTheirBuffers) {
+  TestPool pool(1 << 20);
+  void* first = pool.Acquire(&stream_a_, 1000);
+  FakeEvent pending;
+  pool.Track(&stream_a_, first, pending);
+  void* second = pool.Acquire(&stream_a_, 1000);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(FakeBackend::allocations, 2);
+  pool.Return(&stream_a_, second);
+
+  *pending.done = true;
+  pool.ReleaseCompleted(&stream_a_, /*wait=*/false);
+  void* third = pool.Acquire(&stream_a_, 1000);
+  void* fourth = pool.Acquire(&stream_a_, 1000);
+  EXPECT_EQ(FakeBackend::allocations, 2);
+  pool.Return(&stream_a_, third);
+  pool.Return(&stream_a_, fourth);
+}
+
+TEST_F(StagingBufferPoolTest, ReclaimsInSubmissionOrder) {
+  TestPool pool(1 << 20);
+  FakeEvent first, second;
+  pool.Track(&stream_a_, pool.Acquire(&stream_a_, 1000), first);
+  pool.Track(&stream_a_, pool.Acquire(&stream_a_, 1000), second);
+  // The second copy reports completion first, but an in-order stream only
+  // reclaims from the front.
+  *second.done = true;
+  pool.Return(&stream_a_, pool.Acquire(&stream_a_, 1000));
+  EXPECT_EQ(FakeBackend::allocations, 3);
+}
+
+TEST_F(StagingBufferPoolTest, BoundsPinnedMemory) {
+  constexpr size_t kMaxPoolBytes = 64 << 10;
+  TestPool pool(kMaxPoolBytes);
+  std::vector<FakeEvent> events;
+  int staged = 0;
+  for (int i = 0; i < 100; ++i) {
+    void* ptr = pool.Acquire(&stream_a_, 8 << 10);
+    if (ptr == nullptr) break;
+    events.emplace_back();
+    pool.Track(&stream_a_, ptr, events.back());
+    ++staged;
+  }
+  // Copies still in flight fill the pool, so further copies fall back.
+  EXPECT_EQ(staged, kMaxPoolBytes / (8 << 10));
+  EXPECT_LE(pool.pool_bytes(), kMaxPoolBytes);
+  EXPECT_EQ(pool.Acquire(&stream_a_, 8 << 10), nullptr);
+  EXPECT_EQ(pool.Acquire(&stream_a_, kMaxPoolBytes * 2), nullptr);
+
+  for (FakeEvent& event : events) *event.done = true;
+  void* ptr = pool.Acquire(&stream_a_, 8 << 10);
+  EXPECT_NE(ptr, nullptr);
+  pool.Return(&stream_a_, ptr);
+}
+
+TEST_F(StagingBufferPoolTest, FreesIdleBuffersOfOtherStreamsToMakeRoom) {
+  constexpr size_t kMaxPoolBytes = 64 << 10;
+  TestPool pool(kMaxPoolBytes);
+  FakeEvent done;
+  *done.done = true;
+  pool.Track(&stream_b_, pool.Acquire(&stream_b_, kMaxPoolBytes), done);
+
+  void* ptr = pool.Acquire(&stream_a_, 16 << 10);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(FakeBackend::live_buffers, 1);
+  EXPECT_EQ(pool.pool_bytes(), 16 << 10);
+  pool.Return(&stream_a_, ptr);
+}
+
+TEST_F(StagingBufferPoolTest, AllocationFailureFallsBack) {
+  TestPool pool(1 << 20);
+  FakeBackend::fail_allocations = true;
+  EXPECT_EQ(pool.Acquire(&stream_a_, 1000), nullptr);
+  EXPECT_EQ(pool.pool_bytes(), 0);
+}
+
+TEST_F(StagingBufferPoolTest, RemoveStreamFreesItsBuffers) {
+  {
+    TestPool pool(1 << 20);
+    FakeEvent pending;
+    pool.Track(&stream_a_, pool.Acquire(&stream_a_, 1000), pending);
+    pool.Track(&stream_b_, pool.Acquire(&stream_b_, 1000), pending);
+    // The caller waits for the stream before removing it.
+    pool.RemoveStream(&stream_a_);
+    EXPECT_EQ(FakeBackend::live_buffers, 1);
+    EXPECT_EQ(pool.pool_bytes(), TestPool::kMinBufferBytes);
+    *pending.done = true;
+    pool.ReleaseCompleted(&stream_b_, /*wait=*/false);
+  }
+  EXPECT_EQ(FakeBackend::live_buffers, 0);
+}
+
+}  // namespace
+}  // namespace sycl
+}  // namespace stream_executor
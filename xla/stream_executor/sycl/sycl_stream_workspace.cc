@@ -0,0 +1,88 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/stream_executor/sycl/sycl_stream_workspace.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/platform/logging.h"
+#include "xla/stream_executor/stream_executor_pimpl.h"
+
+namespace stream_executor {
+namespace gpu {
+
+namespace {
+
+struct StreamWorkspace {
+  absl::Mutex mu;
+  OwningDeviceMemory memory ABSL_GUARDED_BY(mu);
+};
+
+ABSL_CONST_INIT absl::Mutex workspaces_mu(absl::kConstInit);
+
+absl::flat_hash_map<Stream*, std::unique_ptr<StreamWorkspace>>& Workspaces()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(workspaces_mu) {
+  static auto* workspaces =
+      new absl::flat_hash_map<Stream*, std::unique_ptr<StreamWorkspace>>();
+  return *workspaces;
+}
+
+// The map lock is only held for the lookup; a workspace is never erased
+// while its stream is alive.
+StreamWorkspace& GetWorkspace(Stream* stream) {
+  absl::MutexLock lock(&workspaces_mu);
+  std::unique_ptr<StreamWorkspace>& workspace = Workspaces()[stream];
+  if (workspace == nullptr) workspace = std::make_unique<StreamWorkspace>();
+  return *workspace;
+}
+
+}  // namespace
+
+tsl::StatusOr<DeviceMemoryBase> GetStreamWorkspace(
+    Stream* stream, DeviceMemoryAllocator* allocator, uint64_t size) {
+  StreamWorkspace& workspace = GetWorkspace(stream);
+  absl::MutexLock lock(&workspace.mu);
+  OwningDeviceMemory& memory = workspace.memory;
+  if (memory.is_null() || memory->size() < size ||
+      memory.allocator() != allocator) {
+    if (!memory.is_null()) {
+      VLOG(2) << "Growing stream workspace from " << memory->size() << " to "
+              << size << " bytes";
+      // Work already queued may still use the old buffer.
+      stream->ThenDoHostCallback([old = std::move(memory)]() mutable {});
+    }
+    TF_ASSIGN_OR_RETURN(
+        memory, allocator->Allocate(stream->parent()->device_ordinal(), size,
+                                    /*retry_on_failure=*/true));
+  }
+  return *memory;
+}
+
+void ReleaseStreamWorkspace(Stream* stream) {
+  // The workspace is freed after the map lock is dropped.
+  std::unique_ptr<StreamWorkspace> workspace;
+  absl::MutexLock lock(&workspaces_mu);
+  auto it = Workspaces().find(stream);
+  if (it == Workspaces().end()) return;
+  workspace = std::move(it->second);
+  Workspaces().erase(it);
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
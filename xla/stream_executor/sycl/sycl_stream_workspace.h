@@ -0,0 +1,44 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_STREAM_EXECUTOR_SYCL_SYCL_STREAM_WORKSPACE_H_
+#define XLA_STREAM_EXECUTOR_SYCL_SYCL_STREAM_WORKSPACE_H_
+
+#include <cstdint>
+
+#include "tsl/platform/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_allocator.h"
+#include "xla/stream_executor/stream.h"
+
+namespace stream_executor {
+namespace gpu {
+
+// Returns a workspace of at least `size` bytes owned by `stream`, allocated
+// from `allocator`. Work on an in-order stream never overlaps, so everything
+// enqueued on `stream` can share one workspace. It grows to the largest
+// request seen; a buffer it outgrows is handed back to its allocator once the
+// work already queued on `stream` is done, without blocking the host.
+tsl::StatusOr<DeviceMemoryBase> GetStreamWorkspace(
+    Stream* stream, DeviceMemoryAllocator* allocator, uint64_t size);
+
+// Returns the workspace of `stream` to its allocator. Called when the stream
+// is deallocated, after all its work has completed.
+void ReleaseStreamWorkspace(Stream* stream);
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // XLA_STREAM_EXECUTOR_SYCL_SYCL_STREAM_WORKSPACE_H_
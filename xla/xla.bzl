@@ -44,6 +44,16 @@ def xpu_library(name, srcs = [], hdrs = [], deps = [], *argc, **kwargs):
         **kwargs
     )
 
+def xpu_cc_test(name, srcs = [], deps = [], *argc, **kwargs):
+    kwargs["copts"] = kwargs.get("copts", []) + if_sycl(["-sycl_compile"])
+    kwargs["linkopts"] = kwargs.get("linkopts", []) + if_sycl(["-link_stage"])
+    native.cc_test(
+        name = name,
+        srcs = srcs,
+        deps = deps,
+        **kwargs
+    )
+
 def _get_transitive_headers(hdrs, deps):
     return depset(
         hdrs,